@@ -0,0 +1,117 @@
+/********************************************************************************
+* atomic.h: Innehller kritiska sektioner, det vill sga kod som mste
+*           genomfras utan att avbrytas av avbrottsrutiner, samt atomr
+*           lsning av 32-bitars rknare som delas med avbrottsrutinerna.
+*
+*           En kritisk sektion inleds med atomic_begin, som sparar status-
+*           registret (SREG) och inaktiverar avbrott, och avslutas med
+*           atomic_end, som terstller statusregistret:
+*
+*           const uint8_t sreg = atomic_begin();
+*           number = new_number;
+*           atomic_end(sreg);
+*
+*           Avbrott aktiveras drmed enbart igen ifall de var aktiverade
+*           innan den kritiska sektionen, vilket gr att kritiska sektioner
+*           kan nstlas och anropas frn avbrottsrutiner utan att avbrott
+*           aktiveras mitt i avbrottsrutinen. Avbrott aktiveras globalt en
+*           gng efter att systemet har initierats via atomic_enable, se
+*           main.c, och ingen drivrutin aktiverar avbrott p egen hand.
+*
+*           Inaktivering av avbrott fungerar ven som minnesbarrir, s att
+*           kompilatorn inte flyttar lsningar eller skrivningar av delade
+*           variabler ut ur den kritiska sektionen.
+*
+*           ATmega328P lser och skriver en byte i taget, varfr variabler
+*           strre n 8 bitar som ndras av en avbrottsrutin annars kan
+*           lsas halvt uppdaterade. Enskilda 32-bitars rknare lses via
+*           atomic_read_u32, exempelvis antalet kastade byte i serial.c,
+*           medan flera variabler som mste lsas eller nollstllas
+*           tillsammans lses i en gemensam kritisk sektion.
+********************************************************************************/
+#ifndef ATOMIC_H_
+#define ATOMIC_H_
+
+/* Inkluderingsdirektiv (simulerade register vid host build, se host.h): */
+#ifdef HOST_BUILD
+#include "host.h"
+#else
+#include <avr/io.h>
+#endif
+#include <stdint.h>
+
+/********************************************************************************
+* ATOMIC_MEMORY_BARRIER: Hindrar kompilatorn frn att flytta minnestkomster
+*                        frbi barriren. Vid host build simuleras avbrott
+*                        enbart via funktionsanrop, varfr ingen barrir krvs.
+********************************************************************************/
+#ifdef HOST_BUILD
+#define ATOMIC_MEMORY_BARRIER()
+#else
+#define ATOMIC_MEMORY_BARRIER() __asm__ __volatile__("" ::: "memory")
+#endif
+
+/********************************************************************************
+* atomic_disable: Inaktiverar avbrott globalt utan att spara statusregistret.
+*                 Anvnds d statusregistret redan har sparats, exempelvis
+*                 nr en kritisk sektion terupptas i en loop.
+********************************************************************************/
+static inline void atomic_disable(void)
+{
+   asm("CLI");
+   ATOMIC_MEMORY_BARRIER();
+   return;
+}
+
+/********************************************************************************
+* atomic_enable: Aktiverar avbrott globalt. Ska enbart anropas en gng efter
+*                att systemet har initierats, se main.c.
+********************************************************************************/
+static inline void atomic_enable(void)
+{
+   ATOMIC_MEMORY_BARRIER();
+   asm("SEI");
+   return;
+}
+
+/********************************************************************************
+* atomic_begin: Inleder en kritisk sektion genom att spara statusregistret
+*               och inaktivera avbrott. Statusregistret returneras och ska
+*               skickas till atomic_end nr den kritiska sektionen avslutas.
+********************************************************************************/
+static inline uint8_t atomic_begin(void)
+{
+   const uint8_t sreg = SREG;
+   atomic_disable();
+   return sreg;
+}
+
+/********************************************************************************
+* atomic_end: Avslutar en kritisk sektion genom att terstlla status-
+*             registret, varvid avbrott enbart aktiveras ifall de var
+*             aktiverade nr atomic_begin anropades.
+*
+*             - sreg: Statusregistret som returnerades av atomic_begin.
+********************************************************************************/
+static inline void atomic_end(const uint8_t sreg)
+{
+   ATOMIC_MEMORY_BARRIER();
+   SREG = sreg;
+   return;
+}
+
+/********************************************************************************
+* atomic_read_u32: Lser angiven 32-bitars variabel med avbrott inaktiverade
+*                  och returnerar dess innehll.
+*
+*                  - value: Pekare till variabeln som ska lsas.
+********************************************************************************/
+static inline uint32_t atomic_read_u32(const volatile uint32_t* value)
+{
+   const uint8_t sreg = atomic_begin();
+   const uint32_t copy = *value;
+   atomic_end(sreg);
+   return copy;
+}
+
+#endif /* ATOMIC_H_ */
@@ -15,7 +15,7 @@
 void button_init(struct button* self,
 const uint8_t pin)
 {
-	if (pin >= 0 && pin <= 7)
+	if (pin <= 7)
 	{
 		self->pin = pin;
 		self->pullup = &PORTD;
@@ -23,7 +23,7 @@ const uint8_t pin)
 		self->pcmsk = &PCMSK2;
 		self->pcint = PCINT2;
 	}
-	else if (pin >= 8 && pin <= 13)
+	else if (pin <= 13)
 	{
 		self->pin = pin - 8;
 		self->pullup = &PORTB;
@@ -31,7 +31,7 @@ const uint8_t pin)
 		self->pcmsk = &PCMSK0;
 		self->pcint = PCINT0;
 	}
-	else if (pin >= 14 && pin <= 19)
+	else if (pin <= 19)
 	{
 		self->pin = pin - 14;
 		self->pullup = &PORTC;
@@ -77,14 +77,20 @@ void button_clear(struct button* self)
 *                             C             A0 - A5             PCINT1_vect
 *                             D              0 - 7              PCINT2_vect
 *
+*                          Registren uppdateras i en kritisk sektion, d
+*                          PCICR ven ndras av avstudsningens callback-rutin.
+*                          Avbrott aktiveras inte globalt hr, utan i main.c
+*                          nr systemet har initierats.
+*
 *                          - self: Pekare till tryckknappen som PCI-avbrott
 *                                  ska aktiveras p.
 ********************************************************************************/
 void button_enable_interrupt(struct button* self)
 {
-	asm("SEI");
+	const uint8_t sreg = atomic_begin();
 	PCICR |= (1 << self->pcint);
 	*(self->pcmsk) |= (1 << self->pin);
+	atomic_end(sreg);
 	return;
 }
 
@@ -0,0 +1,292 @@
+/********************************************************************************
+* command.c: Innehller funktionsdefinitioner fr kommandogrnssnittet fr
+*            fjrrstyrning av 7-segmentsdisplayerna via seriell verfring.
+********************************************************************************/
+#include "command.h"
+
+/********************************************************************************
+* command_switch: Enumeration fr argumenten on, off samt toggle.
+********************************************************************************/
+enum command_switch
+{
+   COMMAND_SWITCH_OFF,   /* Inaktivera. */
+   COMMAND_SWITCH_ON,    /* Aktivera. */
+   COMMAND_SWITCH_TOGGLE /* Toggla. */
+};
+
+/********************************************************************************
+* Statiska variabler:
+*
+*   - line    : Radbuffert fr tecknen i aktuellt kommando.
+*   - length  : Antal tecken i radbufferten.
+*   - overflow: Indikerar ifall aktuell rad inte ryms i radbufferten.
+********************************************************************************/
+static char line[COMMAND_LINE_SIZE];
+static uint8_t length = 0;
+static bool overflow = false;
+
+/********************************************************************************
+* Statiska funktioner:
+********************************************************************************/
+static int command_execute(char* s);
+static int command_parse_number(const char* s,
+                                uint32_t* value);
+static int command_parse_switch(const char* s,
+                                enum command_switch* value);
+static void command_print_status(void);
+
+/********************************************************************************
+* command_init: Aktiverar mottagning av kommandon. Seriell verfring mste
+*               ha initierats via funktionen serial_init innan, s att baud
+*               rate berknas vid kompilering.
+********************************************************************************/
+void command_init(void)
+{
+   serial_enable_receive();
+   length = 0;
+   overflow = false;
+   return;
+}
+
+/********************************************************************************
+* command_run: Tolkar samtliga mottagna tecken och utfr varje fullstndigt
+*              kommando. Vagnretur samt nyradstecken avslutar en rad, dr
+*              tomma rader ignoreras, s att bde CR, LF och CRLF fungerar.
+*              vriga tecken lggs i radbufferten, dr en rad som inte ryms
+*              markeras och besvaras med ERR nr den avslutas.
+********************************************************************************/
+void command_run(void)
+{
+   char c;
+
+   while (serial_read_char(&c) == 0)
+   {
+      if (c == '\r' || c == '\n')
+      {
+         if (overflow)
+         {
+            serial_print_string("ERR\n");
+         }
+         else if (length > 0)
+         {
+            line[length] = '\0';
+            serial_print_string(command_execute(line) == 0 ? "OK\n" : "ERR\n");
+         }
+
+         length = 0;
+         overflow = false;
+      }
+      else if (length < COMMAND_LINE_SIZE - 1)
+      {
+         line[length++] = c;
+      }
+      else
+      {
+         overflow = true;
+      }
+   }
+   return;
+}
+
+/********************************************************************************
+* command_execute: Utfr kommandot i angiven rad. Kommandot separeras frn
+*                  argumentet vid frsta mellanslaget, varefter kommandot
+*                  jmfrs med de kommandon som stds. Om kommandot utfrdes
+*                  returneras 0, annars returneras felkod 1.
+*
+*                  - s: Pekare till raden, som delas upp vid mellanslaget.
+********************************************************************************/
+static int command_execute(char* s)
+{
+   char* argument = s;
+   uint32_t value;
+   enum command_switch state;
+
+   while (*argument && *argument != ' ') argument++;
+   while (*argument == ' ') *argument++ = '\0';
+
+   if (!strcmp(s, "number"))
+   {
+      if (command_parse_number(argument, &value) || value > (display_number_t)~0) return 1;
+      return display_set_number((display_number_t)value);
+   }
+   else if (!strcmp(s, "radix"))
+   {
+      if (command_parse_number(argument, &value) || value > UINT8_MAX) return 1;
+      return display_set_radix((uint8_t)value);
+   }
+   else if (!strcmp(s, "speed"))
+   {
+      if (command_parse_number(argument, &value) || value == 0 || value > UINT16_MAX) return 1;
+      display_set_count(display_get_count_direction(), (uint16_t)value);
+      return 0;
+   }
+   else if (!strcmp(s, "direction"))
+   {
+      if (!strcmp(argument, "up")) display_set_count_direction(DISPLAY_COUNT_DIRECTION_UP);
+      else if (!strcmp(argument, "down")) display_set_count_direction(DISPLAY_COUNT_DIRECTION_DOWN);
+      else if (!strcmp(argument, "toggle")) display_toggle_count_direction();
+      else return 1;
+      return 0;
+   }
+   else if (!strcmp(s, "count"))
+   {
+      if (command_parse_switch(argument, &state)) return 1;
+      if (state == COMMAND_SWITCH_ON) display_enable_count();
+      else if (state == COMMAND_SWITCH_OFF) display_disable_count();
+      else display_toggle_count();
+      return 0;
+   }
+   else if (!strcmp(s, "output"))
+   {
+      if (command_parse_switch(argument, &state)) return 1;
+      if (state == COMMAND_SWITCH_ON) display_enable_output();
+      else if (state == COMMAND_SWITCH_OFF) display_disable_output();
+      else display_toggle_output();
+      return 0;
+   }
+   else if (!strcmp(s, "telemetry"))
+   {
+      if (command_parse_switch(argument, &state)) return 1;
+      if (state == COMMAND_SWITCH_ON) telemetry_enable();
+      else if (state == COMMAND_SWITCH_OFF) telemetry_disable();
+      else telemetry_toggle();
+      return 0;
+   }
+   else if (!strcmp(s, "profile"))
+   {
+      if (!*argument) isr_profile_print();
+      else if (!strcmp(argument, "reset")) isr_profile_reset();
+      else return 1;
+      return 0;
+   }
+   else if (!strcmp(s, "stack") && !*argument)
+   {
+      stack_print();
+      return 0;
+   }
+   else if (!strcmp(s, "load"))
+   {
+      if (!*argument) cpu_load_print();
+      else if (!strcmp(argument, "reset")) cpu_load_reset();
+      else if (!strncmp(argument, "display ", 8))
+      {
+         if (command_parse_switch(argument + 8, &state)) return 1;
+         if (state == COMMAND_SWITCH_ON) cpu_load_enable_display();
+         else if (state == COMMAND_SWITCH_OFF) cpu_load_disable_display();
+         else cpu_load_toggle_display();
+      }
+      else return 1;
+      return 0;
+   }
+   else if (!strcmp(s, "sleep"))
+   {
+      if (!*argument)
+      {
+         idle_print();
+         return 0;
+      }
+      if (command_parse_switch(argument, &state)) return 1;
+      if (state == COMMAND_SWITCH_ON) idle_enable_sleep();
+      else if (state == COMMAND_SWITCH_OFF) idle_disable_sleep();
+      else idle_toggle_sleep();
+      return 0;
+   }
+   else if (!strcmp(s, "status") && !*argument)
+   {
+      command_print_status();
+      return 0;
+   }
+   else
+   {
+      return 1;
+   }
+}
+
+/********************************************************************************
+* command_parse_number: Tolkar angiven text som ett osignerat 32-bitars
+*                       heltal, decimalt eller hexadecimalt med prefixet 0x.
+*                       Om texten r ett giltigt tal returneras 0 efter att
+*                       talet har lagrats p angiven adress. Vid tom text,
+*                       ogiltiga tecken eller fr stort tal returneras
+*                       felkod 1.
+*
+*                       - s    : Pekare till texten som ska tolkas.
+*                       - value: Pekare till variabeln som talet lagras i.
+********************************************************************************/
+static int command_parse_number(const char* s,
+                                uint32_t* value)
+{
+   uint8_t base = 10;
+   uint32_t result = 0;
+
+   if (s[0] == '0' && (s[1] == 'x' || s[1] == 'X'))
+   {
+      base = 16;
+      s += 2;
+   }
+
+   if (!*s) return 1;
+
+   for (; *s; ++s)
+   {
+      uint8_t digit;
+
+      if (*s >= '0' && *s <= '9') digit = (uint8_t)(*s - '0');
+      else if (*s >= 'a' && *s <= 'f') digit = (uint8_t)(*s - 'a' + 10);
+      else if (*s >= 'A' && *s <= 'F') digit = (uint8_t)(*s - 'A' + 10);
+      else return 1;
+
+      if (digit >= base || result > (UINT32_MAX - digit) / base) return 1;
+      result = result * base + digit;
+   }
+
+   *value = result;
+   return 0;
+}
+
+/********************************************************************************
+* command_parse_switch: Tolkar angiven text som on, off eller toggle. Vid
+*                       giltig text returneras 0 efter att motsvarande vrde
+*                       har lagrats p angiven adress, annars returneras
+*                       felkod 1.
+*
+*                       - s    : Pekare till texten som ska tolkas.
+*                       - value: Pekare till variabeln som vrdet lagras i.
+********************************************************************************/
+static int command_parse_switch(const char* s,
+                                enum command_switch* value)
+{
+   if (!strcmp(s, "on")) *value = COMMAND_SWITCH_ON;
+   else if (!strcmp(s, "off")) *value = COMMAND_SWITCH_OFF;
+   else if (!strcmp(s, "toggle")) *value = COMMAND_SWITCH_TOGGLE;
+   else return 1;
+   return 0;
+}
+
+/********************************************************************************
+* command_print_status: Skriver ut aktuellt tal, talbas, upprkning,
+*                       upprkningsriktning samt ifall displayerna r p,
+*                       fljt av faktisk baud rate och dess avvikelse frn
+*                       nskad baud rate mtt i procent med tv decimaler,
+*                       se serial_baud_error.
+********************************************************************************/
+static void command_print_status(void)
+{
+   serial_print_string("number=");
+   serial_print_unsigned(display_get_number());
+   serial_print_string(" radix=");
+   serial_print_unsigned(display_get_radix());
+   serial_print_string(" count=");
+   serial_print_unsigned(display_count_enabled());
+   serial_print_string(" direction=");
+   serial_print_string(display_get_count_direction() == DISPLAY_COUNT_DIRECTION_UP ? "up" : "down");
+   serial_print_string(" output=");
+   serial_print_unsigned(display_output_enabled());
+   serial_print_string(" baud=");
+   serial_print_unsigned(serial_baud_rate());
+   serial_print_string(" err=");
+   serial_print_fixed(serial_baud_error(), 2);
+   serial_print_new_line();
+   return;
+}
@@ -0,0 +1,82 @@
+/********************************************************************************
+* command.h: Innehller ett kommandogrnssnitt fr fjrrstyrning av
+*            7-segmentsdisplayerna via seriell verfring, som komplement
+*            till tryckknapparna.
+*
+*            Kommandon skickas som textrader avslutade med vagnretur och/eller
+*            nyradstecken, dr kommandot och eventuellt argument separeras
+*            med mellanslag. Tal anges decimalt eller hexadecimalt med
+*            prefixet 0x:
+*
+*            number <tal>             Stter nytt tal p displayerna.
+*            radix <2 - 16>           Stter ny talbas.
+*            count on|off|toggle      Aktiverar eller inaktiverar upprkning.
+*            speed <1 - 65535>        Stter upprkningshastighet mtt i ms.
+*            direction up|down|toggle Stter upprkningsriktning.
+*            output on|off|toggle     Stter p eller stnger av displayerna.
+*            telemetry on|off|toggle  Aktiverar eller inaktiverar telemetrin.
+*            status                   Skriver ut aktuellt tillstnd.
+*            profile [reset]          Skriver ut eller nollstller mtningen
+*                                     av avbrottsrutinerna, se isr_profile.h.
+*            stack                    Skriver ut stackens strsta djup samt
+*                                     RAM-anvndningen, se stack.h.
+*            load [reset]             Skriver ut processorlasten eller
+*                                     nollstller hgsta lasten, se
+*                                     cpu_load.h.
+*            load display on|off|toggle
+*                                     Visar processorlasten p displayerna.
+*            sleep [on|off|toggle]    Skriver ut andelen tid i vilolge eller
+*                                     aktiverar/inaktiverar vilolget, se
+*                                     idle.h.
+*
+*            Varje kommando besvaras med OK eller ERR p en egen rad, dr
+*            kommandot status frst skriver ut tillstndet, exempelvis:
+*
+*            number=42 radix=10 count=1 direction=up output=1 baud=9615 err=0.16
+*
+*            dr baud r faktisk baud rate och err dess avvikelse frn
+*            nskad baud rate mtt i procent, se serial_baud_error.
+*
+*            Mottagna tecken tolkas tecken fr tecken av funktionen
+*            command_run, som ska anropas frn huvudloopen. Funktionen
+*            behandlar enbart tecken som redan har tagits emot och vntar
+*            drmed aldrig p nya tecken. Tecknen lagras i en statisk
+*            radbuffert, s att ingen dynamisk minnesallokering sker. Rader
+*            som inte ryms i bufferten frkastas i sin helhet och besvaras
+*            med ERR. Avbrottsrutinerna pverkas enbart av mottagningen av
+*            varje tecken, se serial.h, medan kommandona utfrs i huvudloopen.
+********************************************************************************/
+#ifndef COMMAND_H_
+#define COMMAND_H_
+
+/* Inkluderingsdirektiv: */
+#include <string.h>
+#include "misc.h"
+#include "serial.h"
+#include "display.h"
+#include "telemetry.h"
+#include "isr_profile.h"
+#include "stack.h"
+#include "cpu_load.h"
+#include "idle.h"
+
+/* Makrodefinitioner: */
+#ifndef COMMAND_LINE_SIZE
+#define COMMAND_LINE_SIZE 32 /* Radbuffertens storlek inklusive nolltecken. */
+#endif
+
+/********************************************************************************
+* command_init: Aktiverar mottagning av kommandon. Seriell verfring mste
+*               ha initierats via funktionen serial_init innan, s att baud
+*               rate berknas vid kompilering.
+********************************************************************************/
+void command_init(void);
+
+/********************************************************************************
+* command_run: Tolkar samtliga mottagna tecken och utfr varje fullstndigt
+*              kommando. Funktionen vntar aldrig p nya tecken och ska
+*              anropas kontinuerligt frn huvudloopen.
+********************************************************************************/
+void command_run(void);
+
+#endif /* COMMAND_H_ */
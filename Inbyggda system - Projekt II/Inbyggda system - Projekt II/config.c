@@ -0,0 +1,217 @@
+/********************************************************************************
+* config.c: Innehller funktionsdefinitioner fr lagring av systemets
+*           instllningar i EEPROM-minnet via strukten config.
+********************************************************************************/
+#include "config.h"
+
+/* Makrodefinitioner: */
+#define CONFIG_CRC_SIZE (sizeof(struct config) - 1) /* Antal byte som kontrollsumman berknas ver. */
+
+/********************************************************************************
+* Statiska variabler:
+*
+*   - current    : Aktuella instllningar.
+*   - active_slot: Index fr platsen med senast lagrade instllningar.
+*   - dirty      : Indikerar ifall instllningarna har ndrats sedan de
+*                  senast lagrades.
+********************************************************************************/
+static struct config current;
+static uint8_t active_slot = CONFIG_SLOT_COUNT - 1;
+static volatile bool dirty = false;
+
+/********************************************************************************
+* Statiska funktioner:
+********************************************************************************/
+static void config_set_defaults(struct config* self);
+static inline bool config_valid(const struct config* self);
+static void config_set(uint8_t* setting,
+                       const uint8_t value);
+
+/********************************************************************************
+* config_load: Lser in senast lagrade instllningar frn EEPROM-minnet. Om
+*              ingen giltig post finns anvnds defaultinstllningarna, varvid
+*              felkod 1 returneras. Annars returneras 0.
+*
+*              1. Samtliga platser lses in som ett enda block.
+*
+*              2. Bland posterna med rtt version och giltig kontrollsumma
+*                 vljs posten med hgst sekvensnummer, dr jmfrelsen
+*                 hanterar att sekvensnumret slr om frn 255 till 0.
+*
+*              3. Om ingen giltig post hittades anvnds defaultinstllningarna,
+*                 vilka lagras vid nsta anrop av config_commit.
+********************************************************************************/
+int config_load(void)
+{
+   struct config slots[CONFIG_SLOT_COUNT];
+   bool found = false;
+
+   eeprom_read_block(CONFIG_ADDRESS, slots, sizeof(slots));
+
+   for (uint8_t i = 0; i < CONFIG_SLOT_COUNT; ++i)
+   {
+      if (!config_valid(&slots[i])) continue;
+
+      if (!found || (int8_t)(slots[i].sequence - current.sequence) > 0)
+      {
+         current = slots[i];
+         active_slot = i;
+         found = true;
+      }
+   }
+
+   if (!found)
+   {
+      config_set_defaults(&current);
+      active_slot = CONFIG_SLOT_COUNT - 1;
+   }
+
+   dirty = !found;
+   return found ? 0 : 1;
+}
+
+/********************************************************************************
+* config_get: Returnerar en pekare till aktuella instllningar.
+********************************************************************************/
+const struct config* config_get(void)
+{
+   return &current;
+}
+
+/********************************************************************************
+* config_set_output_enabled: Stter ny instllning fr ifall
+*                            7-segmentsdisplayerna r p.
+*
+*                            - enabled: Indikerar ifall displayerna r p.
+********************************************************************************/
+void config_set_output_enabled(const bool enabled)
+{
+   config_set(&current.output_enabled, enabled);
+   return;
+}
+
+/********************************************************************************
+* config_set_count_enabled: Stter ny instllning fr ifall upprkning r
+*                           aktiverad.
+*
+*                           - enabled: Indikerar ifall upprkning r aktiverad.
+********************************************************************************/
+void config_set_count_enabled(const bool enabled)
+{
+   config_set(&current.count_enabled, enabled);
+   return;
+}
+
+/********************************************************************************
+* config_set_count_direction: Stter ny upprkningsriktning.
+*
+*                             - direction: Ny upprkningsriktning.
+********************************************************************************/
+void config_set_count_direction(const uint8_t direction)
+{
+   config_set(&current.count_direction, direction);
+   return;
+}
+
+/********************************************************************************
+* config_dirty: Indikerar ifall instllningarna har ndrats sedan de senast
+*               lagrades.
+********************************************************************************/
+bool config_dirty(void)
+{
+   return dirty;
+}
+
+/********************************************************************************
+* config_commit: Lagrar instllningarna i EEPROM-minnet ifall de har ndrats.
+*
+*                Samtliga steg sker med avbrott inaktiverade, d instll-
+*                ningarna kan ndras och lagras frn avbrottsrutiner, exem-
+*                pelvis vid spnningsbortfall. Drmed kan instllningarna
+*                inte markeras som lagrade innan posten har lagts i k.
+*
+*                1. Aktuella instllningar kopieras, varefter sekvensnumret
+*                   rknas upp och kontrollsumman berknas.
+*
+*                2. Posten lggs i k fr skrivning till platsen efter
+*                   senast lagrade post, med kontrollsumman sist. Byte som
+*                   inte har ndrats sedan platsen senast skrevs hoppas ver
+*                   av EEPROM-drivrutinerna.
+*
+*                3. Frst nr hela posten har lagts i k blir platsen aktiv
+*                   och instllningarna markeras som lagrade. Om en byte
+*                   kastas p grund av full k frblir instllningarna
+*                   markerade som ndrade, s att posten lagras p nytt vid
+*                   nsta anrop. D kontrollsumman skrivs sist blir en
+*                   ofullstndig post aldrig giltig.
+********************************************************************************/
+void config_commit(void)
+{
+   const uint8_t sreg = atomic_begin();
+
+   if (dirty)
+   {
+      const uint8_t slot = (active_slot + 1) % CONFIG_SLOT_COUNT;
+      struct config record = current;
+      record.version = CONFIG_VERSION;
+      record.sequence++;
+      record.crc = crc8(&record, CONFIG_CRC_SIZE);
+
+      if (!eeprom_write_block(CONFIG_ADDRESS + slot * sizeof(struct config),
+                              &record, sizeof(struct config)))
+      {
+         current.sequence = record.sequence;
+         active_slot = slot;
+         dirty = false;
+      }
+   }
+
+   atomic_end(sreg);
+   return;
+}
+
+/********************************************************************************
+* config_set_defaults: Stter defaultinstllningarna, dr displayerna r
+*                      avstngda och upprkning r inaktiverad med
+*                      upprkningsriktning uppt (1, se enumerationen
+*                      display_count_direction).
+*
+*                      - self: Pekare till instllningarna.
+********************************************************************************/
+static void config_set_defaults(struct config* self)
+{
+   self->version = CONFIG_VERSION;
+   self->sequence = 0;
+   self->output_enabled = 0;
+   self->count_enabled = 0;
+   self->count_direction = 1;
+   self->crc = 0;
+   return;
+}
+
+/********************************************************************************
+* config_valid: Indikerar ifall angiven post har rtt version samt giltig
+*               kontrollsumma.
+*
+*               - self: Pekare till posten som ska kontrolleras.
+********************************************************************************/
+static inline bool config_valid(const struct config* self)
+{
+   return self->version == CONFIG_VERSION && self->crc == crc8(self, CONFIG_CRC_SIZE);
+}
+
+/********************************************************************************
+* config_set: Stter ny instllning och markerar instllningarna som ndrade,
+*             dock enbart om instllningen faktiskt ndras.
+*
+*             - setting: Pekare till instllningen som ska sttas.
+*             - value  : Instllningens nya vrde.
+********************************************************************************/
+static void config_set(uint8_t* setting,
+                       const uint8_t value)
+{
+   if (*setting == value) return;
+   *setting = value;
+   dirty = true;
+   return;
+}
@@ -0,0 +1,111 @@
+/********************************************************************************
+* config.h: Innehller funktionalitet fr lagring av systemets instllningar
+*           i EEPROM-minnet som en versionshanterad post skyddad med en
+*           kontrollsumma (CRC-8), via strukten config samt associerade
+*           funktioner.
+*
+*           Instllningarna ndras enbart i RAM och markeras d som ndrade.
+*           ndrade instllningar lagras sedan i sin helhet genom ett anrop
+*           av funktionen config_commit, vilket br ske frn huvudloopen.
+*           Flera ndringar i fljd medfr drmed en enda skrivning.
+*
+*           Posten lagras vxelvis p tv platser frn adress CONFIG_ADDRESS
+*           och framt, dr varje skrivning sker till platsen som inte
+*           innehller senast lagrade instllningar. Drmed finns alltid en
+*           hel post kvar om strmmen bryts under en skrivning. Varje post
+*           innehller ett sekvensnummer, dr posten med giltig kontrollsumma
+*           och hgst sekvensnummer gller vid inlsning. Om ingen giltig
+*           post finns, exempelvis vid frsta uppstart eller efter ndring av
+*           CONFIG_VERSION, anvnds defaultinstllningarna.
+*
+*           Posterna ligger inom omrdet som speglas i RAM av EEPROM-
+*           drivrutinerna, se eeprom.h, vilket innebr att enbart byte som
+*           faktiskt har ndrats skrivs till EEPROM-minnet.
+********************************************************************************/
+#ifndef CONFIG_H_
+#define CONFIG_H_
+
+/* Inkluderingsdirektiv: */
+#include "misc.h"
+#include "eeprom.h"
+#include "crc.h"
+
+/********************************************************************************
+* Makrodefinitioner:
+*
+*   - CONFIG_VERSION   : Postens version, som ska rknas upp nr strukten
+*                        config ndras, s att ldre poster frkastas.
+*   - CONFIG_ADDRESS   : Frsta adressen i EEPROM-minnet fr posterna.
+*   - CONFIG_SLOT_COUNT: Antal platser som posterna lagras vxelvis p.
+********************************************************************************/
+#define CONFIG_VERSION    1
+#define CONFIG_ADDRESS    500
+#define CONFIG_SLOT_COUNT 2
+
+/********************************************************************************
+* config: Strukt fr systemets instllningar, som lagras byte fr byte i
+*         EEPROM-minnet i den ordning medlemmarna r deklarerade. Samtliga
+*         medlemmar r byte, vilket innebr att strukten saknar utfyllnad.
+********************************************************************************/
+struct config
+{
+   uint8_t version;         /* Postens version (CONFIG_VERSION). */
+   uint8_t sequence;        /* Sekvensnummer, rknas upp vid varje lagring. */
+   uint8_t output_enabled;  /* Indikerar ifall 7-segmentsdisplayerna r p. */
+   uint8_t count_enabled;   /* Indikerar ifall upprkning r aktiverad. */
+   uint8_t count_direction; /* Upprkningsriktning (1 = uppt, 0 = nedt). */
+   uint8_t crc;             /* CRC-8 fr samtliga fregende byte i posten. */
+};
+
+/********************************************************************************
+* config_load: Lser in senast lagrade instllningar frn EEPROM-minnet. Om
+*              ingen giltig post finns anvnds defaultinstllningarna, varvid
+*              felkod 1 returneras. Annars returneras 0.
+********************************************************************************/
+int config_load(void);
+
+/********************************************************************************
+* config_get: Returnerar en pekare till aktuella instllningar.
+********************************************************************************/
+const struct config* config_get(void);
+
+/********************************************************************************
+* config_set_output_enabled: Stter ny instllning fr ifall
+*                            7-segmentsdisplayerna r p.
+*
+*                            - enabled: Indikerar ifall displayerna r p.
+********************************************************************************/
+void config_set_output_enabled(const bool enabled);
+
+/********************************************************************************
+* config_set_count_enabled: Stter ny instllning fr ifall upprkning r
+*                           aktiverad.
+*
+*                           - enabled: Indikerar ifall upprkning r aktiverad.
+********************************************************************************/
+void config_set_count_enabled(const bool enabled);
+
+/********************************************************************************
+* config_set_count_direction: Stter ny upprkningsriktning.
+*
+*                             - direction: Ny upprkningsriktning.
+********************************************************************************/
+void config_set_count_direction(const uint8_t direction);
+
+/********************************************************************************
+* config_dirty: Indikerar ifall instllningarna har ndrats sedan de senast
+*               lagrades.
+********************************************************************************/
+bool config_dirty(void);
+
+/********************************************************************************
+* config_commit: Lagrar instllningarna i EEPROM-minnet ifall de har ndrats.
+*                Skrivningarna lggs i k och genomfrs i bakgrunden, se
+*                eeprom.h. Funktionen br anropas frn huvudloopen, men kan
+*                ven anropas frn avbrottsrutiner, exempelvis vid
+*                spnningsbortfall. Om posten inte ryms i kn frblir
+*                instllningarna markerade som ndrade.
+********************************************************************************/
+void config_commit(void);
+
+#endif /* CONFIG_H_ */
@@ -0,0 +1,266 @@
+/********************************************************************************
+* cpu_load.c: Innehller funktionsdefinitioner fr mtning av processorlasten
+*             utifrn antalet varv i huvudloopen.
+********************************************************************************/
+#include "cpu_load.h"
+
+/* Makrodefinitioner: */
+#define CPU_LOAD_WINDOW_TICKS ((uint32_t)CPU_LOAD_WINDOW_MS * SOFT_TIMER_TICKS_PER_MS) /* Period mtt i tick. */
+
+/********************************************************************************
+* Statiska variabler:
+*
+*   - calibrating : Indikerar ifall kalibrering pgr.
+*   - idle_count  : Antal varv i huvudloopen under pgende period.
+*   - idle_last   : Antal varv i huvudloopen under fregende period.
+*   - idle_max    : Antal varv per period vid kalibreringen (0 innan
+*                   kalibrering, varvid ingen last berknas).
+*   - window_start: Tidpunkt d pgende period startade mtt i tick.
+*   - window_sleep: Total tid i vilolge nr pgende period startade,
+*                   se idle.h.
+*
+*   - history      : Lasten fr de senaste perioderna mtt i tiondels procent.
+*   - history_index: Index fr nsta period i history.
+*   - history_sum  : Summan av lasten i history.
+*   - peak         : Hgsta lasten fr en period mtt i tiondels procent.
+*
+*   - show_display: Indikerar ifall lasten visas p 7-segmentsdisplayerna.
+********************************************************************************/
+static bool calibrating = false;
+static uint32_t idle_count = 0;
+static uint32_t idle_last = 0;
+static uint32_t idle_max = 0;
+static uint32_t window_start = 0;
+static uint32_t window_sleep = 0;
+
+static uint16_t history[CPU_LOAD_WINDOWS];
+static uint8_t history_index = 0;
+static uint16_t history_sum = 0;
+static uint16_t peak = 0;
+
+static bool show_display = false;
+
+/********************************************************************************
+* Statiska funktioner:
+********************************************************************************/
+static void cpu_load_update(const uint32_t count,
+                            const uint32_t elapsed);
+static void cpu_load_print_permille(const uint16_t value);
+
+/********************************************************************************
+* cpu_load_calibrate: Kalibrerar mtningen genom att anropa angiven funktion
+*                     under en period med avbrott inaktiverade. Eftersom
+*                     samma kod krs som i huvudloopen, inklusive anropet av
+*                     cpu_load_run, motsvarar antalet varv exakt en ledig
+*                     processor. Perioden avslutas av cpu_load_run, som d
+*                     lagrar antalet varv i idle_max. Timer 1 rknar ven
+*                     med avbrott inaktiverade, s lnge perioden ryms inom
+*                     ett varv p Timer 1.
+*
+*                     - loop: Pekare till funktionen fr ett varv i huvudloopen.
+********************************************************************************/
+void cpu_load_calibrate(void (*loop)(void))
+{
+   const uint8_t sreg = atomic_begin();
+
+   calibrating = true;
+   idle_count = 0;
+   window_start = soft_timer_time();
+
+   while (calibrating)
+   {
+      loop();
+   }
+
+   atomic_end(sreg);
+   return;
+}
+
+/********************************************************************************
+* cpu_load_run: Rknar varv i huvudloopen. Nr perioden CPU_LOAD_WINDOW_MS har
+*               lpt ut lagras antalet varv som kalibrering ifall kalibrering
+*               pgr, annars berknas lasten fr perioden. Drefter startas
+*               nsta period.
+********************************************************************************/
+void cpu_load_run(void)
+{
+   const uint32_t time = soft_timer_time();
+   idle_count++;
+
+   if (time - window_start >= CPU_LOAD_WINDOW_TICKS)
+   {
+      if (calibrating)
+      {
+         idle_max = idle_count;
+         calibrating = false;
+      }
+      else
+      {
+         cpu_load_update(idle_count, time - window_start);
+      }
+
+      idle_count = 0;
+      window_start = time;
+      window_sleep = idle_asleep_time();
+   }
+   return;
+}
+
+/********************************************************************************
+* cpu_load_get: Returnerar lasten utjmnad ver de senaste CPU_LOAD_WINDOWS
+*               perioderna mtt i tiondels procent (0 - 1000).
+********************************************************************************/
+uint16_t cpu_load_get(void)
+{
+   return history_sum / CPU_LOAD_WINDOWS;
+}
+
+/********************************************************************************
+* cpu_load_peak: Returnerar hgsta lasten fr en enskild period sedan start
+*                eller senaste nollstllning mtt i tiondels procent.
+********************************************************************************/
+uint16_t cpu_load_peak(void)
+{
+   return peak;
+}
+
+/********************************************************************************
+* cpu_load_reset: Nollstller hgsta lasten.
+********************************************************************************/
+void cpu_load_reset(void)
+{
+   peak = 0;
+   return;
+}
+
+/********************************************************************************
+* cpu_load_display_enabled: Indikerar ifall lasten visas p 7-segments-
+*                           displayerna. Om s r fallet returneras true,
+*                           annars false.
+********************************************************************************/
+bool cpu_load_display_enabled(void)
+{
+   return show_display;
+}
+
+/********************************************************************************
+* cpu_load_enable_display: Visar lasten i procent p 7-segmentsdisplayerna via
+*                          felskningslget.
+********************************************************************************/
+void cpu_load_enable_display(void)
+{
+   show_display = true;
+   display_set_debug_value(cpu_load_get() / 10);
+   display_enable_debug();
+   return;
+}
+
+/********************************************************************************
+* cpu_load_disable_display: terstller 7-segmentsdisplayerna till aktuellt tal.
+********************************************************************************/
+void cpu_load_disable_display(void)
+{
+   show_display = false;
+   display_disable_debug();
+   return;
+}
+
+/********************************************************************************
+* cpu_load_toggle_display: Togglar visning av lasten p 7-segmentsdisplayerna.
+********************************************************************************/
+void cpu_load_toggle_display(void)
+{
+   if (show_display)
+   {
+      cpu_load_disable_display();
+   }
+   else
+   {
+      cpu_load_enable_display();
+   }
+   return;
+}
+
+/********************************************************************************
+* cpu_load_print: Skriver ut utjmnad last, hgsta last samt antalet varv i
+*                 huvudloopen under senaste perioden och vid kalibreringen
+*                 via seriell verfring, exempelvis:
+*
+*                 load=12.4 peak=31.0 idle=8123/9274
+********************************************************************************/
+void cpu_load_print(void)
+{
+   serial_print_string("load=");
+   cpu_load_print_permille(cpu_load_get());
+   serial_print_string(" peak=");
+   cpu_load_print_permille(peak);
+   serial_print_string(" idle=");
+   serial_print_unsigned(idle_last);
+   serial_print_char('/');
+   serial_print_unsigned(idle_max);
+   serial_print_new_line();
+   return;
+}
+
+/********************************************************************************
+* cpu_load_update: Berknar lasten fr avslutad period utifrn antalet varv
+*                  i huvudloopen jmfrt med kalibreringen. Fler varv n vid
+*                  kalibreringen (exempelvis d perioden blev ngot lngre)
+*                  ger lasten 0. Om vilolget r aktiverat berknas lasten
+*                  i stllet utifrn tiden i vilolge under perioden, dr
+*                  tljaren inte kan sl om s lnge perioden understiger
+*                  17 sekunder. Lasten erstter ldsta perioden i history,
+*                  dr summan uppdateras stegvis, s att ingen summering av
+*                  hela tabellen krvs. Om lasten visas p 7-segments-
+*                  displayerna uppdateras ven felskningsvrdet.
+*
+*                  - count  : Antal varv i huvudloopen under perioden.
+*                  - elapsed: Periodens lngd mtt i tick.
+********************************************************************************/
+static void cpu_load_update(const uint32_t count,
+                            const uint32_t elapsed)
+{
+   uint16_t load = 0;
+   idle_last = count;
+
+   if (idle_sleep_enabled())
+   {
+      const uint32_t asleep = idle_asleep_time() - window_sleep;
+
+      if (asleep < elapsed)
+      {
+         load = (uint16_t)(CPU_LOAD_FULL_SCALE - asleep * CPU_LOAD_FULL_SCALE / elapsed);
+      }
+   }
+   else
+   {
+      if (!idle_max) return;
+
+      if (count < idle_max)
+      {
+         load = (uint16_t)(CPU_LOAD_FULL_SCALE - count * CPU_LOAD_FULL_SCALE / idle_max);
+      }
+   }
+
+   history_sum = history_sum - history[history_index] + load;
+   history[history_index] = load;
+   if (++history_index >= CPU_LOAD_WINDOWS) history_index = 0;
+
+   if (load > peak) peak = load;
+   if (show_display) display_set_debug_value(cpu_load_get() / 10);
+   return;
+}
+
+/********************************************************************************
+* cpu_load_print_permille: Skriver ut angivet vrde mtt i tiondels procent
+*                          som procent med en decimal, exempelvis 12.4.
+*
+*                          - value: Vrdet mtt i tiondels procent.
+********************************************************************************/
+static void cpu_load_print_permille(const uint16_t value)
+{
+   serial_print_unsigned(value / 10);
+   serial_print_char('.');
+   serial_print_unsigned(value % 10);
+   return;
+}
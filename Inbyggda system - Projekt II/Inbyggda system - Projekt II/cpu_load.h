@@ -0,0 +1,154 @@
+/********************************************************************************
+* cpu_load.h: Innehller mtning av processorlasten, det vill sga andelen av
+*             processortiden som gr t till avbrottsrutinerna samt arbete i
+*             huvudloopen, s att marginalen kan kontrolleras innan nya
+*             funktioner lggs till.
+*
+*             Mtningen bygger p att huvudloopen rknar sina varv. Varje
+*             varv anropas funktionen cpu_load_run, som rknar upp en
+*             rknare och med perioden CPU_LOAD_WINDOW_MS berknar lasten
+*             under fregende period. Vid start kalibreras rknaren via
+*             funktionen cpu_load_calibrate, som kr huvudloopen en period
+*             med avbrott inaktiverade, vilket ger antalet varv per period
+*             fr en helt ledig processor:
+*
+*             int main(void)
+*             {
+*                setup();
+*                cpu_load_calibrate(loop);
+*
+*                while (1)
+*                {
+*                   loop();
+*                }
+*             }
+*
+*             dr funktionen loop utgr ett varv i huvudloopen och anropar
+*             cpu_load_run. Lasten fr en period utgrs drefter av andelen
+*             varv som fattas jmfrt med kalibreringen. Lasten jmnas ut
+*             ver de senaste CPU_LOAD_WINDOWS perioderna, medan hgsta
+*             lasten fr en enskild period sparas separat. Lasten skrivs ut
+*             via seriell verfring med funktionen cpu_load_print (kommandot
+*             load, se command.h), exempelvis:
+*
+*             load=12.4 peak=31.0 idle=8123/9274
+*
+*             dr load anger lasten i procent, peak anger hgsta lasten fr
+*             en period sedan start (eller senaste nollstllning) och idle
+*             anger antalet varv under senaste perioden samt antalet varv
+*             vid kalibreringen.
+*
+*             Nr vilolget r aktiverat, se idle.h, gr huvudloopen enbart
+*             ett varv per avbrott, varfr antalet varv inte lngre speglar
+*             lasten. Lasten fr en period utgrs d i stllet av andelen
+*             tid som processorn inte har sovit. Kalibreringen sker alltid
+*             med avbrott inaktiverade, varvid processorn inte sover, s att
+*             bda metoderna r tillgngliga under drift.
+*
+*             Lasten kan ven visas p 7-segmentsdisplayerna i procent
+*             (avrundat nedt) via felskningslget, se display.h, vilket
+*             aktiveras med funktionen cpu_load_enable_display.
+*
+*             Under kalibreringen r avbrott inaktiverade under en period,
+*             varfr multiplexning, tryckknappar samt detektering av strm-
+*             avbrott frdrjs motsvarande vid start. Kalibreringen avser
+*             huvudloopen utan vntande arbete, varfr arbete i huvudloopen
+*             (exempelvis utfrda kommandon) ingr i lasten i likhet med
+*             avbrottsrutinerna.
+********************************************************************************/
+#ifndef CPU_LOAD_H_
+#define CPU_LOAD_H_
+
+/* Inkluderingsdirektiv: */
+#include "misc.h"
+#include "serial.h"
+#include "soft_timer.h"
+#include "display.h"
+#include "idle.h"
+
+/* Makrodefinitioner: */
+#ifndef CPU_LOAD_WINDOW_MS
+#define CPU_LOAD_WINDOW_MS 100 /* Mtperiod (samt kalibreringstid) mtt i ms. */
+#endif
+
+#ifndef CPU_LOAD_WINDOWS
+#define CPU_LOAD_WINDOWS 8 /* Antal perioder som lasten jmnas ut ver. */
+#endif
+
+#define CPU_LOAD_FULL_SCALE 1000 /* Full last mtt i tiondels procent. */
+
+#if CPU_LOAD_WINDOWS < 1 || CPU_LOAD_WINDOWS > 64
+#error "CPU_LOAD_WINDOWS mste vara mellan 1 och 64!"
+#endif
+
+#if CPU_LOAD_WINDOW_MS * SOFT_TIMER_TICKS_PER_MS > 0xFFFFUL
+#error "CPU_LOAD_WINDOW_MS mste rymmas inom ett varv p Timer 1!"
+#endif
+
+/********************************************************************************
+* cpu_load_calibrate: Kalibrerar mtningen genom att anropa angiven funktion,
+*                     det vill sga ett varv i huvudloopen, upprepade gnger
+*                     under en period med avbrott inaktiverade. Funktionen
+*                     mste anropa cpu_load_run. Ska anropas en gng efter
+*                     att systemet har initierats.
+*
+*                     - loop: Pekare till funktionen fr ett varv i huvudloopen.
+********************************************************************************/
+void cpu_load_calibrate(void (*loop)(void));
+
+/********************************************************************************
+* cpu_load_run: Rknar varv i huvudloopen och berknar lasten nr perioden
+*               CPU_LOAD_WINDOW_MS har lpt ut. Ska anropas en gng per varv
+*               i huvudloopen.
+********************************************************************************/
+void cpu_load_run(void);
+
+/********************************************************************************
+* cpu_load_get: Returnerar lasten utjmnad ver de senaste CPU_LOAD_WINDOWS
+*               perioderna mtt i tiondels procent (0 - 1000).
+********************************************************************************/
+uint16_t cpu_load_get(void);
+
+/********************************************************************************
+* cpu_load_peak: Returnerar hgsta lasten fr en enskild period sedan start
+*                eller senaste nollstllning mtt i tiondels procent.
+********************************************************************************/
+uint16_t cpu_load_peak(void);
+
+/********************************************************************************
+* cpu_load_reset: Nollstller hgsta lasten.
+********************************************************************************/
+void cpu_load_reset(void);
+
+/********************************************************************************
+* cpu_load_display_enabled: Indikerar ifall lasten visas p 7-segments-
+*                           displayerna. Om s r fallet returneras true,
+*                           annars false.
+********************************************************************************/
+bool cpu_load_display_enabled(void);
+
+/********************************************************************************
+* cpu_load_enable_display: Visar lasten i procent p 7-segmentsdisplayerna via
+*                          felskningslget, dr vrdet uppdateras varje
+*                          period.
+********************************************************************************/
+void cpu_load_enable_display(void);
+
+/********************************************************************************
+* cpu_load_disable_display: terstller 7-segmentsdisplayerna till aktuellt tal.
+********************************************************************************/
+void cpu_load_disable_display(void);
+
+/********************************************************************************
+* cpu_load_toggle_display: Togglar visning av lasten p 7-segmentsdisplayerna.
+********************************************************************************/
+void cpu_load_toggle_display(void);
+
+/********************************************************************************
+* cpu_load_print: Skriver ut utjmnad last, hgsta last samt antalet varv i
+*                 huvudloopen under senaste perioden och vid kalibreringen
+*                 via seriell verfring.
+********************************************************************************/
+void cpu_load_print(void);
+
+#endif /* CPU_LOAD_H_ */
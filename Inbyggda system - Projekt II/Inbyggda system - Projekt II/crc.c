@@ -0,0 +1,89 @@
+/********************************************************************************
+* crc.c: Innehller definitioner av funktioner fr berkning av kontrollsummor.
+********************************************************************************/
+#include "crc.h"
+
+/********************************************************************************
+* crc8_update: Uppdaterar angiven CRC-8 med ytterligare en byte och returnerar
+*              den nya kontrollsumman. Byten adderas (XOR) till kontroll-
+*              summan, varefter polynomdivisionen genomfrs en bit i taget
+*              med mest signifikant bit frst.
+*
+*              - crc : Kontrollsumman fr fregende data.
+*              - data: Byten som ska lggas till.
+********************************************************************************/
+uint8_t crc8_update(uint8_t crc,
+                    const uint8_t data)
+{
+   crc ^= data;
+
+   for (uint8_t i = 0; i < 8; ++i)
+   {
+      crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ CRC8_POLYNOMIAL) : (uint8_t)(crc << 1);
+   }
+
+   return crc;
+}
+
+/********************************************************************************
+* crc8: Returnerar CRC-8 fr angivet datablock.
+*
+*       - data: Pekare till datablocket.
+*       - size: Datablockets storlek mtt i byte.
+********************************************************************************/
+uint8_t crc8(const void* data,
+             const uint16_t size)
+{
+   const uint8_t* bytes = (const uint8_t*)data;
+   uint8_t crc = CRC8_INIT;
+
+   for (uint16_t i = 0; i < size; ++i)
+   {
+      crc = crc8_update(crc, bytes[i]);
+   }
+
+   return crc;
+}
+
+/********************************************************************************
+* crc16_update: Uppdaterar angiven CRC-16 med ytterligare en byte och
+*               returnerar den nya kontrollsumman. Byten adderas (XOR) till
+*               de tta mest signifikanta bitarna i kontrollsumman, varefter
+*               polynomdivisionen genomfrs en bit i taget med mest
+*               signifikant bit frst.
+*
+*               - crc : Kontrollsumman fr fregende data.
+*               - data: Byten som ska lggas till.
+********************************************************************************/
+uint16_t crc16_update(uint16_t crc,
+                      const uint8_t data)
+{
+   crc ^= (uint16_t)data << 8;
+
+   for (uint8_t i = 0; i < 8; ++i)
+   {
+      crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ CRC16_POLYNOMIAL) : (uint16_t)(crc << 1);
+   }
+
+   return crc;
+}
+
+/********************************************************************************
+* crc16: Returnerar CRC-16 fr angivet datablock.
+*
+*        - data: Pekare till datablocket.
+*        - size: Datablockets storlek mtt i byte.
+********************************************************************************/
+uint16_t crc16(const void* data,
+               const uint16_t size)
+{
+   const uint8_t* bytes = (const uint8_t*)data;
+   uint16_t crc = CRC16_INIT;
+
+   for (uint16_t i = 0; i < size; ++i)
+   {
+      crc = crc16_update(crc, bytes[i]);
+   }
+
+   return crc;
+}
@@ -0,0 +1,68 @@
+/********************************************************************************
+* crc.h: Innehller funktioner fr berkning av kontrollsummor (CRC) fr
+*        detektering av korrupt data, exempelvis data i EEPROM-minnet som
+*        endast delvis hann skrivas innan strmmen brts.
+*
+*        CRC-8 berknas med polynomet x^8 + x^2 + x + 1 (0x07) och startvrde
+*        CRC8_INIT, vilket detekterar samtliga fel i upp till tre bitar samt
+*        samtliga skurfel upp till tta bitar i korta datablock. Berkningen
+*        sker bitvis utan uppslagstabell, vilket krver cirka 50 klockcykler
+*        per byte men inget RAM- eller programminne fr tabeller.
+*
+*        CRC-16 berknas med polynomet x^16 + x^12 + x^5 + 1 (0x1021) och
+*        startvrde CRC16_INIT (CRC-16/CCITT-FALSE), vilket anvnds fr
+*        lngre datablock ssom telemetripaket, dr CRC-8 inte rcker till
+*        fr att detektera fel i samma utstrckning.
+********************************************************************************/
+#ifndef CRC_H_
+#define CRC_H_
+
+/* Inkluderingsdirektiv: */
+#include "misc.h"
+
+/* Makrodefinitioner: */
+#define CRC8_POLYNOMIAL 0x07 /* Generatorpolynom fr CRC-8. */
+#define CRC8_INIT       0x00 /* Startvrde fr CRC-8. */
+
+#define CRC16_POLYNOMIAL 0x1021 /* Generatorpolynom fr CRC-16. */
+#define CRC16_INIT       0xFFFF /* Startvrde fr CRC-16. */
+
+/********************************************************************************
+* crc8_update: Uppdaterar angiven CRC-8 med ytterligare en byte och returnerar
+*              den nya kontrollsumman.
+*
+*              - crc : Kontrollsumman fr fregende data.
+*              - data: Byten som ska lggas till.
+********************************************************************************/
+uint8_t crc8_update(uint8_t crc,
+                    const uint8_t data);
+
+/********************************************************************************
+* crc8: Returnerar CRC-8 fr angivet datablock.
+*
+*       - data: Pekare till datablocket.
+*       - size: Datablockets storlek mtt i byte.
+********************************************************************************/
+uint8_t crc8(const void* data,
+             const uint16_t size);
+
+/********************************************************************************
+* crc16_update: Uppdaterar angiven CRC-16 med ytterligare en byte och
+*               returnerar den nya kontrollsumman.
+*
+*               - crc : Kontrollsumman fr fregende data.
+*               - data: Byten som ska lggas till.
+********************************************************************************/
+uint16_t crc16_update(uint16_t crc,
+                      const uint8_t data);
+
+/********************************************************************************
+* crc16: Returnerar CRC-16 fr angivet datablock.
+*
+*        - data: Pekare till datablocket.
+*        - size: Datablockets storlek mtt i byte.
+********************************************************************************/
+uint16_t crc16(const void* data,
+               const uint16_t size);
+
+#endif /* CRC_H_ */
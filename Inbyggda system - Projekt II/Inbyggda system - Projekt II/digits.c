@@ -0,0 +1,109 @@
+/********************************************************************************
+* digits.c: Innehller funktionsdefinitioner fr uppdelning av heltal i
+*           siffror via strukten digits.
+********************************************************************************/
+#include "digits.h"
+
+/********************************************************************************
+* digits_init: Initierar uppdelning av heltal i angivet antal siffror med
+*              angiven talbas. Vid felaktig talbas eller felaktigt antal
+*              siffror returneras felkod 1, annars returneras 0.
+*
+*              1. Talbasens potenser berknas via upprepad multiplikation,
+*                 vilket enbart sker vid initiering.
+*
+*              2. Maxvrdet berknas siffra fr siffra, s att exempelvis
+*                 FFFFFFFF ryms trots att 16^8 inte ryms i 32 bitar.
+*
+*              3. Om talbasen r en tvpotens lagras antalet bitar per siffra
+*                 samt motsvarande bitmask, annars nollstlls dessa.
+*
+*              - self : Pekare till strukten som ska initieras.
+*              - radix: Talbas (2 - 16).
+*              - count: Antal siffror (1 - 8).
+********************************************************************************/
+int digits_init(struct digits* self,
+                const uint8_t radix,
+                const uint8_t count)
+{
+   if (radix < DIGITS_MIN_RADIX || radix > DIGITS_MAX_RADIX) return 1;
+   if (count < 1 || count > DIGITS_MAX_COUNT) return 1;
+
+   self->radix = radix;
+   self->count = count;
+   self->max = 0;
+   self->powers[0] = 1;
+
+   for (uint8_t i = 1; i < DIGITS_MAX_COUNT; ++i)
+   {
+      self->powers[i] = i < count ? self->powers[i - 1] * radix : 0;
+   }
+
+   for (uint8_t i = 0; i < count; ++i)
+   {
+      self->max = self->max * radix + (radix - 1);
+   }
+
+   self->shift = 0;
+   self->mask = 0;
+
+   if ((radix & (radix - 1)) == 0)
+   {
+      while ((1 << self->shift) < radix) self->shift++;
+      self->mask = radix - 1;
+   }
+   return 0;
+}
+
+/********************************************************************************
+* digits_split: Delar upp angivet heltal i siffror, dr mest signifikant siffra
+*               lagras frst. Tal som verstiger maxvrdet ger hgst
+*               radix - 1 som mest signifikant siffra.
+*
+*               1. Vid tvpotens som talbas maskas minst signifikant siffra
+*                  ut, varefter talet skiftas en siffra t hger.
+*
+*               2. Annars subtraheras motsvarande potens s mnga gnger som
+*                  mjligt fr varje siffra, med start frn mest signifikant
+*                  siffra. Det som terstr efter sista subtraktionen utgr
+*                  entalet.
+*
+*               - self  : Pekare till strukten med aktuell talbas.
+*               - value : Talet som ska delas upp.
+*               - digits: Array som siffrorna ska lagras i (minst count byte).
+********************************************************************************/
+void digits_split(const struct digits* self,
+                  uint32_t value,
+                  uint8_t* digits)
+{
+   const uint8_t last = self->count - 1;
+
+   if (self->shift)
+   {
+      for (uint8_t i = self->count; i-- > 0;)
+      {
+         digits[i] = (uint8_t)value & self->mask;
+         value >>= self->shift;
+      }
+
+      if (value) digits[0] = self->mask;
+      return;
+   }
+
+   for (uint8_t i = 0; i < last; ++i)
+   {
+      const uint32_t power = self->powers[last - i];
+      uint8_t digit = 0;
+
+      while (value >= power && digit < self->radix - 1)
+      {
+         value -= power;
+         digit++;
+      }
+
+      digits[i] = digit;
+   }
+
+   digits[last] = value < self->radix ? (uint8_t)value : self->radix - 1;
+   return;
+}
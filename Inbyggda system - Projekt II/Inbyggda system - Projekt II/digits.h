@@ -0,0 +1,78 @@
+/********************************************************************************
+* digits.h: Innehller funktionalitet fr uppdelning av heltal i siffror med
+*           godtycklig talbas 2 - 16 via strukten digits samt associerade
+*           funktioner, utan division. ATmega328P saknar instruktion fr
+*           division, vilket innebr att operatorerna / och % anropar en
+*           lngsam rutin i libgcc (flera hundra klockcykler fr 32 bitar).
+*
+*           Fr talbaser som r en tvpotens (2, 4, 8 och 16) berknas varje
+*           siffra via skiftning samt maskning. Fr vriga talbaser, exempelvis
+*           decimal form, berknas talbasens potenser en gng vid initiering,
+*           varefter varje siffra berknas genom upprepad subtraktion av
+*           motsvarande potens, vilket krver hgst radix - 1 subtraktioner
+*           per siffra.
+********************************************************************************/
+#ifndef DIGITS_H_
+#define DIGITS_H_
+
+/* Inkluderingsdirektiv: */
+#include "misc.h"
+
+/* Makrodefinitioner: */
+#define DIGITS_MAX_COUNT 8  /* Maximalt antal siffror (32-bitars tal). */
+#define DIGITS_MIN_RADIX 2  /* Lgsta talbas. */
+#define DIGITS_MAX_RADIX 16 /* Hgsta talbas. */
+
+/********************************************************************************
+* digits: Strukt fr uppdelning av heltal i ett fast antal siffror med given
+*         talbas. Samtliga tabeller berknas vid initiering, s att sjlva
+*         uppdelningen enbart krver skiftningar eller subtraktioner.
+********************************************************************************/
+struct digits
+{
+   uint32_t powers[DIGITS_MAX_COUNT]; /* Talbasens potenser, dr powers[i] = radix^i. */
+   uint32_t max;                      /* Strsta tal som ryms i angivet antal siffror. */
+   uint8_t radix;                     /* Talbas. */
+   uint8_t count;                     /* Antal siffror. */
+   uint8_t shift;                     /* Antal bitar per siffra, 0 om talbasen inte r en tvpotens. */
+   uint8_t mask;                      /* Bitmask fr en siffra vid tvpotens som talbas. */
+};
+
+/********************************************************************************
+* digits_init: Initierar uppdelning av heltal i angivet antal siffror med
+*              angiven talbas. Vid felaktig talbas eller felaktigt antal
+*              siffror returneras felkod 1, annars returneras 0.
+*
+*              - self : Pekare till strukten som ska initieras.
+*              - radix: Talbas (2 - 16).
+*              - count: Antal siffror (1 - 8).
+********************************************************************************/
+int digits_init(struct digits* self,
+                const uint8_t radix,
+                const uint8_t count);
+
+/********************************************************************************
+* digits_split: Delar upp angivet heltal i siffror, dr mest signifikant siffra
+*               lagras frst. Tal som verstiger maxvrdet ger hgst
+*               radix - 1 som mest signifikant siffra.
+*
+*               - self  : Pekare till strukten med aktuell talbas.
+*               - value : Talet som ska delas upp.
+*               - digits: Array som siffrorna ska lagras i (minst count byte).
+********************************************************************************/
+void digits_split(const struct digits* self,
+                  uint32_t value,
+                  uint8_t* digits);
+
+/********************************************************************************
+* digits_max: Returnerar strsta tal som kan delas upp med aktuell talbas och
+*             aktuellt antal siffror, exempelvis 99 fr tv decimala siffror.
+*
+*             - self: Pekare till strukten med aktuell talbas.
+********************************************************************************/
+static inline uint32_t digits_max(const struct digits* self)
+{
+   return self->max;
+}
+
+#endif /* DIGITS_H_ */
@@ -1,104 +1,144 @@
 /********************************************************************************
-* display.h: Innehller drivrutiner fr tv 7-segmentsdisplayer anslutna till
-*            till PORTD0 - PORTD6 (pin 0 - 6), som kan visa tv siffror i binr,
-*            decimal eller hexadecimal form. Matningsspnningen fr respektive
-*            7-segmentsdisplay genereras frn PORTD7 (pin 7) respektive
-*            PORTC3 (pin A3), dr lg signal medfr tnd display, d displayerna
-*            har gemensam katod.
+* display.c: Innehller drivrutiner fr DISPLAY_DIGIT_COUNT stycken
+*            7-segmentsdisplayer anslutna till PORTD0 - PORTD6 (pin 0 - 6),
+*            som kan visa tal med godtycklig talbas 2 - 16, exempelvis i
+*            binr, oktal, decimal eller hexadecimal form. Varje display
+*            tnds via sin katod, vars pin anges i tabellen
+*            DISPLAY_CATHODE_PINS, dr lg signal medfr tnd display.
 ********************************************************************************/
 #include "display.h"
 
 /********************************************************************************
 * Makrodefinitioner:
+*
+*   - DISPLAY_SEGMENT_MASK     : Bitar i PORTD som anvnds fr segmenten a - g.
+*   - EEPROM_NUMBER_RING       : Frsta adressen i omrdet dr aktuellt tal
+*                                lagras slitageutjmnat, se eeprom_ring.h.
+*   - EEPROM_NUMBER_RING_SLOTS : Antal platser i omrdet (5 byte per plats),
+*                                vilket ger adress 512 - 1011.
 ********************************************************************************/
-#define DISPLAY1_CATHODE PORTD7 /* Katod fr display 1. */
-#define DISPLAY2_CATHODE PORTC3 /* Katod fr display 2. */
-
-#define DISPLAY1_ON  PORTD &= ~(1 << DISPLAY1_CATHODE) /* Tnder display 1. */
-#define DISPLAY2_ON  PORTC &= ~(1 << DISPLAY2_CATHODE) /* Tnder display 2. */
-#define DISPLAY1_OFF PORTD |= (1 << DISPLAY1_CATHODE)  /* Slcker display 1. */
-#define DISPLAY2_OFF PORTC |= (1 << DISPLAY2_CATHODE)  /* Slcker display 2. */
-
-#define OFF 0x00   /* Binrkod fr slckning av 7-segmentsdisplay. */
-#define ZERO 0x3F  /* Binrkod fr utskrift av heltalet 0 p 7-segmentsdisplay. */
-#define ONE 0x06   /* Binrkod fr utskrift av heltalet 1 p 7-segmentsdisplay. */
-#define TWO 0x5B   /* Binrkod fr utskrift av heltalet 2 p 7-segmentsdisplay. */
-#define THREE 0x4F /* Binrkod fr utskrift av heltalet 3 p 7-segmentsdisplay. */
-#define FOUR 0x66  /* Binrkod fr utskrift av heltalet 4 p 7-segmentsdisplay. */
-#define FIVE 0x6D  /* Binrkod fr utskrift av heltalet 5 p 7-segmentsdisplay. */
-#define SIX 0x7D   /* Binrkod fr utskrift av heltalet 6 p 7-segmentsdisplay. */
-#define SEVEN 0x07 /* Binrkod fr utskrift av heltalet 7 p 7-segmentsdisplay. */
-#define EIGHT 0x7F /* Binrkod fr utskrift av heltalet 8 p 7-segmentsdisplay. */
-#define NINE 0x6F  /* Binrkod fr utskrift av heltalet 9 p 7-segmentsdisplay. */
-#define A 0x77     /* Binrkod fr utskrift av heltalet 0xA (10) p 7-segmentsdisplay. */
-#define B 0x7C     /* Binrkod fr utskrift av heltalet 0xB (11) p 7-segmentsdisplay. */
-#define C 0x39     /* Binrkod fr utskrift av heltalet 0xC (12) p 7-segmentsdisplay. */
-#define D 0x5E     /* Binrkod fr utskrift av heltalet 0xD (13) p 7-segmentsdisplay. */
-#define E 0x79     /* Binrkod fr utskrift av heltalet 0xE (14) p 7-segmentsdisplay. */
-#define F 0x71     /* Binrkod fr utskrift av heltalet 0xF (15) p 7-segmentsdisplay. */
-
-#define EEPROM_NUMBER          500
-#define EEPROM_OUTPUT_ENABLED  501
-#define EEPROM_COUNT_ENABLED   502
-#define EEPROM_COUNT_DIRECTION 503
-
-/********************************************************************************
-* display_digit: Enumeration fr selektion av de olika displayerna.
-********************************************************************************/
-enum display_digit
-{
-   DISPLAY_DIGIT1, /* Display 1, som visar tiotal. */
-   DISPLAY_DIGIT2  /* Display 2, som visar ental. */
+#define DISPLAY_SEGMENT_MASK 0x7F
+
+#define EEPROM_NUMBER_RING       512
+#define EEPROM_NUMBER_RING_SLOTS 100
+
+/********************************************************************************
+* display_cathode: Strukt fr katoden till en 7-segmentsdisplay, dr pekare
+*                  till dataregistret samt bitmasken fr aktuell pin berknas
+*                  en gng vid initiering, s att displayen kan tndas och
+*                  slckas med en enda skrivning oavsett I/O-port.
+********************************************************************************/
+struct display_cathode
+{
+   volatile uint8_t* port; /* Pekare till dataregistret fr katodens pin. */
+   uint8_t mask;           /* Bitmask fr katodens pin i dataregistret. */
 };
 
 /********************************************************************************
 * Statiska funktioner:
 ********************************************************************************/
-static inline void display_update_output(const uint8_t digit);
-static inline uint8_t display_get_binary_code(const uint8_t digit);
+static void display_init_cathode(struct display_cathode* self,
+                                 const uint8_t pin);
+static inline void display_cathode_on(const struct display_cathode* self);
+static inline void display_cathode_off(const struct display_cathode* self);
+static void display_all_off(void);
+static inline void display_update_output(const uint8_t segments);
+static void display_update_frame(void);
+static void display_count_frame(const bool count_up);
+static inline display_number_t display_shown_number(void);
 static inline void read_eeprom(void);
 
 /********************************************************************************
 * Statiska variabler:
 *
 *   - number : Talet som skrivs ut p displayerna.
-*   - digit1 : Tiotalet som skrivs ut p display 1.
-*   - digit2 : Entalet som skrivs ut p display 2. 
 *   - radix  : Talbas (default = 10, dvs. decimal form).
-*   - max_val: Maxvrde fr tal p 7-segmentsdisplayerna (beror p talbasen).
+*   - max_val: Maxvrde fr tal p 7-segmentsdisplayerna (beror p talbasen
+*              samt antalet displayer).
+*   - digits : Tabeller fr uppdelning av aktuellt tal i siffror utan division.
+*
+*   - count_digits      : Aktuellt tals siffror, dr index 0 r mest
+*                         signifikant siffra. Anvnds vid upprkning, s att
+*                         enbart de siffror som ndras behver uppdateras.
+*   - count_digits_valid: Indikerar ifall count_digits motsvarar aktuellt tal.
+*                         Stts till false nr talet eller talbasen ndras
+*                         utifrn och till true nr bufferten har berknats
+*                         om frn talet.
+*   - first_digit       : Index fr mest signifikant siffra som inte r noll
+*                         (sista siffran om talet r noll). Siffror till
+*                         vnster om denna slcks.
+*
+*   - debug_enabled: Indikerar ifall felskningslget r aktiverat, dr
+*                    debug_value visas i stllet fr aktuellt tal.
+*   - debug_value  : Felskningsvrdet, exempelvis processorlasten.
 *
 *   - count_direction: Indikerar rkningsriktning, dr default r upprkning.
-*   - current_digit  : Indikerar vilken av aktuellt tals siffror som skrivs ut
-*                      p aktiverad 7-segmentsdisplay, dr default r tiotalet 
-*                      p display 1.
+*   - current_digit  : Index fr displayen som r tnd, dr index 0 r den
+*                      vnstra displayen, som visar mest signifikant siffra.
+*
+*   - cathode_pins: Katodernas pin-nummer, se DISPLAY_CATHODE_PINS.
+*   - cathodes    : Katodernas dataregister samt bitmasker.
+*
+*   - frame       : Dubbelbuffrade binrkoder fr respektive display. Nya
+*                   binrkoder skrivs alltid till bakre bufferten, som sedan
+*                   blir frmre buffert via en enda byteskrivning till
+*                   front_frame, vilket r atomrt.
+*   - front_frame : Index fr bufferten som senast frdigstlldes.
+*   - shown_frame : Index fr bufferten som skrivs ut under pgende varv
+*                   av multiplexningen. Lses vid display 1, s att samtliga
+*                   displayer alltid visar samma tal.
+*
+*   - timer_digit      : Mjukvarutimer fr att skifta displayer.
+*   - timer_count_speed: Mjukvarutimer fr upprkning av heltal.
 *
-*   - timer_digit      : Timerkrets fr att skifta displayer (Timer 1).
-*   - timer_count_speed: Timerkrets fr upprkning av heltal (Timer 2).
+*   - number_ring : Slitageutjmnad lagring av aktuellt tal i EEPROM-minnet,
+*                   vilket enbart sker vid strmavbrott.
 ********************************************************************************/
-static uint8_t number = 0;   
-static uint8_t digit1 = 0;   
-static uint8_t digit2 = 0;   
+static display_number_t number = 0;   
 static uint8_t radix = 10;   
-static uint8_t max_val = 99; 
+static display_number_t max_val = 0; 
+static struct digits digits;
+
+static uint8_t count_digits[DISPLAY_DIGIT_COUNT];
+static bool count_digits_valid = false;
+static uint8_t first_digit = DISPLAY_DIGIT_COUNT - 1;
+
+static bool debug_enabled = false;
+static display_number_t debug_value = 0;
 
 static enum display_count_direction count_direction = DISPLAY_COUNT_DIRECTION_UP;
-static enum display_digit current_digit = DISPLAY_DIGIT1;
+static uint8_t current_digit = DISPLAY_DIGIT_COUNT - 1;
+
+static const uint8_t cathode_pins[DISPLAY_DIGIT_COUNT] = DISPLAY_CATHODE_PINS;
+static struct display_cathode cathodes[DISPLAY_DIGIT_COUNT];
 
-static struct timer timer_digit;       
-static struct timer timer_count_speed; 
+static uint8_t frame[2][DISPLAY_DIGIT_COUNT];
+static volatile uint8_t front_frame = 0;
+static uint8_t shown_frame = 0;
+
+static struct soft_timer timer_digit;
+static struct soft_timer timer_count_speed;
+
+static struct eeprom_ring number_ring;
 
 /********************************************************************************
 * display_init: Initierar hrdvara fr 7-segmentsdisplayer.
 ********************************************************************************/
 void display_init(void)
 {
-   DDRD = 0xFF; 
-   DDRC |= (1 << DISPLAY2_CATHODE); 
-   DISPLAY1_OFF;
-   DISPLAY2_OFF;
+   DDRD |= DISPLAY_SEGMENT_MASK; 
 
-   timer_init(&timer_digit, TIMER_SEL_1, 1);
-   timer_init(&timer_count_speed, TIMER_SEL_2, 1000);
+   for (uint8_t i = 0; i < DISPLAY_DIGIT_COUNT; ++i)
+   {
+      display_init_cathode(&cathodes[i], cathode_pins[i]);
+   }
+
+   digits_init(&digits, radix, DISPLAY_DIGIT_COUNT);
+   max_val = (display_number_t)digits_max(&digits);
+   display_update_frame();
+
+   soft_timer_init(&timer_digit, DISPLAY_DIGIT_TIME_MS, display_toggle_digit);
+   soft_timer_init(&timer_count_speed, 1000, display_count);
    
    read_eeprom();
    return;
@@ -109,19 +149,20 @@ void display_init(void)
 ********************************************************************************/
 void display_reset(void)
 {
-   timer_reset(&timer_digit);
-   timer_reset(&timer_count_speed);
-   DISPLAY1_OFF;
-   DISPLAY2_OFF;
+   soft_timer_stop(&timer_digit);
+   soft_timer_stop(&timer_count_speed);
+   display_all_off();
 
    number = 0;
-   digit1 = 0;
-   digit2 = 0;
    radix = 10;
-   max_val = 99;
+   debug_enabled = false;
+   debug_value = 0;
+   digits_init(&digits, radix, DISPLAY_DIGIT_COUNT);
+   max_val = (display_number_t)digits_max(&digits);
+   display_update_frame();
 
    count_direction = DISPLAY_COUNT_DIRECTION_UP;
-   current_digit = DISPLAY_DIGIT1;
+   current_digit = DISPLAY_DIGIT_COUNT - 1;
    return;
 }
 
@@ -131,7 +172,7 @@ void display_reset(void)
 ********************************************************************************/
 bool display_output_enabled(void)
 {
-   return timer_interrupt_enabled(&timer_digit);
+   return soft_timer_running(&timer_digit);
 }
 
 /********************************************************************************
@@ -141,7 +182,7 @@ bool display_output_enabled(void)
 ********************************************************************************/
 bool display_count_enabled(void)
 {
-   return timer_interrupt_enabled(&timer_count_speed);
+   return soft_timer_running(&timer_count_speed);
 }
 
 /********************************************************************************
@@ -149,8 +190,8 @@ bool display_count_enabled(void)
 ********************************************************************************/
 void display_enable_output(void)
 {
-   timer_enable_interrupt(&timer_digit);
-   eeprom_write_byte(EEPROM_OUTPUT_ENABLED, 1);
+   soft_timer_start(&timer_digit);
+   config_set_output_enabled(true);
    return;
 }
 
@@ -159,10 +200,9 @@ void display_enable_output(void)
 ********************************************************************************/
 void display_disable_output(void)
 {
-   timer_reset(&timer_digit);
-   eeprom_write_byte(EEPROM_OUTPUT_ENABLED, 0);
-   DISPLAY1_OFF;
-   DISPLAY2_OFF;
+   soft_timer_stop(&timer_digit);
+   config_set_output_enabled(false);
+   display_all_off();
    return;
 }
 
@@ -185,20 +225,22 @@ void display_toggle_output(void)
 /********************************************************************************
 * display_set_number: Stter nytt heltal fr utskrift p 7-segmentsdisplayer.
 *                     Om angivet heltal verstiger maxvrdet som kan skrivas ut
-*                     p tv 7-segmentsdisplayer med aktuell talbas returneras
+*                     p samtliga 7-segmentsdisplayer med aktuell talbas returneras
 *                     felkod 1. Annars returneras heltalet 0 efter att heltalet
 *                     p 7-segmentsdisplayerna har uppdaterats.
 *
 *                     - new_number: Nytt tal som ska skrivas ut p displayerna.
 ********************************************************************************/
-int display_set_number(const uint8_t new_number)
+int display_set_number(const display_number_t new_number)
 {
    if (new_number <= max_val)
    {
+      const uint8_t sreg = atomic_begin();
       number = new_number; 
-      digit1 = number / radix; 
-      digit2 = number - digit1 * radix;
-	  eeprom_write_byte(EEPROM_NUMBER, number);
+      count_digits_valid = false;
+      atomic_end(sreg);
+
+      display_update_frame();
       return 0;
    }
    else
@@ -208,9 +250,10 @@ int display_set_number(const uint8_t new_number)
 }
 
 /********************************************************************************
-* display_set_radix: Stter ny talbas till 2, 10 eller 16 utskrift av tal p
-*                    7-segmentsdisplayer. Drmed kan tal skrivas ut binrt
-*                    (00 - 11), decimalt (00 - 99) eller hexadecimalt (00 - FF).
+* display_set_radix: Stter ny talbas 2 - 16 fr utskrift av tal p
+*                    7-segmentsdisplayer. Drmed kan tal exempelvis skrivas ut
+*                    binrt, oktalt, decimalt eller hexadecimalt, exempelvis
+*                    00 - 11, 00 - 77, 00 - 99 eller 00 - FF p tv displayer.
 *                    Vid felaktigt angiven talbas returneras felkod 1. Annars
 *                    returneras heltalet 0 efter att anvnd talbas har
 *                    uppdaterats.
@@ -219,10 +262,18 @@ int display_set_number(const uint8_t new_number)
 ********************************************************************************/
 int display_set_radix(const uint8_t new_radix)
 {
-   if (new_radix == 2 || new_radix == 10 || new_radix == 16)
+   struct digits new_digits;
+
+   if (digits_init(&new_digits, new_radix, DISPLAY_DIGIT_COUNT) == 0)
    {
+      const uint8_t sreg = atomic_begin();
+      digits = new_digits;
       radix = new_radix;
-      max_val = radix * radix - 1;
+      max_val = (display_number_t)digits_max(&digits);
+      count_digits_valid = false;
+      atomic_end(sreg);
+
+      display_update_frame();
       return 0;
    }
    else
@@ -232,76 +283,74 @@ int display_set_radix(const uint8_t new_radix)
 }
 
 /********************************************************************************
-* display_toggle_digit: Skiftar aktiverad 7-segmentsdisplay fr utskrift av
-*                       tiotal och ental, vilket r ndvndigt, d displayerna
-*                       delar p samma pinnar. Enbart en vrdesiffra skrivs
-*                       ut om mjligt, exempelvis 9 i stllet fr 09. Denna
-*                       funktion br anropas en gng per millisekund fr att
-*                       ett givet tvsiffrigt tal ska upplevas skrivas ut
-*                       kontinuerligt.
+* display_toggle_digit: Skiftar aktiverad 7-segmentsdisplay till nsta display
+*                       i tur (round robin), vilket r ndvndigt, d
+*                       displayerna delar p samma pinnar. Binrkoderna r
+*                       frberknade i bufferten frame, s att enbart en byte
+*                       skrivs ut innan katoden skiftas, oavsett antalet
+*                       displayer. Vid display 1 lses den senast frdigstllda
+*                       bufferten fr hela varvet. Denna funktion anropas
+*                       en gng per DISPLAY_DIGIT_TIME_MS av displayernas
+*                       mjukvarutimer nr displayerna r p.
 ********************************************************************************/
 void display_toggle_digit(void)
 {
-   timer_count(&timer_digit);
+   display_cathode_off(&cathodes[current_digit]);
 
-   if (timer_elapsed(&timer_digit))
+   if (++current_digit >= DISPLAY_DIGIT_COUNT)
    {
-      current_digit = !current_digit;
-
-      if (current_digit == DISPLAY_DIGIT1)
-      {
-         DISPLAY2_OFF;
-
-         if (digit1 == 0)
-         {
-            DISPLAY1_OFF;
-         }
-         else
-         {
-            display_update_output(digit1);
-            DISPLAY1_ON;
-         }
-      }
-      else
-      {
-         DISPLAY1_OFF;
-         display_update_output(digit2);
-         DISPLAY2_ON;
-      }
+      current_digit = 0;
+      shown_frame = front_frame;
    }
+
+   display_update_output(frame[shown_frame][current_digit]);
+   display_cathode_on(&cathodes[current_digit]);
    return;
 }
 
 /********************************************************************************
-* display_count: Rknar upp eller ned tal p 7-segmentsdisplayer.
+* display_count: Rknar upp eller ned tal p 7-segmentsdisplayer. Denna
+*                funktion anropas av mjukvarutimern timer_count_speed varje
+*                gng den lper ut.
 *
-*                1. Rknar upp lpt tid via timern timer_count_speed.
-*                2. Nr timern lpt ut sker upp/nedrkning.
-*                3. Vid upprkning, inkrementera variabeln number upp till
+*                1. Vid upprkning, inkrementera variabeln number upp till
 *                   och med aktuellt maxvrde max_count, annars nollstll.
-*                4. Vid nedrkning, dekrementera variabeln number till 0,
+*                2. Vid nedrkning, dekrementera variabeln number till 0,
 *                   drefter stt den till max_val.
-*                5. Uppdatera tiotal och ental via anrop av funktionen
-*                   display_set_number.
+*                3. Om siffrorna i count_digits motsvarar fregende tal
+*                   rknas dessa upp eller ned siffra fr siffra med minnes-
+*                   siffra, s att enbart ndrade siffror uppdateras. Annars
+*                   berknas samtliga siffror om frn talet.
+*
+*                Talet lagras inte i EEPROM-minnet vid upprkning, utan
+*                enbart vid strmavbrott, se display_power_fail.
 ********************************************************************************/
 void display_count(void)
 {
-   timer_count(&timer_count_speed);
-   
-   if (timer_elapsed(&timer_count_speed))
+   const uint8_t sreg = atomic_begin();
+
+   if (count_direction == DISPLAY_COUNT_DIRECTION_UP)
    {
-      if (count_direction == DISPLAY_COUNT_DIRECTION_UP)
-      {
-         if (number >= max_val) number = 0;
-         else number++;
-      }
-      else
-      {
-         if (number == 0) number = max_val;
-         else number--;
-      }
-      display_set_number(number); 
+      if (number >= max_val) number = 0;
+      else number++;
    }
+   else
+   {
+      if (number == 0) number = max_val;
+      else number--;
+   }
+
+   if (count_digits_valid)
+   {
+      display_count_frame(count_direction == DISPLAY_COUNT_DIRECTION_UP);
+      atomic_end(sreg);
+   }
+   else
+   {
+      atomic_end(sreg);
+      display_update_frame();
+   }
+
    return;
 }
 
@@ -314,7 +363,7 @@ void display_count(void)
 void display_set_count_direction(const enum display_count_direction new_direction)
 {
    count_direction = new_direction;
-   eeprom_write_byte(EEPROM_COUNT_DIRECTION, (uint8_t)(count_direction));
+   config_set_count_direction((uint8_t)(count_direction));
    return;
 }
 
@@ -325,7 +374,7 @@ void display_set_count_direction(const enum display_count_direction new_directio
 void display_toggle_count_direction(void)
 {
    count_direction = !count_direction;
-   eeprom_write_byte(EEPROM_COUNT_DIRECTION, (uint8_t)(count_direction)); 
+   config_set_count_direction((uint8_t)(count_direction));
    return;
 }
 
@@ -340,8 +389,8 @@ void display_set_count(const enum display_count_direction direction,
                        const uint16_t count_speed_ms)
 {
    count_direction = direction;
-   timer_set_new_time(&timer_count_speed, count_speed_ms);
-   eeprom_write_byte(EEPROM_COUNT_DIRECTION, (uint8_t)(count_direction)); 
+   soft_timer_set_new_time(&timer_count_speed, count_speed_ms);
+   config_set_count_direction((uint8_t)(count_direction));
    return;
 }
 
@@ -353,8 +402,8 @@ void display_set_count(const enum display_count_direction direction,
 ********************************************************************************/
 void display_enable_count(void)
 {
-   timer_enable_interrupt(&timer_count_speed);
-   eeprom_write_byte(EEPROM_COUNT_ENABLED, 1);
+   soft_timer_start(&timer_count_speed);
+   config_set_count_enabled(true);
    return;
 }
 
@@ -364,8 +413,8 @@ void display_enable_count(void)
 ********************************************************************************/
 void display_disable_count(void)
 {
-   timer_reset(&timer_count_speed);
-   eeprom_write_byte(EEPROM_COUNT_ENABLED, 0);
+   soft_timer_stop(&timer_count_speed);
+   config_set_count_enabled(false);
    return;
 }
 
@@ -387,54 +436,392 @@ void display_toggle_count(void)
 }
 
 /********************************************************************************
-* display_update_output: Skriver ny siffra till aktiverad 7-segmentsdisplay.
+* display_get_number: Returnerar talet som skrivs ut p 7-segmentsdisplayerna.
 ********************************************************************************/
-static inline void display_update_output(const uint8_t digit)
+display_number_t display_get_number(void)
 {
-   PORTD &= (1 << DISPLAY1_CATHODE);
-   PORTD |= display_get_binary_code(digit);
+   const uint8_t sreg = atomic_begin();
+   const display_number_t value = number;
+   atomic_end(sreg);
+   return value;
+}
+
+/********************************************************************************
+* display_get_radix: Returnerar talbasen som anvnds vid utskrift av tal p
+*                    7-segmentsdisplayerna.
+********************************************************************************/
+uint8_t display_get_radix(void)
+{
+   return radix;
+}
+
+/********************************************************************************
+* display_get_count_direction: Returnerar aktuell upprkningsriktning fr tal
+*                              som skrivs ut p 7-segmentsdisplayerna.
+********************************************************************************/
+enum display_count_direction display_get_count_direction(void)
+{
+   return count_direction;
+}
+
+/********************************************************************************
+* display_debug_enabled: Indikerar ifall felskningslget r aktiverat. Vid
+*                        aktiverat felskningslge returneras true, annars
+*                        false.
+********************************************************************************/
+bool display_debug_enabled(void)
+{
+   return debug_enabled;
+}
+
+/********************************************************************************
+* display_enable_debug: Aktiverar felskningslget, s att 7-segments-
+*                       displayerna visar felskningsvrdet. Siffrorna i
+*                       count_digits markeras som ogiltiga, s att upprkning
+*                       av talet i bakgrunden inte skriver ver felsknings-
+*                       vrdet, utan enbart ritar om detta.
+********************************************************************************/
+void display_enable_debug(void)
+{
+   const uint8_t sreg = atomic_begin();
+   debug_enabled = true;
+   count_digits_valid = false;
+   atomic_end(sreg);
+
+   display_update_frame();
+   return;
+}
+
+/********************************************************************************
+* display_disable_debug: Inaktiverar felskningslget, s att 7-segments-
+*                        displayerna ter visar aktuellt tal.
+********************************************************************************/
+void display_disable_debug(void)
+{
+   const uint8_t sreg = atomic_begin();
+   debug_enabled = false;
+   count_digits_valid = false;
+   atomic_end(sreg);
+
+   display_update_frame();
    return;
 }
 
 /********************************************************************************
-* display_get_binary_code: Returnerar binrkod fr angivet heltal 0 - 15 fr
-*                          utskrift p 7-segmentsdisplayer. Vid felaktigt
-*                          angivet heltal (ver 15) returneras binrkod fr
-*                          slckning av 7-segmentsdisplayer.
+* display_set_debug_value: Stter nytt felskningsvrde, som visas p
+*                          7-segmentsdisplayerna i felskningslget.
 *
-*                          - digit: Heltal vars binrkod ska returneras.
-********************************************************************************/
-static inline uint8_t display_get_binary_code(const uint8_t digit)
-{
-   if (digit == 0)       return ZERO;
-   else if (digit == 1)  return ONE;
-   else if (digit == 2)  return TWO;
-   else if (digit == 3)  return THREE;
-   else if (digit == 4)  return FOUR;
-   else if (digit == 5)  return FIVE;
-   else if (digit == 6)  return SIX;
-   else if (digit == 7)  return SEVEN;
-   else if (digit == 8)  return EIGHT;
-   else if (digit == 9)  return NINE;
-   else if (digit == 10) return A;
-   else if (digit == 11) return B;
-   else if (digit == 12) return C;
-   else if (digit == 13) return D;
-   else if (digit == 14) return E;
-   else if (digit == 15) return F;
-   else                  return OFF;
+*                          - value: Nytt felskningsvrde.
+********************************************************************************/
+void display_set_debug_value(const display_number_t value)
+{
+   const uint8_t sreg = atomic_begin();
+   debug_value = value;
+   atomic_end(sreg);
+
+   if (debug_enabled) display_update_frame();
+   return;
+}
+
+/********************************************************************************
+* display_power_fail: Frbereder 7-segmentsdisplayerna fr strmavbrott.
+*                     Multiplexning samt upprkning stoppas och samtliga
+*                     displayer slcks, vilket minskar strmfrbrukningen
+*                     s att lagringen hinner slutfras. Drefter lggs
+*                     aktuellt tal i k fr slitageutjmnad lagring i
+*                     EEPROM-minnet. Instllningarna pverkas inte, s att
+*                     displayerna startar i samma lge vid nsta uppstart.
+*                     Funktionen anropas vid detekterat strmavbrott, se
+*                     power.h.
+********************************************************************************/
+void display_power_fail(void)
+{
+   soft_timer_stop(&timer_digit);
+   soft_timer_stop(&timer_count_speed);
+   display_all_off();
+   eeprom_ring_write(&number_ring, display_get_number());
+   return;
+}
+
+/********************************************************************************
+* display_power_restore: terupptar multiplexning samt upprkning enligt
+*                        instllningarna efter att matningsspnningen har
+*                        terhmtat sig utan att systemet hann terstllas.
+********************************************************************************/
+void display_power_restore(void)
+{
+   const struct config* config = config_get();
+   if (config->output_enabled) soft_timer_start(&timer_digit);
+   if (config->count_enabled) soft_timer_start(&timer_count_speed);
+   return;
+}
+
+/********************************************************************************
+* display_init_cathode: Initierar katod fr en 7-segmentsdisplay p angiven pin
+*                       som utport, dr displayen initialt r slckt.
+*
+*                       - self: Pekare till katoden som ska initieras.
+*                       - pin : Katodens pin-nummer p Arduino Uno, exempelvis
+*                               7 eller A3. Alternativt kan motsvarande
+*                               port-nummer p ATmega328P anges, exempelvis D7
+*                               eller C3. PORTD0 - PORTD6 r upptagna av
+*                               segmenten och kan drmed inte anvndas.
+*
+*                       Ogiltig pin (ver 19) frkastas, varvid bitmasken
+*                       stts till 0, s att tndning och slckning av
+*                       displayen saknar effekt i stllet fr att skriva via
+*                       en oinitierad pekare. Drmed frblir displayen slckt.
+********************************************************************************/
+static void display_init_cathode(struct display_cathode* self,
+                                 const uint8_t pin)
+{
+   if (pin <= 7)
+   {
+      self->port = &PORTD;
+      self->mask = (1 << pin);
+      DDRD |= self->mask;
+   }
+   else if (pin <= 13)
+   {
+      self->port = &PORTB;
+      self->mask = (1 << (pin - 8));
+      DDRB |= self->mask;
+   }
+   else if (pin <= 19)
+   {
+      self->port = &PORTC;
+      self->mask = (1 << (pin - 14));
+      DDRC |= self->mask;
+   }
+   else
+   {
+      self->port = &PORTD;
+      self->mask = 0x00;
+   }
+
+   display_cathode_off(self);
+   return;
+}
+
+/********************************************************************************
+* display_cathode_on: Tnder 7-segmentsdisplayen med angiven katod.
+*
+*                     - self: Pekare till displayens katod.
+********************************************************************************/
+static inline void display_cathode_on(const struct display_cathode* self)
+{
+   *(self->port) &= ~(self->mask);
+   return;
+}
+
+/********************************************************************************
+* display_cathode_off: Slcker 7-segmentsdisplayen med angiven katod.
+*
+*                      - self: Pekare till displayens katod.
+********************************************************************************/
+static inline void display_cathode_off(const struct display_cathode* self)
+{
+   *(self->port) |= self->mask;
+   return;
+}
+
+/********************************************************************************
+* display_all_off: Slcker samtliga 7-segmentsdisplayer.
+********************************************************************************/
+static void display_all_off(void)
+{
+   for (uint8_t i = 0; i < DISPLAY_DIGIT_COUNT; ++i)
+   {
+      display_cathode_off(&cathodes[i]);
+   }
+   return;
+}
+
+/********************************************************************************
+* display_update_output: Skriver ny binrkod till aktiverad 7-segmentsdisplay
+*                        via en enda skrivning till PORTD, dr vriga pinnar
+*                        p PORTD (exempelvis katoden p PORTD7) lmnas orrda.
+*
+*                        - segments: Binrkoden som ska skrivas ut.
+********************************************************************************/
+static inline void display_update_output(const uint8_t segments)
+{
+   PORTD = (PORTD & ~DISPLAY_SEGMENT_MASK) | (segments & DISPLAY_SEGMENT_MASK);
+   return;
+}
+
+/********************************************************************************
+* display_update_frame: Berknar binrkoder fr aktuellt tal och skriver dessa
+*                       till bakre bufferten, som drefter blir frmre buffert.
+*                       Inledande nollor slcks hr i stllet fr vid utskrift,
+*                       exempelvis visas 9 i stllet fr 09. Talet delas upp
+*                       i siffror via strukten digits, som inte krver division.
+*                       I felskningslget visas felskningsvrdet i stllet
+*                       fr talet, se display_shown_number.
+*
+*                       Siffrorna berknas med avbrott aktiverade utifrn en
+*                       kopia av aktuellt tal och talbas. Bufferten skrivs
+*                       sedan med avbrott inaktiverade, dock enbart om talet
+*                       inte har ndrats under tiden, d ett senare anrop i s
+*                       fall redan har skrivit en nyare buffert. Drmed kan
+*                       tv anrop frn olika avbrottsniver inte skriva till
+*                       samma buffert samtidigt.
+********************************************************************************/
+static void display_update_frame(void)
+{
+   uint8_t values[DISPLAY_DIGIT_COUNT];
+   uint8_t segments[DISPLAY_DIGIT_COUNT];
+   uint8_t first = DISPLAY_DIGIT_COUNT - 1;
+   const uint8_t sreg = atomic_begin();
+   const display_number_t copy = display_shown_number();
+   const uint8_t base = radix;
+   atomic_end(sreg);
+
+   digits_split(&digits, copy, values);
+
+   for (uint8_t i = DISPLAY_DIGIT_COUNT; i-- > 0;)
+   {
+      if (values[i]) first = i;
+   }
+
+   for (uint8_t i = 0; i < DISPLAY_DIGIT_COUNT; ++i)
+   {
+      segments[i] = i < first ? FONT_BLANK : font_get_digit(values[i]);
+   }
+
+   atomic_disable();
+
+   if (display_shown_number() == copy && radix == base)
+   {
+      uint8_t* back = frame[!front_frame];
+
+      for (uint8_t i = 0; i < DISPLAY_DIGIT_COUNT; ++i)
+      {
+         back[i] = segments[i];
+         count_digits[i] = values[i];
+      }
+
+      first_digit = first;
+      count_digits_valid = !debug_enabled && copy <= max_val;
+      front_frame = !front_frame;
+   }
+
+   atomic_end(sreg);
+   return;
+}
+
+/********************************************************************************
+* display_count_frame: Rknar upp eller ned siffrorna i count_digits ett steg
+*                      med minnessiffra (carry/borrow), ssom vid rkning fr
+*                      hand, och skriver ny buffert. Enbart de siffror som
+*                      ndras, dvs. sista siffran samt eventuella siffror som
+*                      slr om, berknas. vriga binrkoder kopieras frn
+*                      frmre bufferten. Ingen division krvs. Mste anropas
+*                      med avbrott inaktiverade.
+*
+*                      1. Med start frn sista siffran slr varje siffra som
+*                         redan har ntt radix - 1 (vid upprkning) eller
+*                         0 (vid nedrkning) om, varefter nsta siffra rknas.
+*                         Om samtliga siffror slr om sker omslag frn
+*                         maxvrdet till 0 eller tvrtom, i likhet med talet.
+*
+*                      2. Index fr mest signifikant siffra uppdateras,
+*                         vilket enbart kan pverkas om frsta ndrade siffran
+*                         ligger till vnster om eller p aktuell position.
+*
+*                      3. Nya binrkoder skrivs till bakre bufferten, som
+*                         drefter blir frmre buffert.
+*
+*                      - count_up: Indikerar upprkning (true) eller
+*                                  nedrkning (false).
+********************************************************************************/
+static void display_count_frame(const bool count_up)
+{
+   const uint8_t last = radix - 1;
+   uint8_t changed = DISPLAY_DIGIT_COUNT;
+
+   while (changed-- > 0)
+   {
+      if (count_up)
+      {
+         if (count_digits[changed] < last)
+         {
+            count_digits[changed]++;
+            break;
+         }
+         count_digits[changed] = 0;
+      }
+      else
+      {
+         if (count_digits[changed] > 0)
+         {
+            count_digits[changed]--;
+            break;
+         }
+         count_digits[changed] = last;
+      }
+   }
+
+   if (changed >= DISPLAY_DIGIT_COUNT) changed = 0;
+
+   if (changed <= first_digit)
+   {
+      first_digit = changed;
+
+      while (first_digit < DISPLAY_DIGIT_COUNT - 1 && !count_digits[first_digit])
+      {
+         first_digit++;
+      }
+   }
+
+   const uint8_t* front = frame[front_frame];
+   uint8_t* back = frame[!front_frame];
+
+   for (uint8_t i = 0; i < changed; ++i)
+   {
+      back[i] = front[i];
+   }
+
+   for (uint8_t i = changed; i < DISPLAY_DIGIT_COUNT; ++i)
+   {
+      back[i] = i < first_digit ? FONT_BLANK : font_get_digit(count_digits[i]);
+   }
+
+   front_frame = !front_frame;
+   return;
+}
+
+/********************************************************************************
+* display_shown_number: Returnerar talet som ska visas p 7-segmentsdisplayerna,
+*                       det vill sga felskningsvrdet (begrnsat till
+*                       maxvrdet) i felskningslget, annars aktuellt tal.
+*                       Mste anropas med avbrott inaktiverade.
+********************************************************************************/
+static inline display_number_t display_shown_number(void)
+{
+   if (!debug_enabled) return number;
+   return debug_value < max_val ? debug_value : max_val;
 }
 
 static inline void read_eeprom(void)
 {
-	display_set_number(eeprom_read_byte(EEPROM_NUMBER));
-	count_direction = (enum display_count_direction)eeprom_read_byte(EEPROM_COUNT_DIRECTION);
+	uint32_t stored_number;
+	eeprom_ring_init(&number_ring, EEPROM_NUMBER_RING, EEPROM_NUMBER_RING_SLOTS);
+
+	if (eeprom_ring_read(&number_ring, &stored_number) == 0 && stored_number <= max_val)
+	{
+		display_set_number((display_number_t)stored_number);
+	}
+
+	config_load();
+	const struct config* config = config_get();
+	count_direction = config->count_direction ? DISPLAY_COUNT_DIRECTION_UP : DISPLAY_COUNT_DIRECTION_DOWN;
 	
-	if (eeprom_read_byte(EEPROM_OUTPUT_ENABLED) == 1)
+	if (config->output_enabled)
 	{
 		display_enable_output();
 	}
-	if (eeprom_read_byte(EEPROM_COUNT_ENABLED) == 1)
+	if (config->count_enabled)
 	{
 		display_enable_count();
 	}
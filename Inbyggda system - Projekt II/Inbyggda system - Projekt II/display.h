@@ -1,27 +1,43 @@
 /********************************************************************************
-* display.h: Innehller drivrutiner fr tv 7-segmentsdisplayer anslutna till
-*            till PORTD0 - PORTD6 (pin 0 - 6), som kan visa tv siffror i binr,
-*            decimal eller hexadecimal form. Matningsspnningen fr respektive
-*            7-segmentsdisplay genereras frn PORTD7 (pin 7) respektive
-*            PORTC3 (pin A3), dr lg signal medfr tnd display, d displayerna
-*            har gemensam katod.
+* display.h: Innehller drivrutiner fr DISPLAY_DIGIT_COUNT stycken
+*            7-segmentsdisplayer anslutna till PORTD0 - PORTD6 (pin 0 - 6),
+*            som kan visa tal med godtycklig talbas 2 - 16, exempelvis i
+*            binr, oktal, decimal eller hexadecimal form.
+*            Matningsspnningen fr respektive 7-segmentsdisplay genereras
+*            frn pinnarna i tabellen DISPLAY_CATHODE_PINS, dr lg signal
+*            medfr tnd display, d displayerna har gemensam katod. Som
+*            default anvnds tv displayer med katoderna p PORTD7 (pin 7)
+*            respektive PORTC3 (pin A3).
 *
-*            Nr displayerna r p skiftas aktiverad display en gng per
-*            millisekund via timerkrets Timer 1. Vid anvndning av
-*            7-segmentsdisplayer, anropa funktionen display_toggle_digit
-*            i avbrottsrutinen fr Timer 1 i CTC Mode ssom visas nedan:
+*            Antalet displayer samt katodernas pinnar stlls in vid
+*            kompilering, exempelvis fr en modul med fyra displayer:
+*
+*            #define DISPLAY_DIGIT_COUNT  4
+*            #define DISPLAY_CATHODE_PINS { 8, 9, 10, 11 }
+*
+*            Tal lagras som 16-bitars heltal fr upp till fyra displayer
+*            och som 32-bitars heltal fr fler displayer, se typen
+*            display_number_t.
+*
+*            Nr displayerna r p tnds displayerna en i taget i tur och
+*            ordning, dr aktiverad display skiftas en gng per
+*            DISPLAY_DIGIT_TIME_MS via en mjukvarutimer, som anropar funktionen
+*            display_toggle_digit. Varje skifte tar lika lng tid oavsett
+*            antalet displayer. Mjukvarutimers schemalggs p Timer 1,
+*            vilket krver att funktionen soft_timer_run anropas i
+*            avbrottsrutinen fr Timer 1 ssom visas nedan:
 *
 *            ISR (TIMER1_COMPA_vect)
 *            {
-*               display_toggle_digit();
+*               soft_timer_run();
 *               return;
 *            }
 *
 *            Upp- eller nedrkning med godtycklig hastighet kan aktiveras via
-*            anrop av funktionen display_set_count, dr timerkrets Timer 2
-*            anvnds fr att generera upprkningshastigheten. Som exempel,
-*            nedanstende funktionsanrop medfr upprkning av
-*            7-segmentsdisplayerna var 100:e ms:
+*            anrop av funktionen display_set_count, dr ytterligare en
+*            mjukvarutimer anropar funktionen display_count med angiven
+*            upprkningshastighet. Som exempel, nedanstende funktionsanrop
+*            medfr upprkning av 7-segmentsdisplayerna var 100:e ms:
 *
 *            display_set_count(DISPLAY_COUNT_DIRECTION_UP, 100);
 *            display_enable_count();
@@ -31,16 +47,6 @@
 *            display_set_count. Som default anvnds upprkning med 
 *            en hastighet p 1000 ms som default.
 *
-*            Vid upp- eller nedrkning av talet p 7-segmentsdisplayerna,
-*            anropa funktionen display_count i avbrottsrutinen fr Timer 2
-*            i Normal Mode ssom visas nedan:
-*
-*            ISR (TIMER2_OVF_vect)
-*            {
-*               display_count();
-*               return;
-*            }
-*
 ********************************************************************************/
 #ifndef DISPLAY_H_
 #define DISPLAY_H_
@@ -49,8 +55,48 @@
 * Inkluderingsdirektiv:
 ********************************************************************************/
 #include "misc.h"
-#include "timer.h"
+#include "soft_timer.h"
 #include "eeprom.h"
+#include "eeprom_ring.h"
+#include "config.h"
+#include "font.h"
+#include "digits.h"
+
+/********************************************************************************
+* Makrodefinitioner (kan ersttas vid kompilering):
+*
+*   - DISPLAY_DIGIT_COUNT  : Antalet 7-segmentsdisplayer (1 - 8).
+*   - DISPLAY_CATHODE_PINS : Katodernas pin-nummer p Arduino Uno, med den
+*                            vnstra displayen (mest signifikant siffra)
+*                            frst. PORTD0 - PORTD6 r upptagna av segmenten.
+*   - DISPLAY_DIGIT_TIME_MS: Tid som varje display r tnd mtt i ms.
+********************************************************************************/
+#ifndef DISPLAY_DIGIT_COUNT
+#define DISPLAY_DIGIT_COUNT 2
+#endif
+
+#ifndef DISPLAY_CATHODE_PINS
+#define DISPLAY_CATHODE_PINS { D7, A3 }
+#endif
+
+#ifndef DISPLAY_DIGIT_TIME_MS
+#define DISPLAY_DIGIT_TIME_MS 1
+#endif
+
+#if DISPLAY_DIGIT_COUNT < 1 || DISPLAY_DIGIT_COUNT > 8
+#error "DISPLAY_DIGIT_COUNT mste vara mellan 1 och 8!"
+#endif
+
+/********************************************************************************
+* display_number_t: Heltalstyp fr tal som skrivs ut p 7-segmentsdisplayerna.
+*                   16 bitar rcker fr fyra hexadecimala siffror, medan fler
+*                   displayer krver 32 bitar.
+********************************************************************************/
+#if DISPLAY_DIGIT_COUNT <= 4
+typedef uint16_t display_number_t;
+#else
+typedef uint32_t display_number_t;
+#endif
 
 /********************************************************************************
 * display_count_direction: Enumeration fr val av upprkningsriktning p
@@ -103,18 +149,19 @@ void display_toggle_output(void);
 /********************************************************************************
 * display_set_number: Stter nytt heltal fr utskrift p 7-segmentsdisplayer.
 *                     Om angivet heltal verstiger maxvrdet som kan skrivas ut
-*                     p tv 7-segmentsdisplayer med aktuell talbas returneras
+*                     p samtliga 7-segmentsdisplayer med aktuell talbas returneras
 *                     felkod 1. Annars returneras heltalet 0 efter att heltalet
 *                     p 7-segmentsdisplayerna har uppdaterats.
 *
 *                     - new_number: Nytt tal som ska skrivas ut p displayerna.
 ********************************************************************************/
-int display_set_number(const uint8_t new_number);
+int display_set_number(const display_number_t new_number);
 
 /********************************************************************************
-* display_set_radix: Stter ny talbas till 2, 10 eller 16 utskrift av tal p
-*                    7-segmentsdisplayer. Drmed kan tal skrivas ut binrt
-*                    (00 - 11), decimalt (00 - 99) eller hexadecimalt (00 - FF).
+* display_set_radix: Stter ny talbas 2 - 16 fr utskrift av tal p
+*                    7-segmentsdisplayer. Drmed kan tal exempelvis skrivas ut
+*                    binrt, oktalt, decimalt eller hexadecimalt, exempelvis
+*                    00 - 11, 00 - 77, 00 - 99 eller 00 - FF p tv displayer.
 *                    Vid felaktigt angiven talbas returneras felkod 1. Annars
 *                    returneras heltalet 0 efter att anvnd talbas har
 *                    uppdaterats.
@@ -124,18 +171,24 @@ int display_set_number(const uint8_t new_number);
 int display_set_radix(const uint8_t new_radix);
 
 /********************************************************************************
-* display_toggle_digit: Skiftar aktiverad 7-segmentsdisplay fr utskrift av
-*                       tiotal och ental, vilket r ndvndigt, d displayerna
-*                       delar p samma pinnar. Enbart en vrdesiffra skrivs
-*                       ut om mjligt, exempelvis 9 i stllet fr 09. Denna 
-*                       funktion br anropas en gng per millisekund fr att 
-*                       ett givet tvsiffrigt tal ska upplevas skrivas ut 
-*                       kontinuerligt.
+* display_toggle_digit: Skiftar aktiverad 7-segmentsdisplay till nsta display
+*                       i tur, vilket r ndvndigt, d displayerna delar p
+*                       samma pinnar. Binrkoderna r frberknade vid varje
+*                       nytt tal, s att enbart en byte skrivs ut innan
+*                       katoden skiftas, oavsett antalet displayer. Inledande
+*                       nollor slcks, exempelvis visas 9 i stllet fr 09.
+*                       Denna funktion anropas en gng per
+*                       DISPLAY_DIGIT_TIME_MS av displayernas mjukvarutimer
+*                       nr displayerna r p.
 ********************************************************************************/
 void display_toggle_digit(void);
 
 /********************************************************************************
-* display_count: Rknar upp eller ned tal p 7-segmentsdisplayer.
+* display_count: Rknar upp eller ned tal p 7-segmentsdisplayer. Denna
+*                funktion anropas av upprkningens mjukvarutimer med aktuell
+*                upprkningshastighet nr upprkning r aktiverad. Siffrorna
+*                rknas siffra fr siffra med minnessiffra, s att enbart de
+*                siffror som ndras uppdateras och ingen division krvs.
 ********************************************************************************/
 void display_count(void);
 
@@ -183,4 +236,72 @@ void display_disable_count(void);
 ********************************************************************************/
 void display_toggle_count(void);
 
+/********************************************************************************
+* display_get_number: Returnerar talet som skrivs ut p 7-segmentsdisplayerna.
+********************************************************************************/
+display_number_t display_get_number(void);
+
+/********************************************************************************
+* display_get_radix: Returnerar talbasen som anvnds vid utskrift av tal p
+*                    7-segmentsdisplayerna.
+********************************************************************************/
+uint8_t display_get_radix(void);
+
+/********************************************************************************
+* display_get_count_direction: Returnerar aktuell upprkningsriktning fr tal
+*                              som skrivs ut p 7-segmentsdisplayerna.
+********************************************************************************/
+enum display_count_direction display_get_count_direction(void);
+
+/********************************************************************************
+* display_debug_enabled: Indikerar ifall felskningslget r aktiverat, det vill
+*                        sga ifall 7-segmentsdisplayerna visar felsknings-
+*                        vrdet i stllet fr aktuellt tal. Vid aktiverat
+*                        felskningslge returneras true, annars false.
+********************************************************************************/
+bool display_debug_enabled(void);
+
+/********************************************************************************
+* display_enable_debug: Aktiverar felskningslget, dr 7-segmentsdisplayerna
+*                       visar felskningsvrdet (exempelvis processorlasten,
+*                       se cpu_load.h) i stllet fr aktuellt tal. Talet
+*                       pverkas inte och rknas upp som vanligt i bakgrunden.
+*                       Lget lagras inte i EEPROM-minnet.
+********************************************************************************/
+void display_enable_debug(void);
+
+/********************************************************************************
+* display_disable_debug: Inaktiverar felskningslget, s att 7-segments-
+*                        displayerna ter visar aktuellt tal.
+********************************************************************************/
+void display_disable_debug(void);
+
+/********************************************************************************
+* display_set_debug_value: Stter nytt felskningsvrde, som visas p
+*                          7-segmentsdisplayerna i felskningslget. Vrden
+*                          som verstiger maxvrdet fr aktuell talbas visas
+*                          som maxvrdet.
+*
+*                          - value: Nytt felskningsvrde.
+********************************************************************************/
+void display_set_debug_value(const display_number_t value);
+
+/********************************************************************************
+* display_power_fail: Frbereder 7-segmentsdisplayerna fr strmavbrott genom
+*                     att stoppa multiplexning samt upprkning, slcka
+*                     displayerna och lgga aktuellt tal i k fr lagring i
+*                     EEPROM-minnet. Talet lagras enbart hr, inte vid varje
+*                     frndring. Funktionen ska anropas av callback-rutinen
+*                     fr strmavbrott, se power.h.
+********************************************************************************/
+void display_power_fail(void);
+
+/********************************************************************************
+* display_power_restore: terupptar multiplexning samt upprkning enligt
+*                        instllningarna efter att matningsspnningen har
+*                        terhmtat sig. Funktionen ska anropas av callback-
+*                        rutinen fr terhmtning, se power.h.
+********************************************************************************/
+void display_power_restore(void);
+
 #endif /* DISPLAY_H_ */
\ No newline at end of file
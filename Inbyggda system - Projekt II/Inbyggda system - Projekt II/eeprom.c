@@ -5,26 +5,102 @@
 #include "eeprom.h"
 
 /********************************************************************************
-* eeprom_write_byte: Skriver en byte bestende av ett osignerat heltal till
-*                    angiven adress i EEPROM-minnet. Vid lyckad skrivning
-*                    returneras 0, annars returneras felkod 1.
+* eeprom_write: Strukt fr en vntande skrivning till EEPROM-minnet.
+********************************************************************************/
+struct eeprom_write
+{
+   uint16_t address; /* Adressen som ska skrivas till. */
+   uint8_t data;     /* Datan som ska skrivas. */
+};
+
+/********************************************************************************
+* Statiska variabler:
+*
+*   - queue        : Ringbuffert med vntande skrivningar.
+*   - queue_head   : Index fr nsta skrivning som ska genomfras.
+*   - queue_count  : Antal vntande skrivningar.
+*   - dropped      : Antal skrivningar som har kastats p grund av full k.
+*
+*   - shadow       : Spegling av adresserna EEPROM_SHADOW_START och framt,
+*                    inklusive vntande skrivningar, som laddas via
+*                    eeprom_init.
+********************************************************************************/
+static struct eeprom_write queue[EEPROM_QUEUE_SIZE];
+static uint8_t queue_head = 0;
+static volatile uint8_t queue_count = 0;
+static volatile uint32_t dropped = 0;
+
+static uint8_t shadow[EEPROM_SHADOW_SIZE];
+
+/********************************************************************************
+* Statiska funktioner:
+********************************************************************************/
+static struct eeprom_write* eeprom_queue_find(const uint16_t address);
+static inline bool eeprom_block_valid(const uint16_t address,
+                                      const uint16_t size);
+static uint8_t eeprom_wait_ready(void);
+static void eeprom_read_chunk(const uint16_t address,
+                              uint8_t* data,
+                              const uint8_t size);
+static inline bool eeprom_shadowed(const uint16_t address);
+static uint8_t eeprom_read_hardware(const uint16_t address);
+static void eeprom_start_write(const uint16_t address,
+                               const uint8_t old_data,
+                               const uint8_t data);
+
+/********************************************************************************
+* eeprom_init: Laddar speglingen av adresserna EEPROM_SHADOW_START och framt
+*              frn EEPROM-minnet. Eventuell pgende skrivning, exempelvis
+*              en skrivning som pbrjades innan systemterstllning,
+*              avvaktas frst.
+********************************************************************************/
+void eeprom_init(void)
+{
+   const uint8_t sreg = eeprom_wait_ready();
+
+   for (uint8_t i = 0; i < EEPROM_SHADOW_SIZE; ++i)
+   {
+      shadow[i] = eeprom_read_hardware(EEPROM_SHADOW_START + i);
+   }
+
+   atomic_end(sreg);
+   return;
+}
+
+/********************************************************************************
+* eeprom_write_byte: Lgger en byte bestende av ett osignerat heltal i k fr
+*                    skrivning till angiven adress i EEPROM-minnet. Vid lyckad
+*                    klggning returneras 0, annars returneras felkod 1.
 *
 *                    1. Om angiven adress verstiger hgsta adressen i EEPROM-
 *                       minnet sker ingen skrivning och felkod 1 returneras.
 *
-*                    2. Eventuell fregende skrivning avslutas innan den
-*                       nya skrivningen pbrjas.
+*                    2. Avbrott inaktiveras temporrt, d kn ven hanteras
+*                       av avbrottsrutinen fr EEPROM-minnet.
+*
+*                    3. Om adressen speglas i RAM och redan innehller
+*                       angiven data sker ingen skrivning.
+*
+*                    4. Om kn r full och ingen skrivning till samma adress
+*                       ligger i k kastas skrivningen ifall avbrott var
+*                       inaktiverade vid anrop, exempelvis i en avbrotts-
+*                       rutin, varvid antalet kastade skrivningar rknas upp
+*                       och felkod 1 returneras. Drmed blockeras aldrig
+*                       vriga avbrott i upp till 3.4 ms per skrivning.
+*                       Annars terstlls avbrott under vntan p att en
+*                       plats frigrs, dr nsta skrivning pbrjas direkt
+*                       ifall ingen skrivning pgr.
 *
-*                    3. Angiven adress samt datan som ska skrivas specificeras.
+*                    5. Speglingen uppdateras. Om en skrivning till samma
+*                       adress redan ligger i k erstts dess data, s att
+*                       enbart en skrivning sker. Annars lggs skrivningen
+*                       sist i kn.
 *
-*                    4. Avbrott inaktiveras temporrt fr att inte avbryta
-*                       eventuell skrivning (EEPROM-skrivningen mste ske
-*                       inom fyra klockcykler fr att lyckas).
+*                    6. Avbrott fr EEPROM-minnet aktiveras, s att kn tms
+*                       i bakgrunden.
 *
-*                    5. Skrivningen genomfrs.
+*                    7. Avbrott terstlls till tidigare lge.
 *
-*                    6. Avbrott teraktiveras.
-*                       
 *                    - address: Adressen i EEPROM-minnet som angiven data
 *                               ska lagras p.
 *                    - data   : Datan som ska skrivas.
@@ -33,14 +109,52 @@ int eeprom_write_byte(const uint16_t address,
                       const uint8_t data)
 {
    if (address > EEPROM_ADDRESS_MAX) return 1;
-   while (EECR & (1 << EEPE));
-   EEAR = address;
-   EEDR = data;
+   const uint8_t sreg = SREG;
+   struct eeprom_write* pending = 0;
 
-   asm("CLI");
-   EECR |= (1 << EEMPE);
-   EECR |= (1 << EEPE);
-   asm("SEI");
+   while (1)
+   {
+      atomic_disable();
+
+      if (eeprom_shadowed(address) && shadow[address - EEPROM_SHADOW_START] == data)
+      {
+         atomic_end(sreg);
+         return 0;
+      }
+
+      pending = eeprom_queue_find(address);
+      if (pending || queue_count < EEPROM_QUEUE_SIZE) break;
+
+      if (!(sreg & (1 << SREG_I)))
+      {
+         dropped++;
+         atomic_end(sreg);
+         return 1;
+      }
+
+      if (!(EECR & (1 << EEPE))) eeprom_write_next();
+      atomic_end(sreg);
+   }
+
+   if (eeprom_shadowed(address))
+   {
+      shadow[address - EEPROM_SHADOW_START] = data;
+   }
+
+   if (pending)
+   {
+      pending->data = data;
+   }
+   else
+   {
+      struct eeprom_write* next = &queue[(queue_head + queue_count) % EEPROM_QUEUE_SIZE];
+      next->address = address;
+      next->data = data;
+      queue_count++;
+   }
+
+   EECR |= (1 << EERIE);
+   atomic_end(sreg);
    return 0;
 }
 
@@ -49,16 +163,9 @@ int eeprom_write_byte(const uint16_t address,
 *                    angiven samt efterfljande adress i EEPROM-minnet. Vid
 *                    lyckad skrivning returneras 0, annars returneras felkod 1.
 *
-*                    1. Om angiven adress verstiger nst hgsta adressen i
-*                       EEPROM-minnet sker ingen skrivning och felkod 1 
-*                       returneras.
-*
-*                    2. Det 16-bitars talet lagras som tv separata byte.
-*
-*                    3. Respektive byte skrivs till EEPROM-minnet p 
-*                       konsekutiva adresser.
-*
-*                    4. Returkod 0 returneras fr att indikera lyckas skrivning.
+*                    Det 16-bitars talet lagras som tv separata byte, med
+*                    minst signifikant byte p den lgre adressen, och
+*                    skrivs som ett block.
 *
 *                    - address_low: Den lgre adressen i EEPROM-minnet som
 *                                   angiven data ska lagras p.
@@ -67,9 +174,40 @@ int eeprom_write_byte(const uint16_t address,
 int eeprom_write_word(const uint16_t address_low,
                       const uint16_t data)
 {
-   if (address_low > EEPROM_ADDRESS_MAX - 1) return 1;
-   eeprom_write_byte(address_low, (uint8_t)(data));
-   eeprom_write_byte(address_low + 1, (uint8_t)(data >> 8));
+   const uint8_t bytes[2] = { (uint8_t)(data), (uint8_t)(data >> 8) };
+   return eeprom_write_block(address_low, bytes, sizeof(bytes));
+}
+
+/********************************************************************************
+* eeprom_write_block: Lgger angivet antal byte i k fr skrivning till angiven
+*                     adress och framt i EEPROM-minnet. Vid lyckad klggning
+*                     returneras 0. Om blocket inte ryms i EEPROM-minnet sker
+*                     ingen skrivning och felkod 1 returneras.
+*
+*                     Varje byte lggs i k via eeprom_write_byte, vilket
+*                     innebr att ofrndrade byte hoppas ver. Om blocket
+*                     r strre n ledigt utrymme i kn vntar funktionen
+*                     tills tillrckligt mnga skrivningar har genomfrts,
+*                     frutsatt att avbrott r aktiverade. Annars avbryts
+*                     klggningen vid frsta kastade byte, varvid felkod 1
+*                     returneras och efterfljande byte inte lggs i k.
+*
+*                     - address: Frsta adressen som blocket ska lagras p.
+*                     - data   : Pekare till datan som ska skrivas.
+*                     - size   : Antal byte som ska skrivas.
+********************************************************************************/
+int eeprom_write_block(const uint16_t address,
+                       const void* data,
+                       const uint16_t size)
+{
+   if (!eeprom_block_valid(address, size)) return 1;
+   const uint8_t* bytes = (const uint8_t*)data;
+
+   for (uint16_t i = 0; i < size; ++i)
+   {
+      if (eeprom_write_byte(address + i, bytes[i])) return 1;
+   }
+
    return 0;
 }
 
@@ -81,12 +219,16 @@ int eeprom_write_word(const uint16_t address_low,
 *                   1. Om angiven adress verstiger hgsta adressen i EEPROM-
 *                      minnet sker ingen lsning och 0 returneras.
 *
-*                   2. Eventuell fregende skrivning avslutas innan lsningen
-*                      pbrjas.
+*                   2. Om adressen speglas i RAM returneras speglat innehll.
 *
-*                   3. Angiven adress som lsning ska ske frn specificeras.
+*                   3. Om en skrivning till angiven adress ligger i k
+*                      returneras dess data, d denna nnu inte har skrivits.
 *
-*                   4. Lsningen genomfrs frn angiven adress.
+*                   4. Annars avvaktas eventuell pgende skrivning, dr
+*                      avbrott r aktiverade under vntan. Drefter
+*                      genomfrs lsningen med avbrott inaktiverade, s att
+*                      avbrottsrutinen inte hinner pbrja en ny skrivning
+*                      emellan.
 *
 *                   5. Innehllet returneras som ett 8-bitars osignerat heltal.
 *
@@ -95,10 +237,37 @@ int eeprom_write_word(const uint16_t address_low,
 uint8_t eeprom_read_byte(const uint16_t address)
 {
    if (address > EEPROM_ADDRESS_MAX) return 0;
-   while (EECR & (1 << EEPE));
-   EEAR = address;
-   EECR |= (1 << EERE);
-   return EEDR;
+   const uint8_t sreg = SREG;
+
+   while (1)
+   {
+      atomic_disable();
+
+      if (eeprom_shadowed(address))
+      {
+         const uint8_t data = shadow[address - EEPROM_SHADOW_START];
+         atomic_end(sreg);
+         return data;
+      }
+
+      const struct eeprom_write* pending = eeprom_queue_find(address);
+
+      if (pending)
+      {
+         const uint8_t data = pending->data;
+         atomic_end(sreg);
+         return data;
+      }
+
+      if (!(EECR & (1 << EEPE)))
+      {
+         const uint8_t data = eeprom_read_hardware(address);
+         atomic_end(sreg);
+         return data;
+      }
+
+      atomic_end(sreg);
+   }
 }
 
 /********************************************************************************
@@ -106,19 +275,336 @@ uint8_t eeprom_read_byte(const uint16_t address)
 *                   EEPROM-minnet och returnerar detta som ett osignerat heltal.
 *                   Vid misslyckad lsning returneras 0.
 *
-*                   1. Om angiven adress verstiger hgsta adressen i EEPROM-
-*                      minnet sker ingen lsning och 0 returneras.
-*
-*                   2. Respektive byte lses frn EEPROM-minnet en i taget
-*                      och lagras som ett ord (ett 16-bitars tal).
-*
-*                   3. Avlst 16-bitars tal returneras.
+*                   Bda byte lses som ett block, dr minst signifikant
+*                   byte ligger p den lgre adressen.
 *
 *                   - address_low: Den lgre adressen i EEPROM-minnet som
 *                                  ska lsas av.
 ********************************************************************************/
 uint16_t eeprom_read_word(const uint16_t address_low)
 {
-   if (address_low >= EEPROM_ADDRESS_MAX - 1) return 0;
-   return eeprom_read_word(address_low) | (eeprom_read_word(address_low + 1) << 8);
+   uint8_t bytes[2];
+   if (eeprom_read_block(address_low, bytes, sizeof(bytes))) return 0;
+   return bytes[0] | ((uint16_t)bytes[1] << 8);
+}
+
+/********************************************************************************
+* eeprom_read_block: Lser angivet antal byte frn angiven adress och framt i
+*                    EEPROM-minnet. Vid lyckad lsning returneras 0. Om blocket
+*                    inte ryms i EEPROM-minnet sker ingen lsning och felkod 1
+*                    returneras.
+*
+*                    Blocket lses i delar om hgst EEPROM_BLOCK_CHUNK byte.
+*                    Fr varje del avvaktas eventuell pgende skrivning en
+*                    gng, varefter hela delen lses med avbrott inaktiverade.
+*                    Drmed begrnsas tiden som avbrott r inaktiverade, medan
+*                    kontrollen av pgende skrivning samt vntande data
+*                    enbart sker en gng per del i stllet fr en gng per
+*                    byte.
+*
+*                    - address: Frsta adressen som ska lsas av.
+*                    - data   : Pekare till minnet som datan ska lagras i.
+*                    - size   : Antal byte som ska lsas.
+********************************************************************************/
+int eeprom_read_block(const uint16_t address,
+                      void* data,
+                      const uint16_t size)
+{
+   if (!eeprom_block_valid(address, size)) return 1;
+   uint8_t* bytes = (uint8_t*)data;
+
+   for (uint16_t offset = 0; offset < size; offset += EEPROM_BLOCK_CHUNK)
+   {
+      const uint16_t remaining = size - offset;
+      const uint8_t chunk = remaining < EEPROM_BLOCK_CHUNK ? remaining : EEPROM_BLOCK_CHUNK;
+      const uint8_t sreg = eeprom_wait_ready();
+      eeprom_read_chunk(address + offset, bytes + offset, chunk);
+      atomic_end(sreg);
+   }
+
+   return 0;
+}
+
+/********************************************************************************
+* eeprom_cursor_begin: Pbrjar sekventiell lsning frn angiven adress.
+*                      Eventuell pgende skrivning avvaktas, varefter
+*                      avbrott inaktiveras under frsta delen av lsningen.
+*
+*                      - self   : Pekare till strukten fr lsningen.
+*                      - address: Frsta adressen som ska lsas av.
+********************************************************************************/
+void eeprom_cursor_begin(struct eeprom_cursor* self,
+                         const uint16_t address)
+{
+   self->sreg = eeprom_wait_ready();
+   self->address = address;
+   self->remaining = EEPROM_BLOCK_CHUNK;
+   return;
+}
+
+/********************************************************************************
+* eeprom_cursor_read: Lser nsta byte och stegar fram till efterfljande
+*                     adress. Efter hgsta adressen i EEPROM-minnet
+*                     returneras 0.
+*
+*                     Nr aktuell del har lsts terstlls avbrott, s att
+*                     vntande avbrott hinner exekveras, varefter eventuell
+*                     pgende skrivning avvaktas innan nsta del pbrjas.
+*                     D ingen skrivning kan pg under en del behver
+*                     enbart kn kontrolleras, vilket dessutom bara sker
+*                     om kn innehller vntande skrivningar.
+*
+*                     - self: Pekare till strukten fr lsningen.
+********************************************************************************/
+uint8_t eeprom_cursor_read(struct eeprom_cursor* self)
+{
+   if (self->address > EEPROM_ADDRESS_MAX) return 0;
+   const uint16_t address = self->address++;
+
+   if (!self->remaining)
+   {
+      atomic_end(self->sreg);
+      self->sreg = eeprom_wait_ready();
+      self->remaining = EEPROM_BLOCK_CHUNK;
+   }
+
+   self->remaining--;
+
+   if (queue_count)
+   {
+      const struct eeprom_write* pending = eeprom_queue_find(address);
+      if (pending) return pending->data;
+   }
+
+   return eeprom_read_hardware(address);
+}
+
+/********************************************************************************
+* eeprom_cursor_end: Avslutar sekventiell lsning, varvid avbrott terstlls
+*                    till tillstndet innan eeprom_cursor_begin anropades.
+*
+*                    - self: Pekare till strukten fr lsningen.
+********************************************************************************/
+void eeprom_cursor_end(struct eeprom_cursor* self)
+{
+   atomic_end(self->sreg);
+   return;
+}
+
+/********************************************************************************
+* eeprom_write_next: Pbrjar skrivning av nsta byte i kn. Skrivningar vars
+*                    data redan finns lagrad hoppas ver. Om kn r tom
+*                    inaktiveras avbrott fr EEPROM-minnet. Denna funktion ska
+*                    anropas i avbrottsrutinen fr EEPROM-minnet (EE_READY_vect)
+*                    och fr enbart anropas nr ingen skrivning pgr.
+********************************************************************************/
+void eeprom_write_next(void)
+{
+   while (queue_count)
+   {
+      const struct eeprom_write* next = &queue[queue_head];
+      queue_head = (queue_head + 1) % EEPROM_QUEUE_SIZE;
+      queue_count--;
+
+      const uint8_t old_data = eeprom_read_hardware(next->address);
+
+      if (old_data != next->data)
+      {
+         eeprom_start_write(next->address, old_data, next->data);
+         return;
+      }
+   }
+
+   EECR &= ~(1 << EERIE);
+   return;
+}
+
+/********************************************************************************
+* eeprom_flush: Vntar tills samtliga vntande skrivningar har genomfrts.
+*               Skrivningarna pbrjas av funktionen sjlv nr ingen skrivning
+*               pgr, vilket gr att funktionen fungerar oavsett om avbrott
+*               r aktiverade eller inte.
+********************************************************************************/
+void eeprom_flush(void)
+{
+   const uint8_t sreg = SREG;
+
+   while (1)
+   {
+      atomic_disable();
+
+      if (!(EECR & (1 << EEPE)))
+      {
+         if (!queue_count)
+         {
+            atomic_end(sreg);
+            return;
+         }
+         eeprom_write_next();
+      }
+
+      atomic_end(sreg);
+   }
+}
+
+/********************************************************************************
+* eeprom_pending: Returnerar antalet skrivningar som ligger i k.
+********************************************************************************/
+uint8_t eeprom_pending(void)
+{
+   return queue_count;
+}
+
+/********************************************************************************
+* eeprom_dropped: Returnerar antalet skrivningar som har kastats p grund av
+*                 full k sedan start.
+********************************************************************************/
+uint32_t eeprom_dropped(void)
+{
+   return atomic_read_u32(&dropped);
+}
+
+/********************************************************************************
+* eeprom_queue_find: Returnerar pekare till vntande skrivning till angiven
+*                    adress. Om ingen sdan skrivning finns returneras en
+*                    nollpekare. Mste anropas med avbrott inaktiverade.
+*
+*                    - address: Adressen som ska letas efter.
+********************************************************************************/
+static struct eeprom_write* eeprom_queue_find(const uint16_t address)
+{
+   for (uint8_t i = 0; i < queue_count; ++i)
+   {
+      struct eeprom_write* pending = &queue[(queue_head + i) % EEPROM_QUEUE_SIZE];
+      if (pending->address == address) return pending;
+   }
+   return 0;
+}
+
+/********************************************************************************
+* eeprom_block_valid: Indikerar ifall ett block med angiven storlek frn
+*                     angiven adress ryms i EEPROM-minnet.
+*
+*                     - address: Blockets frsta adress.
+*                     - size   : Blockets storlek mtt i byte.
+********************************************************************************/
+static inline bool eeprom_block_valid(const uint16_t address,
+                                      const uint16_t size)
+{
+   return (uint32_t)address + size <= EEPROM_ADDRESS_MAX + 1UL;
+}
+
+/********************************************************************************
+* eeprom_wait_ready: Avvaktar eventuell pgende skrivning och returnerar
+*                    statusregistret innan anropet. Avbrott r aktiverade
+*                    under vntan (om de var det vid anrop), medan avbrott
+*                    r inaktiverade nr funktionen returnerar, s att
+*                    avbrottsrutinen inte hinner pbrja en ny skrivning.
+********************************************************************************/
+static uint8_t eeprom_wait_ready(void)
+{
+   const uint8_t sreg = SREG;
+
+   while (1)
+   {
+      atomic_disable();
+      if (!(EECR & (1 << EEPE))) return sreg;
+      atomic_end(sreg);
+   }
+}
+
+/********************************************************************************
+* eeprom_read_chunk: Lser angivet antal byte direkt frn EEPROM-minnet,
+*                    varefter data frn vntande skrivningar inom omrdet
+*                    skrivs ver avlst data. Mste anropas med avbrott
+*                    inaktiverade nr ingen skrivning pgr.
+*
+*                    - address: Frsta adressen som ska lsas av.
+*                    - data   : Pekare till minnet som datan ska lagras i.
+*                    - size   : Antal byte som ska lsas.
+********************************************************************************/
+static void eeprom_read_chunk(const uint16_t address,
+                              uint8_t* data,
+                              const uint8_t size)
+{
+   for (uint8_t i = 0; i < size; ++i)
+   {
+      data[i] = eeprom_read_hardware(address + i);
+   }
+
+   for (uint8_t i = 0; i < queue_count; ++i)
+   {
+      const struct eeprom_write* pending = &queue[(queue_head + i) % EEPROM_QUEUE_SIZE];
+      const uint16_t offset = pending->address - address;
+      if (offset < size) data[offset] = pending->data;
+   }
+
+   return;
+}
+
+/********************************************************************************
+* eeprom_shadowed: Indikerar ifall angiven adress speglas i RAM.
+*
+*                  - address: Adressen som ska kontrolleras.
+********************************************************************************/
+static inline bool eeprom_shadowed(const uint16_t address)
+{
+   return address >= EEPROM_SHADOW_START && address < EEPROM_SHADOW_START + EEPROM_SHADOW_SIZE;
+}
+
+/********************************************************************************
+* eeprom_read_hardware: Lser en byte direkt frn EEPROM-minnet. Mste anropas
+*                       med avbrott inaktiverade nr ingen skrivning pgr.
+*
+*                       - address: Adressen som ska lsas av.
+********************************************************************************/
+static uint8_t eeprom_read_hardware(const uint16_t address)
+{
+   EEAR = address;
+   EECR |= (1 << EERE);
+   return EEDR;
+}
+
+/********************************************************************************
+* eeprom_start_write: Pbrjar skrivning av angiven data till angiven adress
+*                     med snabbaste mjliga programmeringslge utifrn
+*                     nuvarande innehll. En raderad bit r 1, medan enbart
+*                     skrivning kan nollstlla bitar.
+*
+*                     1. Om ny data r 0xFF rcker enbart radering (1.8 ms).
+*
+*                     2. Om ny data enbart krver att bitar nollstlls rcker
+*                        enbart skrivning (1.8 ms).
+*
+*                     3. Annars krvs radering fljt av skrivning (3.4 ms).
+*
+*                     Mste anropas med avbrott inaktiverade nr ingen
+*                     skrivning pgr, d EEPE mste sttas inom fyra
+*                     klockcykler efter EEMPE fr att skrivningen ska lyckas.
+*
+*                     - address : Adressen som ska skrivas till.
+*                     - old_data: Nuvarande innehll p adressen.
+*                     - data    : Datan som ska skrivas.
+********************************************************************************/
+static void eeprom_start_write(const uint16_t address,
+                               const uint8_t old_data,
+                               const uint8_t data)
+{
+   uint8_t mode = 0;
+
+   if (data == 0xFF)
+   {
+      mode = (1 << EEPM0);
+   }
+   else if ((old_data & data) == data)
+   {
+      mode = (1 << EEPM1);
+   }
+
+   EEAR = address;
+   EEDR = data;
+   EECR = (EECR & ~((1 << EEPM1) | (1 << EEPM0))) | mode;
+   EECR |= (1 << EEMPE);
+   EECR |= (1 << EEPE);
+   return;
 }
\ No newline at end of file
@@ -1,6 +1,62 @@
 /********************************************************************************
 * eeprom.h: Innehller drivrutiner fr skrivning samt lsning till och frn
 *           EEPROM-minnet.
+*
+*           Skrivningar sker asynkront via en k, s att anrop av funktionen
+*           eeprom_write_byte returnerar direkt i stllet fr att vnta upp
+*           till 3.4 ms per byte p att fregende skrivning ska slutfras.
+*           Kn tms en byte i taget av avbrottsrutinen fr EEPROM-minnet,
+*           vilken mste anropa funktionen eeprom_write_next ssom visas nedan:
+*
+*           ISR (EE_READY_vect)
+*           {
+*              eeprom_write_next();
+*              return;
+*           }
+*
+*           Flera skrivningar till samma adress som nnu inte har genomfrts
+*           sls ihop till en skrivning, dr senast skrivna data gller.
+*           Innan en byte skrivs lses dess nuvarande innehll, varvid
+*           skrivningen hoppas ver om innehllet redan stmmer. Annars vljs
+*           det snabbaste programmeringslget: enbart radering (fr 0xFF),
+*           enbart skrivning (om inga bitar behver ettstllas) eller
+*           radering fljt av skrivning, vilket sparar bde tid och slitage.
+*
+*           Lsning av en adress med vntande skrivning returnerar vntande
+*           data. Vid full k vntar eeprom_write_byte med avbrott aktiverade
+*           tills en plats har frigjorts. Om avbrott r inaktiverade, exempel-
+*           vis i en avbrottsrutin, kastas i stllet skrivningen och felkod 1
+*           returneras, s att vriga avbrott aldrig blockeras i vntan p
+*           EEPROM-minnet. Kn br drfr rymma samtliga skrivningar som sker
+*           frn avbrottsrutiner. Innan matningsspnningen bryts br funktionen
+*           eeprom_flush anropas, s att samtliga vntande skrivningar
+*           hinner genomfras.
+*
+*           Adresserna EEPROM_SHADOW_START och framt (EEPROM_SHADOW_SIZE
+*           byte) speglas dessutom i RAM, vilket laddas en gng vid start via
+*           funktionen eeprom_init, som ska anropas innan EEPROM-minnet
+*           anvnds och innan avbrott aktiveras, se main.c.
+*           Lsning inom detta omrde sker direkt frn RAM, medan skrivning
+*           av samma vrde som redan r lagrat inte ens lggs i k. Som
+*           default speglas systemets instllningar, se config.h.
+*
+*           Strre datamngder lses lmpligen via funktionen
+*           eeprom_read_block, som vntar in pgende skrivning en gng per
+*           block om EEPROM_BLOCK_CHUNK byte i stllet fr en gng per byte.
+*           Fr sekventiell lsning av data vars storlek inte r knd i
+*           frvg kan i stllet strukten eeprom_cursor anvndas, ssom
+*           visas nedan:
+*
+*           struct eeprom_cursor cursor;
+*           eeprom_cursor_begin(&cursor, 100);
+*           const uint8_t size = eeprom_cursor_read(&cursor);
+*
+*           for (uint8_t i = 0; i < size; ++i)
+*           {
+*              data[i] = eeprom_cursor_read(&cursor);
+*           }
+*
+*           eeprom_cursor_end(&cursor);
 ********************************************************************************/
 #ifndef EEPROM_H_
 #define EEPROM_H_
@@ -12,10 +68,53 @@
 #define EEPROM_ADDRESS_MIN 0    /* Lgsta adress i EEPROM-minnet. */
 #define EEPROM_ADDRESS_MAX 1023 /* Hgsta adress i EEPROM-minnet. */
 
+#ifndef EEPROM_QUEUE_SIZE
+#define EEPROM_QUEUE_SIZE 16 /* Maximalt antal vntande skrivningar. */
+#endif
+
+#ifndef EEPROM_BLOCK_CHUNK
+#define EEPROM_BLOCK_CHUNK 32 /* Maximalt antal byte som lses per kritisk sektion. */
+#endif
+
+#ifndef EEPROM_SHADOW_START
+#define EEPROM_SHADOW_START 500 /* Frsta adressen som speglas i RAM. */
+#endif
+
+#ifndef EEPROM_SHADOW_SIZE
+#define EEPROM_SHADOW_SIZE 12 /* Antal byte som speglas i RAM. */
+#endif
+
 /********************************************************************************
-* eeprom_write_byte: Skriver en byte bestende av ett osignerat heltal till 
-*                    angiven adress i EEPROM-minnet. Vid lyckad skrivning
-*                    returneras 0, annars returneras felkod 1.
+* eeprom_cursor: Strukt fr sekventiell lsning frn EEPROM-minnet. Lsningen
+*                sker i delar om hgst EEPROM_BLOCK_CHUNK byte, ssom via
+*                eeprom_read_block. Under varje del r avbrott inaktiverade,
+*                s att ingen skrivning kan pbrjas, och varje lsning
+*                behver drmed inte vnta in pgende skrivning. Mellan
+*                delarna terstlls avbrott, s att tiden som avbrott r
+*                inaktiverade begrnsas oavsett antalet lsta byte. Efter
+*                sista lsningen ska eeprom_cursor_end anropas.
+********************************************************************************/
+struct eeprom_cursor
+{
+   uint16_t address;  /* Adressen som lses hrnst. */
+   uint8_t remaining; /* Antal byte som terstr av aktuell del. */
+   uint8_t sreg;      /* Statusregistret innan aktuell del pbrjades. */
+};
+
+/********************************************************************************
+* eeprom_init: Laddar speglingen av adresserna EEPROM_SHADOW_START och framt
+*              frn EEPROM-minnet. Ska anropas en gng vid start, innan
+*              vriga funktioner i denna fil anvnds.
+********************************************************************************/
+void eeprom_init(void);
+
+/********************************************************************************
+* eeprom_write_byte: Lgger en byte bestende av ett osignerat heltal i k fr
+*                    skrivning till angiven adress i EEPROM-minnet. Vid lyckad
+*                    klggning returneras 0, annars returneras felkod 1.
+*                    Vid full k vntar funktionen tills en plats har
+*                    frigjorts ifall avbrott r aktiverade, annars kastas
+*                    skrivningen och felkod 1 returneras.
 *
 *                    - address: Adressen i EEPROM-minnet som angiven data
 *                               ska lagras p.
@@ -36,6 +135,22 @@ int eeprom_write_byte(const uint16_t address,
 int eeprom_write_word(const uint16_t address_low, 
                       const uint16_t data);
 
+/********************************************************************************
+* eeprom_write_block: Lgger angivet antal byte i k fr skrivning till angiven
+*                     adress och framt i EEPROM-minnet. Vid lyckad klggning
+*                     returneras 0. Om blocket inte ryms i EEPROM-minnet sker
+*                     ingen skrivning och felkod 1 returneras. Felkod 1
+*                     returneras ven ifall en byte kastas p grund av full
+*                     k, varvid efterfljande byte inte lggs i k.
+*
+*                     - address: Frsta adressen som blocket ska lagras p.
+*                     - data   : Pekare till datan som ska skrivas.
+*                     - size   : Antal byte som ska skrivas.
+********************************************************************************/
+int eeprom_write_block(const uint16_t address,
+                       const void* data,
+                       const uint16_t size);
+
 /********************************************************************************
 * eeprom_read_byte: Lser en byte p angiven adress i EEPROM-minnet och 
 *                   returnerar detta som ett osignerat heltal. Vid misslyckad
@@ -55,4 +170,74 @@ uint8_t eeprom_read_byte(const uint16_t address);
 ********************************************************************************/
 uint16_t eeprom_read_word(const uint16_t address_low);
 
+/********************************************************************************
+* eeprom_read_block: Lser angivet antal byte frn angiven adress och framt i
+*                    EEPROM-minnet. Vid lyckad lsning returneras 0. Om blocket
+*                    inte ryms i EEPROM-minnet sker ingen lsning och felkod 1
+*                    returneras.
+*
+*                    - address: Frsta adressen som ska lsas av.
+*                    - data   : Pekare till minnet som datan ska lagras i.
+*                    - size   : Antal byte som ska lsas.
+********************************************************************************/
+int eeprom_read_block(const uint16_t address,
+                      void* data,
+                      const uint16_t size);
+
+/********************************************************************************
+* eeprom_cursor_begin: Pbrjar sekventiell lsning frn angiven adress.
+*                      Eventuell pgende skrivning avvaktas, varefter
+*                      avbrott inaktiveras under frsta delen av lsningen.
+*
+*                      - self   : Pekare till strukten fr lsningen.
+*                      - address: Frsta adressen som ska lsas av.
+********************************************************************************/
+void eeprom_cursor_begin(struct eeprom_cursor* self,
+                         const uint16_t address);
+
+/********************************************************************************
+* eeprom_cursor_read: Lser nsta byte och stegar fram till efterfljande
+*                     adress. Efter hgsta adressen i EEPROM-minnet
+*                     returneras 0. Efter var EEPROM_BLOCK_CHUNK:e byte
+*                     terstlls avbrott temporrt innan nsta del pbrjas.
+*
+*                     - self: Pekare till strukten fr lsningen.
+********************************************************************************/
+uint8_t eeprom_cursor_read(struct eeprom_cursor* self);
+
+/********************************************************************************
+* eeprom_cursor_end: Avslutar sekventiell lsning, varvid avbrott terstlls
+*                    till tillstndet innan eeprom_cursor_begin anropades.
+*
+*                    - self: Pekare till strukten fr lsningen.
+********************************************************************************/
+void eeprom_cursor_end(struct eeprom_cursor* self);
+
+/********************************************************************************
+* eeprom_write_next: Pbrjar skrivning av nsta byte i kn. Om kn r tom
+*                    inaktiveras avbrott fr EEPROM-minnet. Denna funktion ska
+*                    anropas i avbrottsrutinen fr EEPROM-minnet (EE_READY_vect)
+*                    och fr enbart anropas nr ingen skrivning pgr.
+********************************************************************************/
+void eeprom_write_next(void);
+
+/********************************************************************************
+* eeprom_flush: Vntar tills samtliga vntande skrivningar har genomfrts.
+*               Funktionen kan anropas ven med avbrott inaktiverade,
+*               exempelvis frn en avbrottsrutin, d kn i s fall tms
+*               direkt av funktionen.
+********************************************************************************/
+void eeprom_flush(void);
+
+/********************************************************************************
+* eeprom_pending: Returnerar antalet skrivningar som ligger i k.
+********************************************************************************/
+uint8_t eeprom_pending(void);
+
+/********************************************************************************
+* eeprom_dropped: Returnerar antalet skrivningar som har kastats p grund av
+*                 full k sedan start.
+********************************************************************************/
+uint32_t eeprom_dropped(void);
+
 #endif /* EEPROM_H_ */
\ No newline at end of file
@@ -0,0 +1,201 @@
+/********************************************************************************
+* eeprom_ring.c: Innehller funktionsdefinitioner fr slitageutjmnad lagring
+*                av ett vrde i EEPROM-minnet via strukten eeprom_ring.
+********************************************************************************/
+#include "eeprom_ring.h"
+
+/********************************************************************************
+* Statiska funktioner:
+********************************************************************************/
+static inline uint16_t eeprom_ring_slot_address(const struct eeprom_ring* self,
+                                                const uint8_t slot);
+static inline uint8_t eeprom_ring_read_sequence(const struct eeprom_ring* self,
+                                                const uint8_t slot);
+static inline uint8_t eeprom_ring_next_sequence(const uint8_t sequence,
+                                                const uint8_t steps);
+
+/********************************************************************************
+* eeprom_ring_init: Initierar lagring i angivet omrde i EEPROM-minnet och
+*                   letar upp nyaste vrdet i omrdet. Vid felaktigt angivet
+*                   omrde returneras felkod 1, annars returneras 0.
+*
+*                   1. Om frsta platsens sekvensnummer r 0xFF har antingen
+*                      inget vrde lagrats, eller s avbrts omskrivningen av
+*                      frsta platsen efter ett helt varv av spnningsbortfall
+*                      mellan radering och skrivning av sekvensnumret. I det
+*                      senare fallet innehller andra platsen ett giltigt
+*                      sekvensnummer, varvid skningen startar frn andra
+*                      platsen i stllet, s att vrdena frn fregende varv
+*                      inte frkastas. Om ven andra platsen r oanvnd har
+*                      inget vrde lagrats, varvid nsta skrivning sker till
+*                      frsta platsen med sekvensnummer 0.
+*
+*                   2. Annars gller att platserna fram till och med nyaste
+*                      platsen har sekvensnummer i obruten fljd rknat frn
+*                      startplatsen, medan efterfljande platser antingen r
+*                      oanvnda eller innehller ldre vrden frn fregende
+*                      varv, vars sekvensnummer inte fljer. Nyaste platsen
+*                      hittas drmed via binrskning, vilket krver hgst
+*                      tta lsningar oavsett antalet platser.
+*
+*                   3. Nyaste vrdet lses in och lagras i RAM.
+*
+*                   - self   : Pekare till strukten som ska initieras.
+*                   - address: Frsta adressen i omrdet.
+*                   - slots  : Antal platser i omrdet (2 - 254), dr
+*                              omrdet upptar slots * 5 byte.
+********************************************************************************/
+int eeprom_ring_init(struct eeprom_ring* self,
+                     const uint16_t address,
+                     const uint8_t slots)
+{
+   if (slots < EEPROM_RING_MIN_SLOTS || slots > EEPROM_RING_MAX_SLOTS) return 1;
+   if ((uint32_t)address + (uint32_t)slots * EEPROM_RING_SLOT_SIZE - 1 > EEPROM_ADDRESS_MAX) return 1;
+
+   self->address = address;
+   self->slots = slots;
+   self->value = 0;
+
+   uint8_t start = 0;
+   uint8_t first = eeprom_ring_read_sequence(self, 0);
+
+   if (first == EEPROM_RING_EMPTY)
+   {
+      start = 1;
+      first = eeprom_ring_read_sequence(self, 1);
+   }
+
+   if (first == EEPROM_RING_EMPTY)
+   {
+      self->newest = slots - 1;
+      self->sequence = EEPROM_RING_EMPTY - 1;
+      self->empty = true;
+      return 0;
+   }
+
+   uint8_t low = start;
+   uint8_t high = slots - 1;
+
+   while (low < high)
+   {
+      const uint8_t middle = low + (high - low + 1) / 2;
+
+      if (eeprom_ring_read_sequence(self, middle) == eeprom_ring_next_sequence(first, middle - start))
+      {
+         low = middle;
+      }
+      else
+      {
+         high = middle - 1;
+      }
+   }
+
+   self->newest = low;
+   self->sequence = eeprom_ring_next_sequence(first, low - start);
+   self->empty = false;
+
+   uint8_t bytes[4];
+   eeprom_read_block(eeprom_ring_slot_address(self, low), bytes, sizeof(bytes));
+
+   for (uint8_t i = sizeof(bytes); i-- > 0;)
+   {
+      self->value = (self->value << 8) | bytes[i];
+   }
+   return 0;
+}
+
+/********************************************************************************
+* eeprom_ring_read: Lser nyaste vrdet i omrdet. Om inget vrde har lagrats
+*                   returneras felkod 1, annars returneras 0 efter att vrdet
+*                   har lagrats via angiven pekare.
+*
+*                   - self : Pekare till omrdet som ska lsas av.
+*                   - value: Pekare till variabeln som vrdet ska lagras i.
+********************************************************************************/
+int eeprom_ring_read(const struct eeprom_ring* self,
+                     uint32_t* value)
+{
+   if (self->empty) return 1;
+   *value = self->value;
+   return 0;
+}
+
+/********************************************************************************
+* eeprom_ring_write: Skriver nytt vrde till nsta plats i omrdet. Om vrdet
+*                    inte skiljer sig frn nyaste vrdet sker ingen skrivning.
+*                    Vid felaktigt initierat omrde returneras felkod 1.
+*                    Felkod 1 returneras ven ifall en skrivning kastas p
+*                    grund av full k i EEPROM-drivrutinen, varvid nyaste
+*                    platsen frblir ofrndrad. Annars returneras 0.
+*
+*                    1. Nsta plats samt nsta sekvensnummer berknas.
+*
+*                    2. Vrdet skrivs till platsen, varefter sekvensnumret
+*                       skrivs sist. Drmed blir platsen nyaste platsen frst
+*                       nr hela vrdet har skrivits.
+*
+*                    - self : Pekare till omrdet som ska skrivas till.
+*                    - value: Vrdet som ska skrivas.
+********************************************************************************/
+int eeprom_ring_write(struct eeprom_ring* self,
+                      const uint32_t value)
+{
+   if (self->slots < EEPROM_RING_MIN_SLOTS) return 1;
+   if (!self->empty && value == self->value) return 0;
+
+   const uint8_t slot = self->newest + 1 < self->slots ? self->newest + 1 : 0;
+   const uint8_t sequence = eeprom_ring_next_sequence(self->sequence, 1);
+   const uint16_t slot_address = eeprom_ring_slot_address(self, slot);
+
+   for (uint8_t i = 0; i < 4; ++i)
+   {
+      if (eeprom_write_byte(slot_address + i, (uint8_t)(value >> (8 * i)))) return 1;
+   }
+
+   if (eeprom_write_byte(slot_address + 4, sequence)) return 1;
+
+   self->newest = slot;
+   self->sequence = sequence;
+   self->value = value;
+   self->empty = false;
+   return 0;
+}
+
+/********************************************************************************
+* eeprom_ring_slot_address: Returnerar frsta adressen fr angiven plats.
+*
+*                           - self: Pekare till omrdet.
+*                           - slot: Index fr platsen.
+********************************************************************************/
+static inline uint16_t eeprom_ring_slot_address(const struct eeprom_ring* self,
+                                                const uint8_t slot)
+{
+   return self->address + (uint16_t)slot * EEPROM_RING_SLOT_SIZE;
+}
+
+/********************************************************************************
+* eeprom_ring_read_sequence: Returnerar sekvensnumret fr angiven plats.
+*
+*                            - self: Pekare till omrdet.
+*                            - slot: Index fr platsen.
+********************************************************************************/
+static inline uint8_t eeprom_ring_read_sequence(const struct eeprom_ring* self,
+                                                const uint8_t slot)
+{
+   return eeprom_read_byte(eeprom_ring_slot_address(self, slot) + 4);
+}
+
+/********************************************************************************
+* eeprom_ring_next_sequence: Returnerar sekvensnumret angivet antal steg efter
+*                            angivet sekvensnummer, dr omslag sker frn 254
+*                            till 0, s att 0xFF aldrig anvnds.
+*
+*                            - sequence: Sekvensnumret som ska rknas upp.
+*                            - steps   : Antal steg (0 - 254).
+********************************************************************************/
+static inline uint8_t eeprom_ring_next_sequence(const uint8_t sequence,
+                                                const uint8_t steps)
+{
+   const uint16_t next = (uint16_t)sequence + steps;
+   return next >= EEPROM_RING_EMPTY ? (uint8_t)(next - EEPROM_RING_EMPTY) : (uint8_t)next;
+}
@@ -0,0 +1,97 @@
+/********************************************************************************
+* eeprom_ring.h: Innehller funktionalitet fr slitageutjmnad lagring av ett
+*                32-bitars vrde i EEPROM-minnet via strukten eeprom_ring samt
+*                associerade funktioner. EEPROM-minnet p ATmega328P klarar
+*                ungefr 100 000 skrivningar per adress, vilket vid skrivning
+*                en gng per sekund till samma adress rcker i drygt ett dygn.
+*
+*                I stllet fr att skriva vrdet till samma adress varje gng
+*                roteras skrivningarna ver ett omrde med ett godtyckligt
+*                antal platser (slots), vilket sprider slitaget jmnt. Varje
+*                plats bestr av fem byte, dr vrdet lagras frst med minst
+*                signifikant byte frst, fljt av ett sekvensnummer:
+*
+*                | vrde (4 byte) | sekvensnummer (1 byte) |
+*
+*                Sekvensnumret rknas upp med ett fr varje skrivning och
+*                slr om frn 254 till 0, dr 0xFF (raderad EEPROM) markerar
+*                en oanvnd plats. Sekvensnumret skrivs sist, s att en
+*                skrivning som avbryts av spnningsbortfall inte ger en
+*                plats som ser nyare ut n fregende plats. Nyaste platsen
+*                r den sista platsen vars sekvensnummer fljer i obruten
+*                fljd frn frsta platsen, vilket hittas via binrskning.
+*                Om frsta platsens sekvensnummer har raderats av ett
+*                spnningsbortfall under omskrivning sker skningen i stllet
+*                frn andra platsen, se eeprom_ring_init.
+*
+*                Slitaget per adress blir drmed ungefr antalet skrivningar
+*                delat med antalet platser. Exempelvis medfr 100 platser och
+*                en skrivning per sekund att EEPROM-minnet rcker i ungefr
+*                tre mnader i stllet fr ett dygn.
+********************************************************************************/
+#ifndef EEPROM_RING_H_
+#define EEPROM_RING_H_
+
+/* Inkluderingsdirektiv: */
+#include "misc.h"
+#include "eeprom.h"
+
+/* Makrodefinitioner: */
+#define EEPROM_RING_SLOT_SIZE 5    /* Antal byte per plats (vrde samt sekvensnummer). */
+#define EEPROM_RING_MIN_SLOTS 2    /* Minsta antal platser. */
+#define EEPROM_RING_MAX_SLOTS 254  /* Hgsta antal platser (frre n antalet sekvensnummer). */
+#define EEPROM_RING_EMPTY     0xFF /* Sekvensnummer fr oanvnd plats. */
+
+/********************************************************************************
+* eeprom_ring: Strukt fr slitageutjmnad lagring av ett vrde i ett omrde i
+*              EEPROM-minnet. Nyaste vrdet lagras ven i RAM, s att lsning
+*              inte krver tkomst till EEPROM-minnet.
+********************************************************************************/
+struct eeprom_ring
+{
+   uint16_t address;  /* Frsta adressen i omrdet. */
+   uint8_t slots;     /* Antal platser i omrdet. */
+   uint8_t newest;    /* Index fr platsen med nyaste vrdet. */
+   uint8_t sequence;  /* Sekvensnummer fr nyaste vrdet. */
+   uint32_t value;    /* Nyaste vrdet. */
+   bool empty;        /* Indikerar ifall inget vrde har lagrats i omrdet. */
+};
+
+/********************************************************************************
+* eeprom_ring_init: Initierar lagring i angivet omrde i EEPROM-minnet och
+*                   letar upp nyaste vrdet i omrdet. Vid felaktigt angivet
+*                   omrde returneras felkod 1, annars returneras 0.
+*
+*                   - self   : Pekare till strukten som ska initieras.
+*                   - address: Frsta adressen i omrdet.
+*                   - slots  : Antal platser i omrdet (2 - 254), dr
+*                              omrdet upptar slots * 5 byte.
+********************************************************************************/
+int eeprom_ring_init(struct eeprom_ring* self,
+                     const uint16_t address,
+                     const uint8_t slots);
+
+/********************************************************************************
+* eeprom_ring_read: Lser nyaste vrdet i omrdet. Om inget vrde har lagrats
+*                   returneras felkod 1, annars returneras 0 efter att vrdet
+*                   har lagrats via angiven pekare.
+*
+*                   - self : Pekare till omrdet som ska lsas av.
+*                   - value: Pekare till variabeln som vrdet ska lagras i.
+********************************************************************************/
+int eeprom_ring_read(const struct eeprom_ring* self,
+                     uint32_t* value);
+
+/********************************************************************************
+* eeprom_ring_write: Skriver nytt vrde till nsta plats i omrdet. Om vrdet
+*                    inte skiljer sig frn nyaste vrdet sker ingen skrivning.
+*                    Vid felaktigt initierat omrde eller kastad skrivning p
+*                    grund av full k returneras felkod 1, annars returneras 0.
+*
+*                    - self : Pekare till omrdet som ska skrivas till.
+*                    - value: Vrdet som ska skrivas.
+********************************************************************************/
+int eeprom_ring_write(struct eeprom_ring* self,
+                      const uint32_t value);
+
+#endif /* EEPROM_RING_H_ */
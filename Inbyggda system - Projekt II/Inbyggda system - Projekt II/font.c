@@ -0,0 +1,116 @@
+/********************************************************************************
+* font.c: Innehller teckensnittet fr 7-segmentsdisplayer samt funktioner fr
+*         uppslag av ASCII-tecken.
+********************************************************************************/
+#include "font.h"
+
+/* Makrodefinitioner fr frkortade segmentnamn (enbart fr tabellerna nedan): */
+#define a FONT_SEGMENT_A
+#define b FONT_SEGMENT_B
+#define c FONT_SEGMENT_C
+#define d FONT_SEGMENT_D
+#define e FONT_SEGMENT_E
+#define f FONT_SEGMENT_F
+#define g FONT_SEGMENT_G
+
+/********************************************************************************
+* font_table: Uppslagstabell med binrkoder fr samtliga tecken, indexerad
+*             via enumerationen font_glyph. Binrkoderna stts samman av
+*             segmenten vid kompilering och lagras i programminnet.
+********************************************************************************/
+const uint8_t font_table[FONT_GLYPH_COUNT] PROGMEM =
+{
+   [FONT_GLYPH_0]          = a | b | c | d | e | f,
+   [FONT_GLYPH_1]          = b | c,
+   [FONT_GLYPH_2]          = a | b | d | e | g,
+   [FONT_GLYPH_3]          = a | b | c | d | g,
+   [FONT_GLYPH_4]          = b | c | f | g,
+   [FONT_GLYPH_5]          = a | c | d | f | g,
+   [FONT_GLYPH_6]          = a | c | d | e | f | g,
+   [FONT_GLYPH_7]          = a | b | c,
+   [FONT_GLYPH_8]          = a | b | c | d | e | f | g,
+   [FONT_GLYPH_9]          = a | b | c | d | f | g,
+   [FONT_GLYPH_A]          = a | b | c | e | f | g,
+   [FONT_GLYPH_B]          = c | d | e | f | g,
+   [FONT_GLYPH_C]          = a | d | e | f,
+   [FONT_GLYPH_D]          = b | c | d | e | g,
+   [FONT_GLYPH_E]          = a | d | e | f | g,
+   [FONT_GLYPH_F]          = a | e | f | g,
+   [FONT_GLYPH_BLANK]      = FONT_BLANK,
+   [FONT_GLYPH_MINUS]      = g,
+   [FONT_GLYPH_UNDERSCORE] = d,
+   [FONT_GLYPH_DEGREE]     = a | b | f | g,
+   [FONT_GLYPH_G]          = a | c | d | e | f,
+   [FONT_GLYPH_H]          = b | c | e | f | g,
+   [FONT_GLYPH_I]          = e | f,
+   [FONT_GLYPH_J]          = b | c | d | e,
+   [FONT_GLYPH_L]          = d | e | f,
+   [FONT_GLYPH_N]          = c | e | g,
+   [FONT_GLYPH_O]          = c | d | e | g,
+   [FONT_GLYPH_P]          = a | b | e | f | g,
+   [FONT_GLYPH_Q]          = a | b | c | f | g,
+   [FONT_GLYPH_R]          = e | g,
+   [FONT_GLYPH_S]          = a | c | d | f | g,
+   [FONT_GLYPH_T]          = d | e | f | g,
+   [FONT_GLYPH_U]          = b | c | d | e | f,
+   [FONT_GLYPH_Y]          = b | c | d | f | g
+};
+
+#undef a
+#undef b
+#undef c
+#undef d
+#undef e
+#undef f
+#undef g
+
+/********************************************************************************
+* font_letters: Tecken i teckensnittet fr bokstverna A - Z i alfabetisk
+*               ordning. Bokstver som inte gr att visa p sju segment
+*               (K, M, V, W, X samt Z) ger slckt display.
+********************************************************************************/
+static const uint8_t font_letters[26] PROGMEM =
+{
+   FONT_GLYPH_A, FONT_GLYPH_B, FONT_GLYPH_C, FONT_GLYPH_D, FONT_GLYPH_E,
+   FONT_GLYPH_F, FONT_GLYPH_G, FONT_GLYPH_H, FONT_GLYPH_I, FONT_GLYPH_J,
+   FONT_GLYPH_BLANK, FONT_GLYPH_L, FONT_GLYPH_BLANK, FONT_GLYPH_N,
+   FONT_GLYPH_O, FONT_GLYPH_P, FONT_GLYPH_Q, FONT_GLYPH_R, FONT_GLYPH_S,
+   FONT_GLYPH_T, FONT_GLYPH_U, FONT_GLYPH_BLANK, FONT_GLYPH_BLANK,
+   FONT_GLYPH_BLANK, FONT_GLYPH_Y, FONT_GLYPH_BLANK
+};
+
+/********************************************************************************
+* font_get_char: Returnerar binrkod fr angivet ASCII-tecken. Siffror, mellan-
+*                slag, minustecken, understreck samt de bokstver som gr att
+*                visa p sju segment stds, dr versaler och gemener ger samma
+*                tecken. vriga tecken ger binrkod fr slckt display.
+*
+*                - c: ASCII-tecknet vars binrkod ska returneras.
+********************************************************************************/
+uint8_t font_get_char(const char c)
+{
+   if (c >= '0' && c <= '9')
+   {
+      return font_get_digit((uint8_t)(c - '0'));
+   }
+   else if (c >= 'A' && c <= 'Z')
+   {
+      return font_get_glyph((enum font_glyph)pgm_read_byte(&font_letters[c - 'A']));
+   }
+   else if (c >= 'a' && c <= 'z')
+   {
+      return font_get_glyph((enum font_glyph)pgm_read_byte(&font_letters[c - 'a']));
+   }
+   else if (c == '-')
+   {
+      return font_get_glyph(FONT_GLYPH_MINUS);
+   }
+   else if (c == '_')
+   {
+      return font_get_glyph(FONT_GLYPH_UNDERSCORE);
+   }
+   else
+   {
+      return FONT_BLANK;
+   }
+}
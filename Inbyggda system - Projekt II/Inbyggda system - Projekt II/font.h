@@ -0,0 +1,122 @@
+/********************************************************************************
+* font.h: Innehller teckensnitt fr 7-segmentsdisplayer i form av en
+*         uppslagstabell lagrad i programminnet (flash). Tabellen innehller
+*         binrkoder fr de hexadecimala siffrorna 0 - F, slckt display,
+*         minustecken samt de bokstver som gr att visa p sju segment.
+*
+*         Segmenten a - g motsvarar bit 0 - 6 i binrkoden, dr segment a r
+*         det versta segmentet och segmenten drefter fljer medurs, med
+*         segment g i mitten:
+*
+*          aaa
+*         f   b
+*          ggg
+*         e   c
+*          ddd
+*
+*         Binrkoden fr en siffra 0 - 15 hmtas i konstant tid via ett enda
+*         uppslag i tabellen (LPM-instruktionen), vilket gr funktionen
+*         font_get_digit lmplig att anropa i avbrottsrutiner.
+********************************************************************************/
+#ifndef FONT_H_
+#define FONT_H_
+
+/* Inkluderingsdirektiv: */
+#include "misc.h"
+
+/* Makrodefinitioner fr segmenten: */
+#define FONT_SEGMENT_A  (1 << 0) /* vre segmentet. */
+#define FONT_SEGMENT_B  (1 << 1) /* vre hgra segmentet. */
+#define FONT_SEGMENT_C  (1 << 2) /* Nedre hgra segmentet. */
+#define FONT_SEGMENT_D  (1 << 3) /* Nedre segmentet. */
+#define FONT_SEGMENT_E  (1 << 4) /* Nedre vnstra segmentet. */
+#define FONT_SEGMENT_F  (1 << 5) /* vre vnstra segmentet. */
+#define FONT_SEGMENT_G  (1 << 6) /* Mittersta segmentet. */
+#define FONT_SEGMENT_DP (1 << 7) /* Decimalpunkt (ej ansluten p aktuella displayer). */
+
+#define FONT_BLANK 0x00 /* Binrkod fr slckt display. */
+
+/********************************************************************************
+* font_glyph: Enumeration fr tecknen i teckensnittet. Siffrorna 0 - 15 har
+*             samma index som sitt vrde, vilket gr att ett heltal kan
+*             anvndas direkt som index vid utskrift av tal.
+********************************************************************************/
+enum font_glyph
+{
+   FONT_GLYPH_0,          /* Siffran 0. */
+   FONT_GLYPH_1,          /* Siffran 1. */
+   FONT_GLYPH_2,          /* Siffran 2. */
+   FONT_GLYPH_3,          /* Siffran 3. */
+   FONT_GLYPH_4,          /* Siffran 4. */
+   FONT_GLYPH_5,          /* Siffran 5. */
+   FONT_GLYPH_6,          /* Siffran 6. */
+   FONT_GLYPH_7,          /* Siffran 7. */
+   FONT_GLYPH_8,          /* Siffran 8. */
+   FONT_GLYPH_9,          /* Siffran 9. */
+   FONT_GLYPH_A,          /* Bokstaven A (0xA). */
+   FONT_GLYPH_B,          /* Bokstaven b (0xB). */
+   FONT_GLYPH_C,          /* Bokstaven C (0xC). */
+   FONT_GLYPH_D,          /* Bokstaven d (0xD). */
+   FONT_GLYPH_E,          /* Bokstaven E (0xE). */
+   FONT_GLYPH_F,          /* Bokstaven F (0xF). */
+   FONT_GLYPH_BLANK,      /* Slckt display. */
+   FONT_GLYPH_MINUS,      /* Minustecken. */
+   FONT_GLYPH_UNDERSCORE, /* Understreck. */
+   FONT_GLYPH_DEGREE,     /* Gradtecken. */
+   FONT_GLYPH_G,          /* Bokstaven G. */
+   FONT_GLYPH_H,          /* Bokstaven H. */
+   FONT_GLYPH_I,          /* Bokstaven I. */
+   FONT_GLYPH_J,          /* Bokstaven J. */
+   FONT_GLYPH_L,          /* Bokstaven L. */
+   FONT_GLYPH_N,          /* Bokstaven n. */
+   FONT_GLYPH_O,          /* Bokstaven o. */
+   FONT_GLYPH_P,          /* Bokstaven P. */
+   FONT_GLYPH_Q,          /* Bokstaven q. */
+   FONT_GLYPH_R,          /* Bokstaven r. */
+   FONT_GLYPH_S,          /* Bokstaven S. */
+   FONT_GLYPH_T,          /* Bokstaven t. */
+   FONT_GLYPH_U,          /* Bokstaven U. */
+   FONT_GLYPH_Y,          /* Bokstaven y. */
+   FONT_GLYPH_COUNT       /* Antal tecken i teckensnittet. */
+};
+
+/********************************************************************************
+* font_table: Uppslagstabell med binrkoder fr samtliga tecken, indexerad
+*             via enumerationen font_glyph och lagrad i programminnet.
+********************************************************************************/
+extern const uint8_t font_table[FONT_GLYPH_COUNT] PROGMEM;
+
+/********************************************************************************
+* font_get_glyph: Returnerar binrkod fr angivet tecken. Vid felaktigt angivet
+*                 tecken returneras binrkod fr slckt display.
+*
+*                 - glyph: Tecknet vars binrkod ska returneras.
+********************************************************************************/
+static inline uint8_t font_get_glyph(const enum font_glyph glyph)
+{
+   return glyph < FONT_GLYPH_COUNT ? pgm_read_byte(&font_table[glyph]) : FONT_BLANK;
+}
+
+/********************************************************************************
+* font_get_digit: Returnerar binrkod fr angivet heltal 0 - 15. Vid felaktigt
+*                 angivet heltal (ver 15) returneras binrkod fr slckt
+*                 display.
+*
+*                 - digit: Heltal vars binrkod ska returneras.
+********************************************************************************/
+static inline uint8_t font_get_digit(const uint8_t digit)
+{
+   return digit <= FONT_GLYPH_F ? pgm_read_byte(&font_table[digit]) : FONT_BLANK;
+}
+
+/********************************************************************************
+* font_get_char: Returnerar binrkod fr angivet ASCII-tecken. Siffror, mellan-
+*                slag, minustecken, understreck samt de bokstver som gr att
+*                visa p sju segment stds, dr versaler och gemener ger samma
+*                tecken. vriga tecken ger binrkod fr slckt display.
+*
+*                - c: ASCII-tecknet vars binrkod ska returneras.
+********************************************************************************/
+uint8_t font_get_char(const char c);
+
+#endif /* FONT_H_ */
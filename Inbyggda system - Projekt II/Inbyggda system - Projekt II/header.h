@@ -2,15 +2,45 @@
 #ifndef HEADER_H_
 #define HEADER_H_
 
-#include "timer.h"
+#include "soft_timer.h"
 #include "wdt.h"
 #include "display.h"
 #include "button.h"
+#include "power.h"
+#include "serial.h"
+#include "command.h"
+#include "telemetry.h"
+#include "isr_profile.h"
+#include "stack.h"
+#include "cpu_load.h"
+#include "idle.h"
+
+/********************************************************************************
+* SERIAL_CONSOLE_ENABLED: Aktiverar seriell konsol via USART, det vill sga
+*                         fjrrstyrning via kommandon, se command.h. USART tar
+*                         d ver PORTD0 - PORTD1 (RXD samt TXD), som annars
+*                         driver segment a och b p 7-segmentsdisplayerna,
+*                         varfr konsolen r inaktiverad som default.
+*                         Aktiveras exempelvis vid kompilering via
+*                         -DSERIAL_CONSOLE_ENABLED=1.
+* SERIAL_CONSOLE_BAUD   : verfringshastighet fr konsolen.
+********************************************************************************/
+#ifndef SERIAL_CONSOLE_ENABLED
+#define SERIAL_CONSOLE_ENABLED 0
+#endif
+
+#ifndef SERIAL_CONSOLE_BAUD
+#define SERIAL_CONSOLE_BAUD 9600
+#endif
+
+#if SERIAL_BAUD_ERROR_ABS(SERIAL_CONSOLE_BAUD) > SERIAL_BAUD_ERROR_MAX
+#warning "SERIAL_CONSOLE_BAUD avviker fr mycket vid aktuell klockfrekvens!"
+#endif
 
 // Deklarera tre globala knappar (extern).
 extern struct button button1;
 extern struct button button2;
 extern struct button button3;
 
-extern struct timer timer0;
+extern struct soft_timer debounce_timer;
 #endif /* HEADER_H_ */
\ No newline at end of file
@@ -0,0 +1,712 @@
+/********************************************************************************
+* host.c: Innehller det simulerade registerlagret fr host build, innefattande
+*         registren, avbrottsvektortabellen, timerkretsarna, EEPROM-minnet
+*         samt seriell verfring (som skrivs ut till stdout).
+********************************************************************************/
+#ifdef HOST_BUILD
+
+#include "misc.h"
+#include "eeprom.h"
+#include <string.h>
+
+/********************************************************************************
+* Makrodefinitioner:
+********************************************************************************/
+#define HOST_STEP_CYCLES 64 /* Antal klockcykler mellan varje avbrottskontroll. */
+#define HOST_LOOP_CYCLES 16 /* Antal klockcykler per varv i huvudloopen. */
+#define HOST_SLEEP_MAX   F_CPU /* Lngsta vila utan avbrott mtt i klockcykler (1 s). */
+#define HOST_RX_SIZE     256 /* Antal tecken som kan vnta p mottagning. */
+#define HOST_UART_FRAME  10  /* Antal bitar per tecken (start, tta data, stopp). */
+
+/********************************************************************************
+* Simulerade I/O-register:
+********************************************************************************/
+volatile uint8_t PINB, DDRB, PORTB;
+volatile uint8_t PINC, DDRC, PORTC;
+volatile uint8_t PIND, DDRD, PORTD;
+
+volatile uint8_t PCICR, PCIFR, PCMSK0, PCMSK1, PCMSK2;
+
+volatile uint8_t TCCR0A, TCCR0B, TCNT0, OCR0A, OCR0B, TIMSK0, TIFR0;
+volatile uint8_t TCCR1A, TCCR1B, TCCR1C, TIMSK1, TIFR1;
+volatile uint8_t TCCR2A, TCCR2B, TCNT2, OCR2A, OCR2B, TIMSK2, TIFR2;
+
+volatile uint8_t UCSR0B, UCSR0C;
+volatile uint8_t ACSR, ADCSRA, ADCSRB, ADMUX, DIDR0, DIDR1;
+volatile uint8_t WDTCSR, MCUSR, SREG;
+volatile uint8_t PRR, SMCR;
+
+volatile uint16_t TCNT1, OCR1A, OCR1B, ICR1;
+volatile uint16_t EEAR, UBRR0;
+volatile uint16_t SP = RAMEND;
+
+uint8_t host_ram[RAMEND + 1];
+uint16_t host_data_end = RAMSTART;
+
+/********************************************************************************
+* host_timer: Strukt innehllande tillstndet fr en simulerad timerkrets.
+*
+*             - prescaler_cycles: Klockcykler som nnu inte rknat upp timern.
+********************************************************************************/
+struct host_timer
+{
+   uint32_t prescaler_cycles;
+};
+
+/********************************************************************************
+* Statiska variabler:
+*
+*   - isr_table     : Simulerad avbrottsvektortabell.
+*   - isr_counter   : Antal anrop per avbrottsvektor.
+*   - isr_total     : Totalt antal anrop av avbrottsrutiner.
+*   - total_cycles  : Totalt antal simulerade klockcykler.
+*   - pending_cycles: Klockcykler som nnu inte har simulerats (frre n
+*                     HOST_STEP_CYCLES).
+*   - timers        : Tillstndet fr Timer 0 - 2.
+*   - active_vector : Avbrottsvektorn vars avbrottsrutin krs (0 = ingen).
+*
+*   - eecr, eedr    : EEPROM-minnets kontroll- och dataregister.
+*   - eeprom        : Simulerat EEPROM-minne, raderat (0xFF) vid start.
+*   - eeprom_writes : Antal fysiska skrivningar per adress.
+*   - eeprom_erased : Indikerar ifall EEPROM-minnet har raderats.
+*
+*   - ucsr0a        : Statusregister fr seriell verfring, dr
+*                     dataregistret alltid r tomt (UDRE0 satt).
+*   - rx_full       : Indikerar ifall ett mottaget tecken vntar p att
+*                     lsas ut (RXC0).
+*   - rx_overrun    : Indikerar ifall ett tecken har kastats p grund av att
+*                     fregende tecken inte hade lsts ut (DOR0).
+*   - udr0          : Dataregister fr seriell verfring.
+*   - udr0_pending  : Indikerar ifall dataregistret har ett tecken som nnu
+*                     inte har skrivits ut.
+*   - rx_data       : Senast mottagna tecken (dataregistret vid lsning).
+*   - rx_queue      : Tecken som vntar p att tas emot, i ordning.
+*   - rx_head       : Index fr nsta tecken som ska tas emot.
+*   - rx_count      : Antal tecken i kn.
+*   - rx_cycles     : Klockcykler sedan fregende mottagna tecken.
+********************************************************************************/
+static void (*isr_table[HOST_VECTOR_COUNT])(void);
+static uint32_t isr_counter[HOST_VECTOR_COUNT];
+static uint32_t isr_total = 0;
+static uint64_t total_cycles = 0;
+static uint32_t pending_cycles = 0;
+static struct host_timer timers[3];
+static uint8_t active_vector = 0;
+
+static uint8_t eecr = 0;
+static uint8_t eedr = 0;
+static uint8_t eeprom[EEPROM_ADDRESS_MAX + 1];
+static uint32_t eeprom_writes[EEPROM_ADDRESS_MAX + 1];
+static bool eeprom_erased = false;
+
+static uint8_t ucsr0a = (1 << UDRE0);
+static bool rx_full = false;
+static bool rx_overrun = false;
+static uint8_t udr0 = 0;
+static bool udr0_pending = false;
+static uint8_t rx_data = 0;
+static uint8_t rx_queue[HOST_RX_SIZE];
+static uint16_t rx_head = 0;
+static uint16_t rx_count = 0;
+static uint32_t rx_cycles = 0;
+
+/********************************************************************************
+* Statiska funktioner:
+********************************************************************************/
+static void host_eeprom_update(void);
+static void host_uart_flush(void);
+static void host_uart_receive(const uint32_t step_cycles);
+static void host_step(const uint32_t step_cycles);
+static void host_dispatch_interrupts(void);
+static void host_sleep(void);
+static bool host_interrupt_pending(const uint8_t vector);
+static uint16_t host_timer_prescaler(const uint8_t timer_sel, const uint8_t tccrb);
+static uint32_t host_timer_ticks(struct host_timer* self, const uint16_t prescaler,
+                                 const uint32_t step_cycles);
+
+/********************************************************************************
+* host_eecr: Returnerar pekare till EEPROM-minnets kontrollregister efter att
+*            eventuell vntande lsning eller skrivning har slutfrts.
+********************************************************************************/
+volatile uint8_t* host_eecr(void)
+{
+   host_eeprom_update();
+   return &eecr;
+}
+
+/********************************************************************************
+* host_eedr: Returnerar pekare till EEPROM-minnets dataregister efter att
+*            eventuell vntande lsning eller skrivning har slutfrts.
+********************************************************************************/
+volatile uint8_t* host_eedr(void)
+{
+   host_eeprom_update();
+   return &eedr;
+}
+
+/********************************************************************************
+* host_ucsr0a: Returnerar pekare till statusregistret fr seriell verfring
+*              efter att eventuella vntande avbrott har genererats. Drmed
+*              tms exempelvis sndbufferten av avbrottsrutinen medan
+*              drivrutinen vntar i en pollningsloop, precis som p
+*              mikrodatorn. Statusflaggorna UDRE0, RXC0 samt DOR0 r
+*              skrivskyddade och terstlls drmed vid varje tkomst, medan
+*              vriga bitar (exempelvis U2X0) behller skrivet vrde.
+********************************************************************************/
+volatile uint8_t* host_ucsr0a(void)
+{
+   host_dispatch_interrupts();
+   ucsr0a &= ~((1 << RXC0) | (1 << DOR0));
+   ucsr0a |= (1 << UDRE0);
+   if (rx_full) ucsr0a |= (1 << RXC0);
+   if (rx_overrun) ucsr0a |= (1 << DOR0);
+   return &ucsr0a;
+}
+
+/********************************************************************************
+* host_udr0: Returnerar pekare till dataregistret fr seriell verfring.
+*            Ett tidigare skrivet tecken skrivs frst ut till stdout.
+*
+*            Dataregistret lses enbart av avbrottsrutinen fr mottagning
+*            (USART_RX_vect), varfr tkomst drifrn tolkas som lsning av
+*            senast mottagna tecken, varvid flaggorna RXC0 samt DOR0
+*            nollstlls. vrig
+*            tkomst tolkas som skrivning av ett tecken som ska skickas.
+********************************************************************************/
+volatile uint8_t* host_udr0(void)
+{
+   if (active_vector == USART_RX_vect_num)
+   {
+      rx_full = false;
+      rx_overrun = false;
+      return &rx_data;
+   }
+
+   host_uart_flush();
+   udr0_pending = true;
+   return &udr0;
+}
+
+/********************************************************************************
+* host_asm: Simulerar angiven maskininstruktion. CLI samt SEI inaktiverar
+*           respektive aktiverar avbrott globalt via statusregistret, medan
+*           WDR samt SLEEP utan fregende SEI lter simulerad tid
+*           fortskrida motsvarande ett varv i huvudloopen. Sekvensen SEI
+*           fljt av SLEEP aktiverar avbrott och vilar drefter tills nsta
+*           avbrott ifall sleep mode r aktiverat (SE satt i SMCR), se
+*           host_sleep.
+*
+*           - instruction: Instruktionen som ska simuleras, exempelvis "CLI".
+********************************************************************************/
+void host_asm(const char* instruction)
+{
+   if (!strcmp(instruction, "CLI"))
+   {
+      SREG &= ~(1 << SREG_I);
+   }
+   else if (!strcmp(instruction, "SEI"))
+   {
+      SREG |= (1 << SREG_I);
+      host_dispatch_interrupts();
+   }
+   else if (!strcmp(instruction, "WDR"))
+   {
+      host_run_cycles(HOST_LOOP_CYCLES);
+   }
+   else if (!strcmp(instruction, "SLEEP"))
+   {
+      host_run_cycles(HOST_LOOP_CYCLES);
+   }
+   else if (!strcmp(instruction, "SEI\n\tSLEEP"))
+   {
+      SREG |= (1 << SREG_I);
+      if (SMCR & (1 << SE)) host_sleep();
+      else host_dispatch_interrupts();
+   }
+   return;
+}
+
+/********************************************************************************
+* host_register_isr: Registrerar avbrottsrutin fr angiven avbrottsvektor.
+*
+*                    - vector : Avbrottsvektorns nummer.
+*                    - handler: Pekare till avbrottsrutinen.
+********************************************************************************/
+void host_register_isr(const uint8_t vector,
+                       void (*handler)(void))
+{
+   if (vector < HOST_VECTOR_COUNT) isr_table[vector] = handler;
+   return;
+}
+
+/********************************************************************************
+* host_run_cycles: Lter simulerad tid fortskrida angivet antal klockcykler.
+*                  Simuleringen sker i steg om HOST_STEP_CYCLES klockcykler,
+*                  dr vntande avbrott genereras efter varje steg.
+*
+*                  - cycles: Antalet klockcykler som ska simuleras.
+********************************************************************************/
+void host_run_cycles(const uint32_t cycles)
+{
+   pending_cycles += cycles;
+
+   while (pending_cycles >= HOST_STEP_CYCLES)
+   {
+      pending_cycles -= HOST_STEP_CYCLES;
+      host_step(HOST_STEP_CYCLES);
+   }
+   return;
+}
+
+/********************************************************************************
+* host_cycles: Returnerar det totala antalet simulerade klockcykler.
+********************************************************************************/
+uint64_t host_cycles(void)
+{
+   return total_cycles;
+}
+
+/********************************************************************************
+* host_isr_count: Returnerar antalet gnger angiven avbrottsrutin har anropats.
+*
+*                 - vector: Avbrottsvektorns nummer.
+********************************************************************************/
+uint32_t host_isr_count(const uint8_t vector)
+{
+   return vector < HOST_VECTOR_COUNT ? isr_counter[vector] : 0;
+}
+
+/********************************************************************************
+* host_set_pin: Stter insignalen p angiven pin och flaggar PCI-avbrott ifall
+*               detta r aktiverat fr aktuell pin.
+*
+*               - pin  : Pin-numret som insignalen ska sttas p.
+*               - level: Insignalens nya logiska niv.
+********************************************************************************/
+void host_set_pin(const uint8_t pin,
+                  const bool level)
+{
+   volatile uint8_t* input = &PIND;
+   volatile uint8_t* pcmsk = &PCMSK2;
+   uint8_t pcif = PCIF2;
+   uint8_t bit = pin;
+
+   if (pin >= 8 && pin <= 13)
+   {
+      input = &PINB;
+      pcmsk = &PCMSK0;
+      pcif = PCIF0;
+      bit = pin - 8;
+   }
+   else if (pin >= 14 && pin <= 19)
+   {
+      input = &PINC;
+      pcmsk = &PCMSK1;
+      pcif = PCIF1;
+      bit = pin - 14;
+   }
+   else if (pin > 19)
+   {
+      return;
+   }
+
+   const bool changed = ((*input >> bit) & 1) != level;
+   if (level) *input |= (1 << bit);
+   else *input &= ~(1 << bit);
+
+   if (changed && (*pcmsk & (1 << bit)))
+   {
+      PCIFR |= (1 << pcif);
+   }
+
+   host_dispatch_interrupts();
+   return;
+}
+
+/********************************************************************************
+* host_set_analog_comparator: Stter den analoga komparatorns utsignal ACO och
+*                             flaggar avbrott ifall komparatorn r aktiverad
+*                             och flanken matchar vald avbrottsmod, dr 00
+*                             innebr bda flankerna, 10 fallande flank och
+*                             11 stigande flank.
+*
+*                             - output: Komparatorns nya utsignal.
+********************************************************************************/
+void host_set_analog_comparator(const bool output)
+{
+   const bool changed = ((ACSR >> ACO) & 1) != output;
+   if (output) ACSR |= (1 << ACO);
+   else ACSR &= ~(1 << ACO);
+
+   if (changed && !(ACSR & (1 << ACD)))
+   {
+      const uint8_t mode = ACSR & ((1 << ACIS1) | (1 << ACIS0));
+
+      if (mode == 0 || (mode == (1 << ACIS1) && !output) ||
+          (mode == ((1 << ACIS1) | (1 << ACIS0)) && output))
+      {
+         ACSR |= (1 << ACI);
+      }
+   }
+
+   host_dispatch_interrupts();
+   return;
+}
+
+/********************************************************************************
+* host_serial_receive: Lgger angivna tecken i k fr mottagning via USART.
+*                      Tecknen tas sedan emot ett i taget i takt med vald
+*                      baud rate medan simulerad tid fortskrider, frutsatt
+*                      att mottagning r aktiverad (RXEN0). Tecken som inte
+*                      ryms i kn kastas.
+*
+*                      - data: Pekare till tecknen som ska tas emot.
+*                      - size: Antal tecken.
+********************************************************************************/
+void host_serial_receive(const void* data,
+                         const uint16_t size)
+{
+   const uint8_t* bytes = (const uint8_t*)data;
+
+   for (uint16_t i = 0; i < size && rx_count < HOST_RX_SIZE; ++i)
+   {
+      rx_queue[(rx_head + rx_count++) % HOST_RX_SIZE] = bytes[i];
+   }
+   return;
+}
+
+/********************************************************************************
+* host_serial_pending: Returnerar antalet tecken som nnu inte har tagits
+*                      emot via USART.
+********************************************************************************/
+uint16_t host_serial_pending(void)
+{
+   return rx_count;
+}
+
+/********************************************************************************
+* host_eeprom_data: Returnerar pekare till det simulerade EEPROM-minnet efter
+*                   att eventuell vntande skrivning har slutfrts.
+********************************************************************************/
+uint8_t* host_eeprom_data(void)
+{
+   host_eeprom_update();
+   return eeprom;
+}
+
+/********************************************************************************
+* host_eeprom_read: Returnerar innehllet p angiven adress i det simulerade
+*                   EEPROM-minnet utan att pverka registren.
+*
+*                   - address: Adressen som ska lsas av.
+********************************************************************************/
+uint8_t host_eeprom_read(const uint16_t address)
+{
+   host_eeprom_update();
+   return address <= EEPROM_ADDRESS_MAX ? eeprom[address] : 0;
+}
+
+/********************************************************************************
+* host_eeprom_write_count: Returnerar antalet fysiska skrivningar som har
+*                          genomfrts p angiven adress i EEPROM-minnet.
+*
+*                          - address: Adressen vars skrivningar efterfrgas.
+********************************************************************************/
+uint32_t host_eeprom_write_count(const uint16_t address)
+{
+   host_eeprom_update();
+   return address <= EEPROM_ADDRESS_MAX ? eeprom_writes[address] : 0;
+}
+
+/********************************************************************************
+* host_eeprom_update: Slutfr eventuell vntande lsning eller skrivning av
+*                     EEPROM-minnet. Vid skrivning anvnds programmeringslget
+*                     som anges av bitarna EEPM1:0 (radering och skrivning,
+*                     enbart radering eller enbart skrivning).
+********************************************************************************/
+static void host_eeprom_update(void)
+{
+   if (!eeprom_erased)
+   {
+      memset(eeprom, 0xFF, sizeof(eeprom));
+      eeprom_erased = true;
+   }
+
+   const uint16_t address = EEAR & EEPROM_ADDRESS_MAX;
+
+   if (eecr & (1 << EEPE))
+   {
+      const uint8_t mode = (eecr >> EEPM0) & 0x03;
+
+      if (mode == 0x01)      eeprom[address] = 0xFF;
+      else if (mode == 0x02) eeprom[address] &= eedr;
+      else                   eeprom[address] = eedr;
+
+      eeprom_writes[address]++;
+      eecr &= ~((1 << EEPE) | (1 << EEMPE));
+   }
+
+   if (eecr & (1 << EERE))
+   {
+      eedr = eeprom[address];
+      eecr &= ~(1 << EERE);
+   }
+   return;
+}
+
+/********************************************************************************
+* host_uart_flush: Skriver ut eventuellt tecken i dataregistret fr seriell
+*                  verfring till stdout, frutsatt att sndaren r aktiverad.
+********************************************************************************/
+static void host_uart_flush(void)
+{
+   if (udr0_pending)
+   {
+      udr0_pending = false;
+
+      if (UCSR0B & (1 << TXEN0))
+      {
+         putchar(udr0);
+         fflush(stdout);
+      }
+   }
+   return;
+}
+
+/********************************************************************************
+* host_uart_receive: Tar emot nsta tecken i kn nr tiden fr ett helt
+*                    tecken har passerat vid aktuell baud rate, dr varje
+*                    tecken bestr av HOST_UART_FRAME bitar. Hgst ett tecken
+*                    tas emot per steg. Om fregende tecken inte har lsts
+*                    ut stts flaggan DOR0 (overrun), varvid det nya tecknet
+*                    kastas, precis som p mikrodatorn.
+*
+*                    - step_cycles: Antalet simulerade klockcykler.
+********************************************************************************/
+static void host_uart_receive(const uint32_t step_cycles)
+{
+   const uint32_t bit_cycles = ((ucsr0a & (1 << U2X0)) ? 8UL : 16UL) * (UBRR0 + 1UL);
+   const uint32_t frame_cycles = bit_cycles * HOST_UART_FRAME;
+
+   if (!(UCSR0B & (1 << RXEN0)) || !rx_count)
+   {
+      rx_cycles = 0;
+      return;
+   }
+
+   rx_cycles += step_cycles;
+   if (rx_cycles < frame_cycles) return;
+   rx_cycles = rx_cycles - frame_cycles < frame_cycles ? rx_cycles - frame_cycles : 0;
+
+   const uint8_t data = rx_queue[rx_head];
+   rx_head = (rx_head + 1) % HOST_RX_SIZE;
+   rx_count--;
+
+   if (rx_full)
+   {
+      rx_overrun = true;
+   }
+   else
+   {
+      rx_data = data;
+      rx_full = true;
+   }
+   return;
+}
+
+/********************************************************************************
+* host_step: Simulerar angivet antal klockcykler fr samtliga timerkretsar och
+*            genererar drefter eventuella vntande avbrott.
+*
+*            Timer 0 samt Timer 2 simuleras i Normal Mode eller CTC Mode
+*            (WGMn1 satt i TCCRnA), medan Timer 1 simuleras i Normal Mode
+*            eller CTC Mode (WGM12 satt i TCCR1B).
+*
+*            - step_cycles: Antalet klockcykler som ska simuleras.
+********************************************************************************/
+static void host_step(const uint32_t step_cycles)
+{
+   uint32_t ticks;
+
+   total_cycles += step_cycles;
+   host_eeprom_update();
+   host_uart_flush();
+   host_uart_receive(step_cycles);
+
+   ticks = host_timer_ticks(&timers[0], host_timer_prescaler(0, TCCR0B), step_cycles);
+   while (ticks--)
+   {
+      const bool ctc = TCCR0A & (1 << WGM01);
+      if (ctc && TCNT0 == OCR0A) TCNT0 = 0;
+      else if (++TCNT0 == 0) TIFR0 |= (1 << TOV0);
+      if (TCNT0 == OCR0A) TIFR0 |= (1 << OCF0A);
+      if (TCNT0 == OCR0B) TIFR0 |= (1 << OCF0B);
+   }
+
+   ticks = host_timer_ticks(&timers[1], host_timer_prescaler(1, TCCR1B), step_cycles);
+   while (ticks--)
+   {
+      const bool ctc = TCCR1B & (1 << WGM12);
+      if (ctc && TCNT1 == OCR1A) TCNT1 = 0;
+      else if (++TCNT1 == 0) TIFR1 |= (1 << TOV1);
+      if (TCNT1 == OCR1A) TIFR1 |= (1 << OCF1A);
+      if (TCNT1 == OCR1B) TIFR1 |= (1 << OCF1B);
+   }
+
+   ticks = host_timer_ticks(&timers[2], host_timer_prescaler(2, TCCR2B), step_cycles);
+   while (ticks--)
+   {
+      const bool ctc = TCCR2A & (1 << WGM21);
+      if (ctc && TCNT2 == OCR2A) TCNT2 = 0;
+      else if (++TCNT2 == 0) TIFR2 |= (1 << TOV2);
+      if (TCNT2 == OCR2A) TIFR2 |= (1 << OCF2A);
+      if (TCNT2 == OCR2B) TIFR2 |= (1 << OCF2B);
+   }
+
+   host_dispatch_interrupts();
+   return;
+}
+
+/********************************************************************************
+* host_dispatch_interrupts: Anropar avbrottsrutinerna fr samtliga vntande
+*                           avbrott i prioritetsordning (lgst vektornummer
+*                           frst), frutsatt att avbrott r globalt aktiverade.
+*                           Under avbrottsrutinen r avbrott inaktiverade,
+*                           precis som p mikrodatorn.
+********************************************************************************/
+static void host_dispatch_interrupts(void)
+{
+   for (uint8_t vector = 1; vector < HOST_VECTOR_COUNT; ++vector)
+   {
+      if (!(SREG & (1 << SREG_I))) return;
+
+      if (isr_table[vector] && host_interrupt_pending(vector))
+      {
+         const uint8_t previous_vector = active_vector;
+         isr_counter[vector]++;
+         isr_total++;
+         SREG &= ~(1 << SREG_I);
+         active_vector = vector;
+         isr_table[vector]();
+         active_vector = previous_vector;
+         SREG |= (1 << SREG_I);
+         vector = 0;
+      }
+   }
+   return;
+}
+
+/********************************************************************************
+* host_sleep: Simulerar vila i sleep mode tills en avbrottsrutin har anropats.
+*             Ett redan vntande avbrott vcker processorn direkt, precis som
+*             p mikrodatorn. Annars fortskrider simulerad tid i steg om
+*             HOST_STEP_CYCLES klockcykler, dock hgst HOST_SLEEP_MAX
+*             klockcykler ifall inget avbrott r aktiverat.
+********************************************************************************/
+static void host_sleep(void)
+{
+   const uint32_t before = isr_total;
+   uint32_t slept = 0;
+
+   host_dispatch_interrupts();
+
+   while (isr_total == before && slept < HOST_SLEEP_MAX)
+   {
+      host_run_cycles(HOST_STEP_CYCLES);
+      slept += HOST_STEP_CYCLES;
+   }
+   return;
+}
+
+/********************************************************************************
+* host_interrupt_pending: Indikerar ifall angiven avbrottsvektor r aktiverad
+*                         och har ett vntande avbrott. Fr flaggbaserade
+*                         avbrott nollstlls flaggan, precis som nr
+*                         avbrottsrutinen anropas p mikrodatorn.
+*
+*                         - vector: Avbrottsvektorns nummer.
+********************************************************************************/
+static bool host_interrupt_pending(const uint8_t vector)
+{
+   volatile uint8_t* flags = 0;
+   uint8_t mask = 0;
+   uint8_t bit = 0;
+
+   switch (vector)
+   {
+      case PCINT0_vect_num:       flags = &PCIFR; mask = PCICR;  bit = PCIF0;  break;
+      case PCINT1_vect_num:       flags = &PCIFR; mask = PCICR;  bit = PCIF1;  break;
+      case PCINT2_vect_num:       flags = &PCIFR; mask = PCICR;  bit = PCIF2;  break;
+      case TIMER2_COMPA_vect_num: flags = &TIFR2; mask = TIMSK2; bit = OCF2A;  break;
+      case TIMER2_COMPB_vect_num: flags = &TIFR2; mask = TIMSK2; bit = OCF2B;  break;
+      case TIMER2_OVF_vect_num:   flags = &TIFR2; mask = TIMSK2; bit = TOV2;   break;
+      case TIMER1_COMPA_vect_num: flags = &TIFR1; mask = TIMSK1; bit = OCF1A;  break;
+      case TIMER1_COMPB_vect_num: flags = &TIFR1; mask = TIMSK1; bit = OCF1B;  break;
+      case TIMER1_OVF_vect_num:   flags = &TIFR1; mask = TIMSK1; bit = TOV1;   break;
+      case TIMER0_COMPA_vect_num: flags = &TIFR0; mask = TIMSK0; bit = OCF0A;  break;
+      case TIMER0_COMPB_vect_num: flags = &TIFR0; mask = TIMSK0; bit = OCF0B;  break;
+      case TIMER0_OVF_vect_num:   flags = &TIFR0; mask = TIMSK0; bit = TOV0;   break;
+      case USART_RX_vect_num:
+         return (UCSR0B & (1 << RXCIE0)) && rx_full;
+      case USART_UDRE_vect_num:
+         return UCSR0B & (1 << UDRIE0);
+      case EE_READY_vect_num:
+         host_eeprom_update();
+         return (eecr & (1 << EERIE)) && !(eecr & (1 << EEPE));
+      case ANALOG_COMP_vect_num:
+         if (!(ACSR & (1 << ACIE)) || !(ACSR & (1 << ACI))) return false;
+         ACSR &= ~(1 << ACI);
+         return true;
+      default:
+         return false;
+   }
+
+   if ((mask & (1 << bit)) && (*flags & (1 << bit)))
+   {
+      *flags &= ~(1 << bit);
+      return true;
+   }
+   return false;
+}
+
+/********************************************************************************
+* host_timer_prescaler: Returnerar prescalern fr angiven timerkrets utifrn
+*                       klockvalsbitarna CSn2:0. Vid stoppad timer eller extern
+*                       klocka returneras 0.
+*
+*                       - timer_sel: Timerkretsens nummer (0 - 2).
+*                       - tccrb    : Innehllet i timerkretsens register TCCRnB.
+********************************************************************************/
+static uint16_t host_timer_prescaler(const uint8_t timer_sel, const uint8_t tccrb)
+{
+   static const uint16_t prescalers_01[8] = { 0, 1, 8, 64, 256, 1024, 0, 0 };
+   static const uint16_t prescalers_2[8] = { 0, 1, 8, 32, 64, 128, 256, 1024 };
+   const uint8_t clock_select = tccrb & 0x07;
+   return timer_sel == 2 ? prescalers_2[clock_select] : prescalers_01[clock_select];
+}
+
+/********************************************************************************
+* host_timer_ticks: Returnerar antalet upprkningar av angiven timerkrets under
+*                   angivet antal klockcykler. Klockcykler som inte rcker till
+*                   en hel upprkning sparas till nsta steg.
+*
+*                   - self       : Pekare till den simulerade timerkretsen.
+*                   - prescaler  : Timerkretsens prescaler (0 = stoppad).
+*                   - step_cycles: Antalet simulerade klockcykler.
+********************************************************************************/
+static uint32_t host_timer_ticks(struct host_timer* self, const uint16_t prescaler,
+                                 const uint32_t step_cycles)
+{
+   if (!prescaler)
+   {
+      self->prescaler_cycles = 0;
+      return 0;
+   }
+
+   self->prescaler_cycles += step_cycles;
+   const uint32_t ticks = self->prescaler_cycles / prescaler;
+   self->prescaler_cycles -= ticks * prescaler;
+   return ticks;
+}
+
+#endif /* HOST_BUILD */
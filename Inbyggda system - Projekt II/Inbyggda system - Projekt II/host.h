@@ -0,0 +1,469 @@
+/********************************************************************************
+* host.h: Innehller ett simulerat registerlager fr ATmega328P, som gr det
+*         mjligt att kompilera samt kra drivrutinerna ofrndrade p en
+*         Linux-dator (host build). Registren implementeras som globala
+*         variabler, medan avbrottsrutiner definierade via makrot ISR
+*         registreras i en simulerad avbrottsvektortabell.
+*
+*         Host build aktiveras via makrot HOST_BUILD, exempelvis:
+*
+*         gcc -std=gnu99 -O2 -DHOST_BUILD -o firmware *.c
+*
+*         Simulerad tid fortskrider via funktionen host_run_cycles, som
+*         rknar upp timerkretsarna med aktuell prescaler och genererar
+*         avbrott i samma prioritetsordning som p mikrodatorn. Frdrjnings-
+*         rutinerna _delay_ms samt _delay_us lter tiden fortskrida p samma
+*         stt. Varje WDR-instruktion samt varje SLEEP-instruktion med sleep
+*         mode avstngt motsvarar ett varv i huvudloopen, vilket gr att
+*         firmware med en ren pollningsloop ocks gr att kra, medan
+*         instruktionen SLEEP med sleep mode aktiverat lter tiden fortskrida
+*         tills nsta avbrott.
+*
+*         Fr beteende- och prestandatester lnkas samtliga kllfiler utom
+*         main.c mot testprogrammet, som sedan anropar drivrutinerna direkt
+*         samt styr tiden och insignalerna via funktionerna nedan. Samtliga
+*         testprogram i katalogen tools kompileras samt krs via make
+*         host-test frn projektets rotkatalog, se Makefile.
+********************************************************************************/
+#ifndef HOST_H_
+#define HOST_H_
+
+/* Inkluderingsdirektiv: */
+#include <stdbool.h>
+#include <stdint.h>
+
+/********************************************************************************
+* Simulerade I/O-register (8 bitar):
+********************************************************************************/
+extern volatile uint8_t PINB, DDRB, PORTB;
+extern volatile uint8_t PINC, DDRC, PORTC;
+extern volatile uint8_t PIND, DDRD, PORTD;
+
+extern volatile uint8_t PCICR, PCIFR, PCMSK0, PCMSK1, PCMSK2;
+
+extern volatile uint8_t TCCR0A, TCCR0B, TCNT0, OCR0A, OCR0B, TIMSK0, TIFR0;
+extern volatile uint8_t TCCR1A, TCCR1B, TCCR1C, TIMSK1, TIFR1;
+extern volatile uint8_t TCCR2A, TCCR2B, TCNT2, OCR2A, OCR2B, TIMSK2, TIFR2;
+
+extern volatile uint8_t UCSR0B, UCSR0C;
+extern volatile uint8_t ACSR, ADCSRA, ADCSRB, ADMUX, DIDR0, DIDR1;
+extern volatile uint8_t WDTCSR, MCUSR, SREG;
+extern volatile uint8_t PRR, SMCR;
+
+/********************************************************************************
+* Simulerade I/O-register (16 bitar):
+********************************************************************************/
+extern volatile uint16_t TCNT1, OCR1A, OCR1B, ICR1;
+extern volatile uint16_t EEAR, UBRR0;
+extern volatile uint16_t SP;
+
+/********************************************************************************
+* Simulerat RAM-minne: Adresserna RAMSTART - RAMEND motsvarar RAM-minnet p
+* mikrodatorn, dr host_data_end anger slutet p statiska variabler (.data
+* samt .bss) och SP anger stackpekaren. Drivrutinerna krs med vrddatorns
+* egen stack, varfr det simulerade RAM-minnet enbart anvnds av stack.h,
+* dr testprogrammet styr stackpekaren och minnets innehll direkt.
+********************************************************************************/
+#define RAMSTART 0x100
+#define RAMEND   0x8FF
+
+extern uint8_t host_ram[RAMEND + 1];
+extern uint16_t host_data_end;
+
+#define STACK_RAM(address) host_ram[address]
+#define STACK_DATA_END     host_data_end
+
+/********************************************************************************
+* Register med sidoeffekter: tkomst sker via funktioner som frst slutfr
+* eventuell vntande EEPROM-operation respektive seriell verfring, s att
+* drivrutinernas ordinarie ls- och skrivsekvenser fungerar ofrndrade.
+********************************************************************************/
+#define EECR (*host_eecr())
+#define EEDR (*host_eedr())
+#define UCSR0A (*host_ucsr0a())
+#define UDR0 (*host_udr0())
+
+volatile uint8_t* host_eecr(void);
+volatile uint8_t* host_eedr(void);
+volatile uint8_t* host_ucsr0a(void);
+volatile uint8_t* host_udr0(void);
+
+/********************************************************************************
+* Bitar i I/O-portarnas register:
+********************************************************************************/
+#define PORTB0 0
+#define PORTB1 1
+#define PORTB2 2
+#define PORTB3 3
+#define PORTB4 4
+#define PORTB5 5
+#define PORTB6 6
+#define PORTB7 7
+
+#define PORTC0 0
+#define PORTC1 1
+#define PORTC2 2
+#define PORTC3 3
+#define PORTC4 4
+#define PORTC5 5
+#define PORTC6 6
+
+#define PORTD0 0
+#define PORTD1 1
+#define PORTD2 2
+#define PORTD3 3
+#define PORTD4 4
+#define PORTD5 5
+#define PORTD6 6
+#define PORTD7 7
+
+/********************************************************************************
+* Bitar fr PCI-avbrott:
+********************************************************************************/
+#define PCIE0 0
+#define PCIE1 1
+#define PCIE2 2
+
+#define PCIF0 0
+#define PCIF1 1
+#define PCIF2 2
+
+#define PCINT0 0
+#define PCINT1 1
+#define PCINT2 2
+#define PCINT3 3
+#define PCINT4 4
+#define PCINT5 5
+#define PCINT6 6
+#define PCINT7 7
+
+/********************************************************************************
+* Bitar fr timerkretsarna:
+********************************************************************************/
+#define WGM00 0
+#define WGM01 1
+#define CS00 0
+#define CS01 1
+#define CS02 2
+#define WGM02 3
+#define TOIE0 0
+#define OCIE0A 1
+#define OCIE0B 2
+#define TOV0 0
+#define OCF0A 1
+#define OCF0B 2
+
+#define WGM10 0
+#define WGM11 1
+#define CS10 0
+#define CS11 1
+#define CS12 2
+#define WGM12 3
+#define WGM13 4
+#define TOIE1 0
+#define OCIE1A 1
+#define OCIE1B 2
+#define ICIE1 5
+#define TOV1 0
+#define OCF1A 1
+#define OCF1B 2
+
+#define WGM20 0
+#define WGM21 1
+#define CS20 0
+#define CS21 1
+#define CS22 2
+#define WGM22 3
+#define TOIE2 0
+#define OCIE2A 1
+#define OCIE2B 2
+#define TOV2 0
+#define OCF2A 1
+#define OCF2B 2
+
+/********************************************************************************
+* Bitar fr EEPROM-minnet:
+********************************************************************************/
+#define EERE 0
+#define EEPE 1
+#define EEMPE 2
+#define EERIE 3
+#define EEPM0 4
+#define EEPM1 5
+
+/********************************************************************************
+* Bitar fr USART:
+********************************************************************************/
+#define MPCM0 0
+#define U2X0 1
+#define UPE0 2
+#define DOR0 3
+#define FE0 4
+#define UDRE0 5
+#define TXC0 6
+#define RXC0 7
+
+#define TXB80 0
+#define RXB80 1
+#define UCSZ02 2
+#define TXEN0 3
+#define RXEN0 4
+#define UDRIE0 5
+#define TXCIE0 6
+#define RXCIE0 7
+
+#define UCPOL0 0
+#define UCSZ00 1
+#define UCSZ01 2
+#define USBS0 3
+#define UPM00 4
+#define UPM01 5
+#define UMSEL00 6
+#define UMSEL01 7
+
+/********************************************************************************
+* Bitar fr den analoga komparatorn samt AD-omvandlaren:
+********************************************************************************/
+#define ACIS0 0
+#define ACIS1 1
+#define ACIC 2
+#define ACIE 3
+#define ACI 4
+#define ACO 5
+#define ACBG 6
+#define ACD 7
+
+#define ADPS0 0
+#define ADPS1 1
+#define ADPS2 2
+#define ADIE 3
+#define ADIF 4
+#define ADATE 5
+#define ADSC 6
+#define ADEN 7
+
+#define ACME 6
+
+#define MUX0 0
+#define MUX1 1
+#define MUX2 2
+#define MUX3 3
+#define ADLAR 5
+#define REFS0 6
+#define REFS1 7
+
+#define ADC0D 0
+#define ADC1D 1
+#define ADC2D 2
+#define ADC3D 3
+#define ADC4D 4
+#define ADC5D 5
+
+#define AIN0D 0
+#define AIN1D 1
+
+/********************************************************************************
+* Bitar fr Watchdog-timern samt statusregistret:
+********************************************************************************/
+#define WDP0 0
+#define WDP1 1
+#define WDP2 2
+#define WDE 3
+#define WDCE 4
+#define WDP3 5
+#define WDIE 6
+#define WDIF 7
+
+#define PORF 0
+#define EXTRF 1
+#define BORF 2
+#define WDRF 3
+
+#define SREG_I 7
+
+/********************************************************************************
+* Bitar fr strmsparregistret samt sleep mode:
+********************************************************************************/
+#define PRADC 0
+#define PRUSART0 1
+#define PRSPI 2
+#define PRTIM1 3
+#define PRTIM0 5
+#define PRTIM2 6
+#define PRTWI 7
+
+#define SE 0
+#define SM0 1
+#define SM1 2
+#define SM2 3
+
+/********************************************************************************
+* Avbrottsvektorer (samma numrering som i ATmega328P:s vektortabell):
+********************************************************************************/
+#define INT0_vect_num          1
+#define INT1_vect_num          2
+#define PCINT0_vect_num        3
+#define PCINT1_vect_num        4
+#define PCINT2_vect_num        5
+#define WDT_vect_num           6
+#define TIMER2_COMPA_vect_num  7
+#define TIMER2_COMPB_vect_num  8
+#define TIMER2_OVF_vect_num    9
+#define TIMER1_CAPT_vect_num   10
+#define TIMER1_COMPA_vect_num  11
+#define TIMER1_COMPB_vect_num  12
+#define TIMER1_OVF_vect_num    13
+#define TIMER0_COMPA_vect_num  14
+#define TIMER0_COMPB_vect_num  15
+#define TIMER0_OVF_vect_num    16
+#define SPI_STC_vect_num       17
+#define USART_RX_vect_num      18
+#define USART_UDRE_vect_num    19
+#define USART_TX_vect_num      20
+#define ADC_vect_num           21
+#define EE_READY_vect_num      22
+#define ANALOG_COMP_vect_num   23
+#define TWI_vect_num           24
+#define SPM_READY_vect_num     25
+
+#define HOST_VECTOR_COUNT      26 /* Antal avbrottsvektorer inklusive reset. */
+
+/********************************************************************************
+* ISR: Definierar en avbrottsrutin, som registreras i den simulerade
+*      avbrottsvektortabellen innan main anropas.
+********************************************************************************/
+#define ISR(vector, ...)                                                 \
+   void vector(void);                                                    \
+   static void __attribute__((constructor)) vector##_host_register(void) \
+   {                                                                     \
+      host_register_isr(vector##_num, vector);                           \
+   }                                                                     \
+   void vector(void)
+
+/********************************************************************************
+* Maskininstruktioner: Instruktionerna CLI, SEI, WDR samt SLEEP tolkas av
+*                     funktionen host_asm, s att inline-assembler i
+*                     drivrutinerna kan kompileras ofrndrad.
+********************************************************************************/
+#define asm(instruction) host_asm(instruction)
+#define cli() host_asm("CLI")
+#define sei() host_asm("SEI")
+
+/********************************************************************************
+* Programminne: Data i programminnet lagras som vanliga konstanter.
+********************************************************************************/
+#define PROGMEM
+#define pgm_read_byte(address) (*(const uint8_t*)(address))
+#define pgm_read_word(address) (*(const uint16_t*)(address))
+#define pgm_read_dword(address) (*(const uint32_t*)(address))
+
+/********************************************************************************
+* Frdrjningsrutiner: Lter simulerad tid fortskrida i stllet fr att vnta.
+********************************************************************************/
+#define _delay_ms(delay_time_ms) host_run_cycles((uint32_t)((delay_time_ms) * (F_CPU / 1000.0)))
+#define _delay_us(delay_time_us) host_run_cycles((uint32_t)((delay_time_us) * (F_CPU / 1000000.0)))
+
+/********************************************************************************
+* host_asm: Simulerar angiven maskininstruktion. Instruktioner som saknar
+*           motsvarighet i simuleringen ignoreras. Sekvensen SEI fljt av
+*           SLEEP tolkas som en enhet, d avbrott inte kan intrffa mellan
+*           instruktionerna p mikrodatorn.
+*
+*           - instruction: Instruktionen som ska simuleras, exempelvis "CLI".
+********************************************************************************/
+void host_asm(const char* instruction);
+
+/********************************************************************************
+* host_register_isr: Registrerar avbrottsrutin fr angiven avbrottsvektor.
+*
+*                    - vector : Avbrottsvektorns nummer.
+*                    - handler: Pekare till avbrottsrutinen.
+********************************************************************************/
+void host_register_isr(const uint8_t vector,
+                       void (*handler)(void));
+
+/********************************************************************************
+* host_run_cycles: Lter simulerad tid fortskrida angivet antal klockcykler.
+*                  Timerkretsarna rknas upp och vntande avbrott genereras
+*                  lpande, frutsatt att avbrott r globalt aktiverade.
+*
+*                  - cycles: Antalet klockcykler som ska simuleras.
+********************************************************************************/
+void host_run_cycles(const uint32_t cycles);
+
+/********************************************************************************
+* host_cycles: Returnerar det totala antalet simulerade klockcykler.
+********************************************************************************/
+uint64_t host_cycles(void);
+
+/********************************************************************************
+* host_isr_count: Returnerar antalet gnger angiven avbrottsrutin har anropats.
+*
+*                 - vector: Avbrottsvektorns nummer.
+********************************************************************************/
+uint32_t host_isr_count(const uint8_t vector);
+
+/********************************************************************************
+* host_set_pin: Stter insignalen p angiven pin och flaggar PCI-avbrott ifall
+*               detta r aktiverat fr aktuell pin. Samma pin-nummer som fr
+*               Arduino Uno anvnds, exempelvis 13 eller B5 fr PORTB5.
+*
+*               - pin  : Pin-numret som insignalen ska sttas p.
+*               - level: Insignalens nya logiska niv.
+********************************************************************************/
+void host_set_pin(const uint8_t pin,
+                  const bool level);
+
+/********************************************************************************
+* host_set_analog_comparator: Stter den analoga komparatorns utsignal ACO och
+*                             flaggar avbrott ifall flanken matchar vald
+*                             avbrottsmod (ACIS1:0). Anvnds fr att simulera
+*                             att matningsspnningen passerar trskeln fr
+*                             strmavbrott, se power.h.
+*
+*                             - output: Komparatorns nya utsignal.
+********************************************************************************/
+void host_set_analog_comparator(const bool output);
+
+/********************************************************************************
+* host_serial_receive: Lgger angivna tecken i k fr mottagning via USART.
+*                      Tecknen tas sedan emot ett i taget i takt med vald
+*                      baud rate medan simulerad tid fortskrider, frutsatt
+*                      att mottagning r aktiverad.
+*
+*                      - data: Pekare till tecknen som ska tas emot.
+*                      - size: Antal tecken.
+********************************************************************************/
+void host_serial_receive(const void* data,
+                         const uint16_t size);
+
+/********************************************************************************
+* host_serial_pending: Returnerar antalet tecken som nnu inte har tagits
+*                      emot via USART.
+********************************************************************************/
+uint16_t host_serial_pending(void);
+
+/********************************************************************************
+* host_eeprom_data: Returnerar pekare till det simulerade EEPROM-minnet, s
+*                   att dess innehll kan sparas samt terstllas mellan
+*                   simulerade omstarter.
+********************************************************************************/
+uint8_t* host_eeprom_data(void);
+
+/********************************************************************************
+* host_eeprom_read: Returnerar innehllet p angiven adress i det simulerade
+*                   EEPROM-minnet utan att pverka registren.
+*
+*                   - address: Adressen som ska lsas av.
+********************************************************************************/
+uint8_t host_eeprom_read(const uint16_t address);
+
+/********************************************************************************
+* host_eeprom_write_count: Returnerar antalet fysiska skrivningar som har
+*                          genomfrts p angiven adress i EEPROM-minnet.
+*
+*                          - address: Adressen vars skrivningar efterfrgas.
+********************************************************************************/
+uint32_t host_eeprom_write_count(const uint16_t address);
+
+#endif /* HOST_H_ */
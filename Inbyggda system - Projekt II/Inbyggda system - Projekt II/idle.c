@@ -0,0 +1,231 @@
+/********************************************************************************
+* idle.c: Innehller funktionsdefinitioner fr vilolget i huvudloopen,
+*         matningen av Watchdog-timern samt mtningen av tid i vilolge.
+********************************************************************************/
+#include "idle.h"
+
+/* Makrodefinitioner: */
+#define IDLE_STATS_PERIOD_TICKS ((uint32_t)IDLE_STATS_PERIOD_MS * SOFT_TIMER_TICKS_PER_MS) /* Period mtt i tick. */
+#define IDLE_FULL_SCALE         1000                                                      /* 100 % mtt i tiondels procent. */
+
+/********************************************************************************
+* Statiska variabler:
+*
+*   - tick_timer   : Mjukvarutimer som stter tick-flaggan fr matning av
+*                    Watchdog-timern.
+*   - tick         : Indikerar att Watchdog-timern ska matas vid nsta varv
+*                    i huvudloopen. Stts av tick_timer.
+*   - sleep_enabled: Indikerar ifall vilolget r aktiverat.
+*
+*   - asleep_time  : Total tid i vilolge sedan start mtt i tick.
+*   - wakes        : Antal uppvaknanden under pgende period.
+*   - period_start : Tidpunkt d pgende period startade mtt i tick.
+*   - period_asleep: Total tid i vilolge nr pgende period startade.
+*   - residency    : Andel tid i vilolge under fregende period mtt i
+*                    tiondels procent.
+*   - wakes_last   : Antal uppvaknanden under fregende period.
+********************************************************************************/
+static struct soft_timer tick_timer;
+static volatile bool tick = false;
+static bool sleep_enabled = IDLE_SLEEP_ENABLED;
+
+static uint32_t asleep_time = 0;
+static uint32_t wakes = 0;
+static uint32_t period_start = 0;
+static uint32_t period_asleep = 0;
+static uint16_t residency = 0;
+static uint32_t wakes_last = 0;
+
+/********************************************************************************
+* Statiska funktioner:
+********************************************************************************/
+static void idle_tick(void);
+static void idle_sleep(void);
+static void idle_update_stats(void);
+
+/********************************************************************************
+* idle_init: Stnger av oanvnda kringkretsar via PRR och startar mjukvaru-
+*            timern fr matning av Watchdog-timern.
+********************************************************************************/
+void idle_init(void)
+{
+   PRR |= IDLE_PRR_UNUSED;
+   soft_timer_init(&tick_timer, IDLE_WDT_TICK_MS, idle_tick);
+   soft_timer_start(&tick_timer);
+   period_start = soft_timer_time();
+   return;
+}
+
+/********************************************************************************
+* idle_run: Matar Watchdog-timern ifall tick-flaggan r satt och lter drefter
+*           processorn sova tills nsta avbrott ifall vilolget r aktiverat.
+*           Slutligen uppdateras mtningen av tid i vilolge nr perioden
+*           IDLE_STATS_PERIOD_MS har lpt ut.
+********************************************************************************/
+void idle_run(void)
+{
+   if (tick)
+   {
+      tick = false;
+      wdt_reset();
+   }
+
+   idle_sleep();
+   idle_update_stats();
+   return;
+}
+
+/********************************************************************************
+* idle_sleep_enabled: Indikerar ifall vilolget r aktiverat. Om s r fallet
+*                     returneras true, annars false.
+********************************************************************************/
+bool idle_sleep_enabled(void)
+{
+   return sleep_enabled;
+}
+
+/********************************************************************************
+* idle_enable_sleep: Aktiverar vilolget.
+********************************************************************************/
+void idle_enable_sleep(void)
+{
+   sleep_enabled = true;
+   return;
+}
+
+/********************************************************************************
+* idle_disable_sleep: Inaktiverar vilolget.
+********************************************************************************/
+void idle_disable_sleep(void)
+{
+   sleep_enabled = false;
+   return;
+}
+
+/********************************************************************************
+* idle_toggle_sleep: Togglar vilolget.
+********************************************************************************/
+void idle_toggle_sleep(void)
+{
+   sleep_enabled = !sleep_enabled;
+   return;
+}
+
+/********************************************************************************
+* idle_asleep_time: Returnerar den totala tiden i vilolge sedan start mtt i
+*                   tick fr Timer 1 (4 us).
+********************************************************************************/
+uint32_t idle_asleep_time(void)
+{
+   return asleep_time;
+}
+
+/********************************************************************************
+* idle_residency: Returnerar andelen tid i vilolge under fregende period
+*                 om IDLE_STATS_PERIOD_MS mtt i tiondels procent (0 - 1000).
+********************************************************************************/
+uint16_t idle_residency(void)
+{
+   return residency;
+}
+
+/********************************************************************************
+* idle_print: Skriver ut ifall vilolget r aktiverat, andelen tid i vilolge
+*             samt antalet uppvaknanden under fregende period via seriell
+*             verfring, exempelvis:
+*
+*             sleep=1 residency=96.4 wakes=1003
+********************************************************************************/
+void idle_print(void)
+{
+   serial_print_string("sleep=");
+   serial_print_unsigned(sleep_enabled);
+   serial_print_string(" residency=");
+   serial_print_unsigned(residency / 10);
+   serial_print_char('.');
+   serial_print_unsigned(residency % 10);
+   serial_print_string(" wakes=");
+   serial_print_unsigned(wakes_last);
+   serial_print_new_line();
+   return;
+}
+
+/********************************************************************************
+* idle_tick: Callback-rutin som anropas av tick_timer med perioden
+*            IDLE_WDT_TICK_MS och stter tick-flaggan.
+********************************************************************************/
+static void idle_tick(void)
+{
+   tick = true;
+   return;
+}
+
+/********************************************************************************
+* idle_sleep: Lter processorn sova i sleep mode IDLE tills nsta avbrott.
+*
+*             1. Avbrott inaktiveras, s att inget avbrott hinner intrffa
+*                mellan tidsstmpeln och instruktionen SLEEP. Om vilolget r
+*                inaktiverat eller avbrott var inaktiverade redan innan
+*                (exempelvis vid kalibreringen av processorlasten, se
+*                cpu_load.h) sker ingen vila, d inget avbrott d kan vcka
+*                processorn. Instruktionen SLEEP krs d med sleep mode
+*                avstngt, vilket saknar effekt p mikrodatorn men motsvarar
+*                ett varv i huvudloopen vid host build, se host.h.
+*
+*             2. Instruktionerna SEI och SLEEP krs direkt efter varandra.
+*                Instruktionen efter SEI krs alltid innan vntande avbrott,
+*                varfr ett avbrott som blev vntande efter att avbrott
+*                inaktiverades vcker processorn direkt i stllet fr att
+*                g frlorat.
+*
+*             3. Efter uppvaknandet, d avbrottsrutinen redan har krts,
+*                inaktiveras avbrott igen, sleep mode stngs av och tiden i
+*                vilolge summeras.
+********************************************************************************/
+static void idle_sleep(void)
+{
+   const uint8_t sreg = atomic_begin();
+
+   if (sleep_enabled && (sreg & (1 << SREG_I)))
+   {
+      const uint32_t start = soft_timer_time();
+      SMCR = (1 << SE);
+      ATOMIC_MEMORY_BARRIER();
+      asm("SEI\n\tSLEEP");
+      atomic_disable();
+      SMCR = 0x00;
+      asleep_time += soft_timer_time() - start;
+      wakes++;
+   }
+   else
+   {
+      asm("SLEEP");
+   }
+
+   atomic_end(sreg);
+   return;
+}
+
+/********************************************************************************
+* idle_update_stats: Berknar andelen tid i vilolge samt antalet uppvaknanden
+*                    fr avslutad period nr perioden IDLE_STATS_PERIOD_MS har
+*                    lpt ut. Andelen berknas med periodens lngd dividerad
+*                    med 1000 som nmnare, s att tljaren inte kan sl om.
+********************************************************************************/
+static void idle_update_stats(void)
+{
+   const uint32_t time = soft_timer_time();
+   const uint32_t elapsed = time - period_start;
+
+   if (elapsed >= IDLE_STATS_PERIOD_TICKS)
+   {
+      const uint32_t asleep = asleep_time - period_asleep;
+      const uint32_t scale = elapsed / IDLE_FULL_SCALE;
+      residency = asleep / scale >= IDLE_FULL_SCALE ? IDLE_FULL_SCALE : (uint16_t)(asleep / scale);
+      wakes_last = wakes;
+      wakes = 0;
+      period_start = time;
+      period_asleep = asleep_time;
+   }
+   return;
+}
@@ -0,0 +1,138 @@
+/********************************************************************************
+* idle.h: Innehller vilolge fr huvudloopen, dr processorn sover i sleep
+*         mode IDLE mellan avbrotten i stllet fr att snurra i huvudloopen,
+*         samt matning av Watchdog-timern frn ett periodiskt tick och
+*         avstngning av oanvnda kringkretsar via registret PRR.
+*
+*         Funktionen idle_run anropas sist i varje varv i huvudloopen. Dr
+*         matas Watchdog-timern ifall ett tick har intrffat sedan fregende
+*         varv, varefter processorn sover tills nsta avbrott. Varje avbrott
+*         vcker processorn, varefter huvudloopen gr ett varv. Eftersom
+*         multiplexningen av 7-segmentsdisplayerna genererar ett avbrott p
+*         Timer 1 varje DISPLAY_DIGIT_TIME_MS gr huvudloopen minst ett varv
+*         per ms, medan mottagna tecken och vriga avbrott vcker processorn
+*         direkt.
+*
+*         Sleep mode IDLE anvnds, d Timer 1 (mjukvarutimers), USART samt
+*         den analoga komparatorn (strmavbrott) mste fortstta att kras.
+*         Power-save, dr enbart Timer 2 krs, r drmed inte mjligt, d
+*         systemets samtliga tidsstyrda funktioner bygger p Timer 1.
+*
+*         Watchdog-timern matas enbart nr tick-flaggan har satts av
+*         mjukvarutimern med perioden IDLE_WDT_TICK_MS och huvudloopen drefter
+*         har gtt ett varv. Drmed sker systemterstllning bde ifall
+*         huvudloopen fastnar och ifall Timer 1 slutar generera avbrott.
+*
+*         Vid start stngs TWI, SPI, Timer 0, Timer 2 samt USART av via PRR,
+*         varefter respektive drivrutin stter p den krets som anvnds
+*         (serial_init samt isr_profile_init). ADC:n lmnas p, d den
+*         analoga komparatorn anvnder ADC:ns multiplexer.
+*
+*         Tiden som processorn sover mts via Timer 1 och summeras per
+*         period om IDLE_STATS_PERIOD_MS, vilket ger andelen tid i vilolge
+*         (sleep residency) samt antalet uppvaknanden under fregende
+*         period. Resultatet skrivs ut via seriell verfring med funktionen
+*         idle_print (kommandot sleep, se command.h), exempelvis:
+*
+*         sleep=1 residency=96.4 wakes=1003
+*
+*         Tiden i vilolge inkluderar avbrottsrutinen som vcker processorn,
+*         vilken krs innan huvudloopen terupptas, varfr residency br
+*         betraktas som en vre grns. Vilolget kan stngas av under drift
+*         via funktionen idle_disable_sleep (kommandot sleep off), varvid
+*         huvudloopen snurrar som tidigare och processorlasten mts via
+*         antalet varv i huvudloopen i stllet, se cpu_load.h.
+*
+*         Vid host build motsvarar instruktionen SLEEP att simulerad tid
+*         fortskrider tills nsta avbrott, se host.h.
+********************************************************************************/
+#ifndef IDLE_H_
+#define IDLE_H_
+
+/* Inkluderingsdirektiv: */
+#include "misc.h"
+#include "serial.h"
+#include "soft_timer.h"
+#include "wdt.h"
+
+/* Makrodefinitioner: */
+#ifndef IDLE_SLEEP_ENABLED
+#define IDLE_SLEEP_ENABLED 1 /* Vilolge aktiverat vid start (1 = aktiverat). */
+#endif
+
+#ifndef IDLE_WDT_TICK_MS
+#define IDLE_WDT_TICK_MS 100 /* Period fr matning av Watchdog-timern mtt i ms. */
+#endif
+
+#ifndef IDLE_STATS_PERIOD_MS
+#define IDLE_STATS_PERIOD_MS 1000 /* Period fr mtning av tid i vilolge mtt i ms. */
+#endif
+
+#if IDLE_STATS_PERIOD_MS < 4
+#error "IDLE_STATS_PERIOD_MS mste vara minst 4 ms!"
+#endif
+
+/********************************************************************************
+* IDLE_PRR_UNUSED: Kringkretsar som stngs av vid start via registret PRR.
+********************************************************************************/
+#define IDLE_PRR_UNUSED ((1 << PRTWI) | (1 << PRSPI) | (1 << PRTIM0) | \
+                         (1 << PRTIM2) | (1 << PRUSART0))
+
+/********************************************************************************
+* idle_init: Stnger av oanvnda kringkretsar via PRR och startar mjukvaru-
+*            timern fr matning av Watchdog-timern. Ska anropas innan vriga
+*            drivrutiner initieras, s att dessa kan stta p sina kretsar.
+********************************************************************************/
+void idle_init(void);
+
+/********************************************************************************
+* idle_run: Matar Watchdog-timern ifall ett tick har intrffat sedan fregende
+*           anrop och lter drefter processorn sova i sleep mode IDLE tills
+*           nsta avbrott, frutsatt att vilolget r aktiverat och avbrott
+*           r aktiverade. Ska anropas sist i varje varv i huvudloopen, ven
+*           nr vilolget r inaktiverat.
+********************************************************************************/
+void idle_run(void);
+
+/********************************************************************************
+* idle_sleep_enabled: Indikerar ifall vilolget r aktiverat. Om s r fallet
+*                     returneras true, annars false.
+********************************************************************************/
+bool idle_sleep_enabled(void);
+
+/********************************************************************************
+* idle_enable_sleep: Aktiverar vilolget, s att processorn sover mellan
+*                    avbrotten.
+********************************************************************************/
+void idle_enable_sleep(void);
+
+/********************************************************************************
+* idle_disable_sleep: Inaktiverar vilolget, s att huvudloopen snurrar.
+********************************************************************************/
+void idle_disable_sleep(void);
+
+/********************************************************************************
+* idle_toggle_sleep: Togglar vilolget.
+********************************************************************************/
+void idle_toggle_sleep(void);
+
+/********************************************************************************
+* idle_asleep_time: Returnerar den totala tiden i vilolge sedan start mtt i
+*                   tick fr Timer 1 (4 us).
+********************************************************************************/
+uint32_t idle_asleep_time(void);
+
+/********************************************************************************
+* idle_residency: Returnerar andelen tid i vilolge under fregende period
+*                 om IDLE_STATS_PERIOD_MS mtt i tiondels procent (0 - 1000).
+********************************************************************************/
+uint16_t idle_residency(void);
+
+/********************************************************************************
+* idle_print: Skriver ut ifall vilolget r aktiverat, andelen tid i vilolge
+*             samt antalet uppvaknanden under fregende period via seriell
+*             verfring.
+********************************************************************************/
+void idle_print(void);
+
+#endif /* IDLE_H_ */
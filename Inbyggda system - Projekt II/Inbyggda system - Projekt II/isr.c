@@ -1,12 +1,16 @@
 /********************************************************************************
-* isr.c: Innehller avbrottsrutiner.
+* isr.c: Innehller avbrottsrutiner. Samtliga avbrottsrutiner rknar sina
+*        anrop fr telemetrin och mter sin exekveringstid ifall ISR_PROFILE
+*        r aktiverad, se isr_profile.h.
 ********************************************************************************/
 #include "header.h"
 
 ISR (PCINT0_vect)
 {
+	ISR_PROFILE_BEGIN();
+	telemetry_count_isr(TELEMETRY_ISR_PCINT0);
 	disable_pin_change_interrupt(IO_PORTB);
-	timer_enable_interrupt(&timer0);              // Stt p avbrott p timer0.
+	soft_timer_start(&debounce_timer);           // Starta avstudsningstimern.
 	
 	if (button_is_pressed(&button1))             // Om BUTTON1 r nedtryckt, toggla display count.
 	{
@@ -20,41 +24,85 @@ ISR (PCINT0_vect)
 	{
 		display_toggle_output();
 	}
+	ISR_PROFILE_END(TELEMETRY_ISR_PCINT0);
 	return;
 }
 
-ISR (TIMER0_OVF_vect)
-{
-	timer_count(&timer0);
-	
-	if(timer_elapsed(&timer0))                   // Nr timer0 har lpt t, teraktivera PCI-avbrott och stng av timern.
-	{
-		timer_disable_interrupt(&timer0);
-		enable_pin_change_interrupt(IO_PORTB);
-	}
-}
-
 /********************************************************************************
-* ISR (TIMER1_COMPA_vect): Avbrottsrutin som ger rum vid upprkning till 256 av
-*                          Timer 1 i CTC Mode, vilket sker var 0.128:e
-*                          millisekund nr timern r aktiverad. En gng per
-*                          millisekund togglas talet utskrivet p 
-*                          7-segmentsdisplayerna mellan tiotal och ental.
+* ISR (TIMER1_COMPA_vect): Avbrottsrutin som ger rum nr Timer 1 nr
+*                          tidpunkten fr nsta utlsning av en mjukvarutimer.
+*                          Callback-rutinerna fr samtliga timers som har lpt
+*                          ut anropas, exempelvis skiftning av 7-segments-
+*                          displayerna, upprkning av talet samt avstudsning
+*                          av tryckknapparna. Antalet anrop samt lngsta
+*                          exekveringstid registreras fr telemetrin.
 ********************************************************************************/
 ISR (TIMER1_COMPA_vect)
 {
-   display_toggle_digit();
+   ISR_PROFILE_BEGIN();
+   const uint16_t start = TCNT1;
+   telemetry_count_isr(TELEMETRY_ISR_TIMER1_COMPA);
+   soft_timer_run();
+   telemetry_time_isr(start);
+   ISR_PROFILE_END(TELEMETRY_ISR_TIMER1_COMPA);
    return;
 }
-
+
 /********************************************************************************
-* ISR (TIMER2_OVF_vect): Avbrottsrutin som ger rum vid upprkning till 256 av
-*                        Timer 2 i Normal Mode, vilket sker var 0.128:e
-*                        millisekund nr timern r aktiverad. En gng per sekund
-*                        inkrementeras talet utskrivet p 7-segmentsdisplayerna.
-********************************************************************************/
-ISR (TIMER2_OVF_vect)
+* ISR (EE_READY_vect): Avbrottsrutin som ger rum nr EEPROM-minnet r redo
+*                      fr nsta skrivning. Nsta vntande skrivning i kn
+*                      pbrjas, s att lagring av instllningar och rknar-
+*                      vrde inte blockerar vriga avbrottsrutiner.
+********************************************************************************/
+ISR (EE_READY_vect)
 {
-   display_count();
-   return;
-}
+   ISR_PROFILE_BEGIN();
+   telemetry_count_isr(TELEMETRY_ISR_EE_READY);
+   eeprom_write_next();
+   ISR_PROFILE_END(TELEMETRY_ISR_EE_READY);
+   return;
+}
+
+/********************************************************************************
+* ISR (ANALOG_COMP_vect): Avbrottsrutin som ger rum nr matningsspnningen
+*                         passerar trskeln fr strmavbrott. Vid strmavbrott
+*                         lagras systemets tillstnd i EEPROM-minnet, medan
+*                         systemet terupptas vid terhmtning.
+********************************************************************************/
+ISR (ANALOG_COMP_vect)
+{
+   ISR_PROFILE_BEGIN();
+   telemetry_count_isr(TELEMETRY_ISR_ANALOG_COMP);
+   power_run();
+   ISR_PROFILE_END(TELEMETRY_ISR_ANALOG_COMP);
+   return;
+}
+
+/********************************************************************************
+* ISR (USART_UDRE_vect): Avbrottsrutin som ger rum nr dataregistret fr
+*                        USART r tomt. Nsta tecken i bufferten fr seriell
+*                        verfring skickas, s att utskrift inte blockerar
+*                        huvudloopen.
+********************************************************************************/
+ISR (USART_UDRE_vect)
+{
+   ISR_PROFILE_BEGIN();
+   telemetry_count_isr(TELEMETRY_ISR_USART_UDRE);
+   serial_transmit_next();
+   ISR_PROFILE_END(TELEMETRY_ISR_USART_UDRE);
+   return;
+}
+
+/********************************************************************************
+* ISR (USART_RX_vect): Avbrottsrutin som ger rum nr ett tecken har tagits
+*                      emot via USART. Tecknet lagras i mottagningsbufferten,
+*                      varefter kommandon tolkas och utfrs frn huvudloopen.
+********************************************************************************/
+ISR (USART_RX_vect)
+{
+   ISR_PROFILE_BEGIN();
+   telemetry_count_isr(TELEMETRY_ISR_USART_RX);
+   serial_receive_next();
+   ISR_PROFILE_END(TELEMETRY_ISR_USART_RX);
+   return;
+}
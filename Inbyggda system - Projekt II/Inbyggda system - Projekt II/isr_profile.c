@@ -0,0 +1,195 @@
+/********************************************************************************
+* isr_profile.c: Innehller funktionsdefinitioner fr mtning av
+*                exekveringstiden fr avbrottsrutinerna.
+********************************************************************************/
+#include "isr_profile.h"
+
+#if ISR_PROFILE
+
+/********************************************************************************
+* isr_profile_names: Namn p avbrottsvektorerna i ordningen enligt enum
+*                    telemetry_isr, lagrade i programminnet.
+********************************************************************************/
+static const char isr_profile_names[TELEMETRY_ISR_COUNT][13] PROGMEM =
+{
+   "pcint0", "timer1_compa", "ee_ready", "analog_comp", "usart_udre", "usart_rx"
+};
+
+/********************************************************************************
+* Statiska variabler:
+*
+*   - histogram : Antal anrop per intervall och avbrottsvektor (mttade).
+*   - max_cycles: Lngsta uppmtta exekveringstid per avbrottsvektor mtt i
+*                 klockcykler.
+*   - max_time  : Tidpunkt fr lngsta exekveringstid per avbrottsvektor
+*                 mtt i tick fr Timer 1 (4 us) sedan start.
+*
+*   Samtliga variabler uppdateras enbart av avbrottsrutinerna och lses
+*   med avbrott inaktiverade.
+********************************************************************************/
+static volatile uint16_t histogram[TELEMETRY_ISR_COUNT][ISR_PROFILE_BINS];
+static volatile uint32_t max_cycles[TELEMETRY_ISR_COUNT];
+static volatile uint32_t max_time[TELEMETRY_ISR_COUNT];
+
+/********************************************************************************
+* Statiska funktioner:
+********************************************************************************/
+static inline uint8_t isr_profile_bin(uint32_t cycles);
+
+/********************************************************************************
+* isr_profile_end: Berknar exekveringstiden sedan angiven tidsstmpel och
+*                  lagrar den i histogrammet fr angiven avbrottsvektor.
+*
+*                  1. Skillnaden p Timer 1 ger en grov tid med en
+*                     noggrannhet p 64 klockcykler, medan skillnaden p
+*                     Timer 0 ger exakt tid modulo 256 klockcykler.
+*
+*                  2. Den grova tiden korrigeras med avvikelsen mot Timer 0,
+*                     tolkad som ett tal mellan -128 och 127, vilket ger
+*                     exakt tid d den grova tiden avviker mindre n 128
+*                     klockcykler.
+*
+*                  3. Motsvarande intervall i histogrammet rknas upp (om
+*                     rknaren inte redan r mttad). Vid ny lngsta tid
+*                     lagras ven tidpunkten.
+*
+*                  - isr  : Avbrottsvektorn som mtningen avser.
+*                  - start: Tidsstmpeln i brjan av avbrottsrutinen.
+********************************************************************************/
+void isr_profile_end(const enum telemetry_isr isr,
+                     const struct isr_profile_stamp* start)
+{
+   const struct isr_profile_stamp stop = isr_profile_begin();
+   const uint32_t coarse = (uint32_t)(uint16_t)(stop.timer1 - start->timer1) * ISR_PROFILE_TIMER1_DIV;
+   const int8_t error = (int8_t)((uint8_t)(stop.timer0 - start->timer0) - (uint8_t)coarse);
+   const uint32_t cycles = coarse + error;
+   volatile uint16_t* bin = &histogram[isr][isr_profile_bin(cycles)];
+
+   if (*bin < UINT16_MAX) (*bin)++;
+
+   if (cycles > max_cycles[isr])
+   {
+      max_cycles[isr] = cycles;
+      max_time[isr] = soft_timer_time();
+   }
+   return;
+}
+
+/********************************************************************************
+* isr_profile_bin: Returnerar intervallet i histogrammet fr angiven tid, det
+*                  vill sga antalet tvpotenser ver 2^ISR_PROFILE_FIRST_BIN
+*                  som tiden nr upp till, begrnsat till sista intervallet.
+*
+*                  - cycles: Exekveringstiden mtt i klockcykler.
+********************************************************************************/
+static inline uint8_t isr_profile_bin(uint32_t cycles)
+{
+   uint8_t bin = 0;
+   cycles >>= ISR_PROFILE_FIRST_BIN;
+
+   while (cycles && bin < ISR_PROFILE_BINS - 1)
+   {
+      cycles >>= 1;
+      bin++;
+   }
+
+   return bin;
+}
+
+#endif /* ISR_PROFILE */
+
+/********************************************************************************
+* isr_profile_init: Stter p Timer 0 via PRR, startar den i Normal Mode utan
+*                   prescaler och nollstller samtliga histogram. Ingen
+*                   tgrd vidtas ifall ISR_PROFILE r inaktiverad.
+********************************************************************************/
+void isr_profile_init(void)
+{
+#if ISR_PROFILE
+   PRR &= ~(1 << PRTIM0);
+   TCCR0A = 0x00;
+   TCCR0B = (1 << CS00);
+   TIMSK0 = 0x00;
+   isr_profile_reset();
+#endif
+   return;
+}
+
+/********************************************************************************
+* isr_profile_reset: Nollstller samtliga histogram samt lngsta uppmtta
+*                    exekveringstider.
+********************************************************************************/
+void isr_profile_reset(void)
+{
+#if ISR_PROFILE
+   const uint8_t sreg = atomic_begin();
+
+   for (uint8_t i = 0; i < TELEMETRY_ISR_COUNT; ++i)
+   {
+      for (uint8_t j = 0; j < ISR_PROFILE_BINS; ++j)
+      {
+         histogram[i][j] = 0;
+      }
+
+      max_cycles[i] = 0;
+      max_time[i] = 0;
+   }
+
+   atomic_end(sreg);
+#endif
+   return;
+}
+
+/********************************************************************************
+* isr_profile_print: Skriver ut histogrammen via seriell verfring, en rad
+*                    per avbrottsvektor. Varje rad kopieras med avbrott
+*                    inaktiverade, s att histogram och lngsta tid avser
+*                    samma tidpunkt, medan utskriften sker med avbrott
+*                    aktiverade.
+********************************************************************************/
+void isr_profile_print(void)
+{
+#if ISR_PROFILE
+   for (uint8_t i = 0; i < TELEMETRY_ISR_COUNT; ++i)
+   {
+      uint16_t bins[ISR_PROFILE_BINS];
+      char c;
+
+      const uint8_t sreg = atomic_begin();
+
+      for (uint8_t j = 0; j < ISR_PROFILE_BINS; ++j)
+      {
+         bins[j] = histogram[i][j];
+      }
+
+      const uint32_t cycles = max_cycles[i];
+      const uint32_t time = max_time[i];
+      atomic_end(sreg);
+
+      serial_print_string("isr=");
+
+      for (const char* name = isr_profile_names[i]; (c = (char)pgm_read_byte(name)); ++name)
+      {
+         serial_print_char(c);
+      }
+
+      serial_print_string(" max=");
+      serial_print_unsigned(cycles);
+      serial_print_string(" at=");
+      serial_print_unsigned(time / SOFT_TIMER_TICKS_PER_MS);
+      serial_print_string(" hist=");
+
+      for (uint8_t j = 0; j < ISR_PROFILE_BINS; ++j)
+      {
+         if (j) serial_print_char(' ');
+         serial_print_unsigned(bins[j]);
+      }
+
+      serial_print_new_line();
+   }
+#else
+   serial_print_string("isr_profile=0");
+   serial_print_new_line();
+#endif
+   return;
+}
@@ -0,0 +1,143 @@
+/********************************************************************************
+* isr_profile.h: Innehller mtning av exekveringstiden fr avbrottsrutinerna
+*                i isr.c, s att det i flt gr att se ifall exempelvis
+*                skrivning till EEPROM-minnet eller hantering av tryck-
+*                knapparna frdrjer multiplexningen av 7-segmentsdisplayerna
+*                (en display per DISPLAY_DIGIT_TIME_MS, det vill sga 16 000
+*                klockcykler som default).
+*
+*                Mtningen aktiveras vid kompilering via -DISR_PROFILE=1,
+*                annars expanderar makrona ISR_PROFILE_BEGIN samt
+*                ISR_PROFILE_END till ingenting och ingen kod eller RAM-minne
+*                tillkommer. Varje avbrottsrutin inleds med ISR_PROFILE_BEGIN
+*                och avslutas med ISR_PROFILE_END, ssom visas nedan:
+*
+*                ISR (EE_READY_vect)
+*                {
+*                   ISR_PROFILE_BEGIN();
+*                   eeprom_write_next();
+*                   ISR_PROFILE_END(TELEMETRY_ISR_EE_READY);
+*                   return;
+*                }
+*
+*                Tidsstmplarna tas frn Timer 0, som krs fritt utan
+*                prescaler och drmed rknar klockcykler, men slr om efter
+*                256 cykler. Timer 1 (prescaler 64, se soft_timer.h) lses
+*                samtidigt, varvid antalet hela varv p Timer 0 erhlls ur
+*                skillnaden p Timer 1. Exekveringstiden mts drmed exakt i
+*                klockcykler upp till drygt fyra miljoner cykler, dr
+*                avbrottsrutinens prolog och epilog (sparande av register)
+*                inte ingr. Timer 0 r drmed reserverad fr mtningen nr
+*                ISR_PROFILE r aktiverad och fr inte konfigureras om av
+*                annan kod, medan Timer 1 gs av mjukvarutimers, se
+*                soft_timer.h, och enbart lses hr.
+*
+*                Fr varje avbrottsvektor lagras ett histogram med log2-
+*                intervall (under 32 cykler, 32 - 63 cykler, 64 - 127 cykler
+*                och s vidare upp till minst 32 768 cykler) med mttade
+*                16-bitars rknare, samt lngsta uppmtta exekveringstid
+*                sedan start och tidpunkten fr denna. Resultatet skrivs ut
+*                via seriell verfring med funktionen isr_profile_print,
+*                exempelvis via kommandot profile, se command.h.
+********************************************************************************/
+#ifndef ISR_PROFILE_H_
+#define ISR_PROFILE_H_
+
+/* Inkluderingsdirektiv: */
+#include "misc.h"
+#include "serial.h"
+#include "soft_timer.h"
+#include "telemetry.h"
+
+/* Makrodefinitioner: */
+#ifndef ISR_PROFILE
+#define ISR_PROFILE 0 /* Aktiverar mtning av avbrottsrutinerna (1 = aktiverad). */
+#endif
+
+#define ISR_PROFILE_BINS       12                                 /* Antal intervall per histogram. */
+#define ISR_PROFILE_FIRST_BIN  5                                  /* Frsta intervallets vre grns (2^5 cykler). */
+#define ISR_PROFILE_TIMER1_DIV SOFT_TIMER_PRESCALER               /* Klockcykler per tick p Timer 1. */
+
+#if ISR_PROFILE
+
+/********************************************************************************
+* isr_profile_stamp: Strukt fr tidsstmpeln i brjan av en avbrottsrutin.
+********************************************************************************/
+struct isr_profile_stamp
+{
+   uint16_t timer1; /* Innehllet i TCNT1. */
+   uint8_t timer0;  /* Innehllet i TCNT0. */
+};
+
+/********************************************************************************
+* ISR_PROFILE_BEGIN: Tar tidsstmpeln i brjan av en avbrottsrutin.
+********************************************************************************/
+#define ISR_PROFILE_BEGIN() \
+   const struct isr_profile_stamp isr_profile_stamp = isr_profile_begin()
+
+/********************************************************************************
+* ISR_PROFILE_END: Registrerar exekveringstiden i slutet av en avbrottsrutin.
+*
+*                  - isr: Avbrottsvektorn som mtningen avser, se enum
+*                         telemetry_isr.
+********************************************************************************/
+#define ISR_PROFILE_END(isr) isr_profile_end(isr, &isr_profile_stamp)
+
+/********************************************************************************
+* isr_profile_begin: Returnerar tidsstmpeln fr Timer 0 samt Timer 1. Ska
+*                    anropas med avbrott inaktiverade via ISR_PROFILE_BEGIN.
+********************************************************************************/
+static inline struct isr_profile_stamp isr_profile_begin(void)
+{
+   struct isr_profile_stamp stamp;
+   stamp.timer0 = TCNT0;
+   stamp.timer1 = TCNT1;
+   return stamp;
+}
+
+/********************************************************************************
+* isr_profile_end: Berknar exekveringstiden sedan angiven tidsstmpel och
+*                  lagrar den i histogrammet fr angiven avbrottsvektor. Ska
+*                  anropas med avbrott inaktiverade via ISR_PROFILE_END.
+*
+*                  - isr  : Avbrottsvektorn som mtningen avser.
+*                  - start: Tidsstmpeln i brjan av avbrottsrutinen.
+********************************************************************************/
+void isr_profile_end(const enum telemetry_isr isr,
+                     const struct isr_profile_stamp* start);
+
+#else
+
+#define ISR_PROFILE_BEGIN()
+#define ISR_PROFILE_END(isr)
+
+#endif /* ISR_PROFILE */
+
+/********************************************************************************
+* isr_profile_init: Startar Timer 0 i Normal Mode utan prescaler och nollstller
+*                   samtliga histogram. Ingen tgrd vidtas ifall ISR_PROFILE
+*                   r inaktiverad.
+********************************************************************************/
+void isr_profile_init(void);
+
+/********************************************************************************
+* isr_profile_reset: Nollstller samtliga histogram samt lngsta uppmtta
+*                    exekveringstider.
+********************************************************************************/
+void isr_profile_reset(void);
+
+/********************************************************************************
+* isr_profile_print: Skriver ut histogrammen via seriell verfring, en rad
+*                    per avbrottsvektor, exempelvis:
+*
+*                    isr=timer1_compa max=412 at=5231 hist=0 0 0 812 4107 ...
+*
+*                    dr max anger lngsta exekveringstid mtt i klockcykler,
+*                    at anger tidpunkten fr denna mtt i ms sedan start och
+*                    hist anger antalet anrop per intervall med brjan p
+*                    intervallet under 32 cykler. Om ISR_PROFILE r inaktiverad
+*                    skrivs enbart isr_profile=0 ut.
+********************************************************************************/
+void isr_profile_print(void);
+
+#endif /* ISR_PROFILE_H_ */
@@ -1,7 +1,7 @@
 /********************************************************************************
 * main.c: Demonstration av inbyggt system innefattande 7-segmentsdisplayer.
-*         Timerkrets Timer 1 anvnds fr att rkna upp befintligt tal p
-*         7-segmentsdisplayerna en gng per sekund.
+*         Mjukvarutimers schemalagda p Timer 1 anvnds fr att rkna upp
+*         befintligt tal p 7-segmentsdisplayerna en gng per sekund.
 ********************************************************************************/
 #include "header.h"
 
@@ -10,23 +10,80 @@
 struct button button1;
 struct button button2;
 struct button button3;
-struct timer timer0;
+struct soft_timer debounce_timer;
+
+/********************************************************************************
+* debounce_timer_elapsed: Callback-rutin som anropas nr avstudsningstimern har
+*                         lpt ut. Timern stoppas och PCI-avbrott p I/O-port
+*                         B teraktiveras.
+********************************************************************************/
+static void debounce_timer_elapsed(void)
+{
+   soft_timer_stop(&debounce_timer);
+   enable_pin_change_interrupt(IO_PORTB);
+   return;
+}
 
+/********************************************************************************
+* power_fail_detected: Callback-rutin som anropas vid strmavbrott. Aktuellt
+*                      tal p 7-segmentsdisplayerna samt eventuellt ndrade
+*                      instllningar lggs i k fr lagring i EEPROM-minnet,
+*                      vilket sedan genomfrs innan matningen frsvinner.
+********************************************************************************/
+static void power_fail_detected(void)
+{
+   display_power_fail();
+   config_commit();
+   return;
+}
+
+/********************************************************************************
+* power_restored: Callback-rutin som anropas nr matningsspnningen har
+*                 terhmtat sig efter ett detekterat strmavbrott.
+********************************************************************************/
+static void power_restored(void)
+{
+   display_power_restore();
+   return;
+}
+
 /********************************************************************************
 * setup: Initierar systemet enligt fljande:
 *
+*        0. Fyller ledigt RAM-minne med ett mnster fr mtning av stackens
+*           strsta djup, se stack.h.
+*
 *        1. Initierar Watchdog-timern med en timeout p 1024 ms. System reset
 *           aktiveras s att systemterstllning sker ifall Watchdog-timern
-*           lper ut.
+*           lper ut. Drefter stngs oanvnda kringkretsar av via PRR och
+*           matningen av Watchdog-timern frn ett periodiskt tick startas,
+*           se idle.h.
+*
+*        2. Laddar speglingen av systemets instllningar frn EEPROM-minnet,
+*           se eeprom.h. Drefter initieras 7-segmentsdisplayerna med
+*           startvrde 0 och upprkning en gng per sekund aktiveras.
+*
+*        3. Initierar detektering av strmavbrott, s att aktuellt tal
+*           enbart lagras i EEPROM-minnet precis innan matningen frsvinner.
+*           Drefter startas mtningen av avbrottsrutinerna ifall
+*           ISR_PROFILE r aktiverad.
 *
-*        2. Initierar 7-segmentsdisplayerna med startvrde 0 och aktiverar
-*           upprkning en gng per sekund.
+*        4. Initierar kommandogrnssnittet samt telemetrin via seriell
+*           verfring ifall seriell konsol r aktiverad, se
+*           SERIAL_CONSOLE_ENABLED.
+*
+*        5. Aktiverar avbrott globalt, vilket enbart sker hr, s att inga
+*           avbrottsrutiner krs innan samtliga drivrutiner har initierats,
+*           se atomic.h.
 ********************************************************************************/
 static inline void setup(void)
 {
+     stack_init();
      wdt_init(WDT_TIMEOUT_1024_MS);
      wdt_enable_system_reset();
+     idle_init();
 
+     eeprom_init();
      display_init();
      display_enable_output();
      
@@ -38,25 +95,58 @@ static inline void setup(void)
      button_enable_interrupt(&button2);
      button_enable_interrupt(&button3);
      
-     timer_init(&timer0, TIMER_SEL_0, 300);
-     
+     soft_timer_init(&debounce_timer, 300, debounce_timer_elapsed);
+     power_init(power_fail_detected, power_restored);
+     isr_profile_init();
+
+#if SERIAL_CONSOLE_ENABLED
+     serial_init(SERIAL_CONSOLE_BAUD);
+     command_init();
+     telemetry_init();
+#endif
      
+     atomic_enable();
      return;
 }
 
 /********************************************************************************
-* main: Initierar systemet vid start. Upprkning sker sedan kontinuerligt
-*       av talet p 7-segmentsdisplayerna en gng per sekund.
+* loop: Utfr ett varv i huvudloopen. ndrade instllningar lagras i EEPROM-
+*       minnet och stackens strsta djup mts, dr ven mottagna kommandon
+*       utfrs och telemetripaket skickas ifall seriell konsol r aktiverad.
+*       Drefter rknas varvet fr mtning av processorlasten, se
+*       cpu_load.h. Slutligen matas Watchdog-timern vid varje tick, varefter
+*       processorn sover tills nsta avbrott, se idle.h.
+********************************************************************************/
+static void loop(void)
+{
+   config_commit();
+   stack_run();
+
+#if SERIAL_CONSOLE_ENABLED
+   command_run();
+   telemetry_run();
+#endif
+
+   cpu_load_run();
+   idle_run();
+   return;
+}
+
+/********************************************************************************
+* main: Initierar systemet vid start och kalibrerar mtningen av processor-
+*       lasten. Upprkning sker sedan kontinuerligt av talet p 7-segments-
+*       displayerna en gng per sekund, medan huvudloopen utfrs en gng
+*       per avbrott.
 ********************************************************************************/
 int main(void)
 {
     setup();
+    cpu_load_calibrate(loop);
    
    while (1)
    {
-      wdt_reset();
+      loop();
    }
 
    return 0;
 }
-
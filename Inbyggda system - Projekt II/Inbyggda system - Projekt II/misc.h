@@ -8,14 +8,20 @@
 /* Klockfrekvens (behvs fr frdrjningsrutiner): */
 #define F_CPU 16000000UL /* 16 MHz. */
 
-/* Inkluderingsdirektiv: */
+/* Inkluderingsdirektiv (simulerade register vid host build, se host.h): */
+#ifdef HOST_BUILD
+#include "host.h"
+#else
 #include <avr/io.h>
 #include <avr/interrupt.h>
+#include <avr/pgmspace.h>
 #include <util/delay.h>
+#endif
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include "atomic.h"
 
 /* Makrodefinitioner fr port-nummer p ATmega328P samt motsvarande pin-nummer p Arduino Uno: */
 #define D0 0 /* PORTD0 / pin 0. */
@@ -0,0 +1,102 @@
+/********************************************************************************
+* power.c: Innehller funktionsdefinitioner fr detektering av strmavbrott
+*          via den analoga komparatorn.
+********************************************************************************/
+#include "power.h"
+
+/* Makrodefinitioner: */
+#define POWER_BANDGAP_STARTUP_US 70 /* Bandgapsreferensens maximala starttid. */
+
+/********************************************************************************
+* Statiska variabler:
+*
+*   - on_fail   : Callback-rutin som anropas vid strmavbrott.
+*   - on_restore: Callback-rutin som anropas vid terhmtning.
+*   - low       : Indikerar ifall ett strmavbrott har detekterats.
+********************************************************************************/
+static void (*on_fail)(void) = 0;
+static void (*on_restore)(void) = 0;
+static volatile bool low = false;
+
+/********************************************************************************
+* power_init: Initierar detektering av strmavbrott via den analoga
+*             komparatorn med angivna callback-rutiner.
+*
+*             1. AD-omvandlaren stngs av och komparatorns negativa ingng
+*                kopplas till angiven ADC-kanal via multiplexern (ACME).
+*                Den digitala ingngen p samma pin inaktiveras, vilket
+*                minskar strmfrbrukningen vid analoga spnningar.
+*
+*             2. Bandgapsreferensen vljs som komparatorns positiva ingng
+*                (ACBG). Utsignalen ACO blir drmed hg nr den nedskalade
+*                matningsspnningen understiger referensen.
+*
+*             3. Efter referensens starttid nollstlls avbrottsflaggan, som
+*                kan ha satts vid omkopplingen, varefter avbrott aktiveras
+*                vid bde stigande och fallande flank (ACIS1:0 = 00).
+*
+*             - fail_callback   : Callback-rutin som anropas nr matnings-
+*                                 spnningen understiger trskeln.
+*             - restore_callback: Callback-rutin som anropas nr matnings-
+*                                 spnningen terigen verstiger trskeln.
+********************************************************************************/
+void power_init(void (*fail_callback)(void),
+                void (*restore_callback)(void))
+{
+   on_fail = fail_callback;
+   on_restore = restore_callback;
+   low = false;
+
+   ADCSRA &= ~(1 << ADEN);
+   ADCSRB |= (1 << ACME);
+   ADMUX = (ADMUX & 0xF0) | POWER_ADC_CHANNEL;
+   DIDR0 |= (1 << POWER_ADC_CHANNEL);
+
+   ACSR = (1 << ACBG);
+   _delay_us(POWER_BANDGAP_STARTUP_US);
+   ACSR = (1 << ACBG) | (1 << ACI);
+   ACSR = (1 << ACBG) | (1 << ACIE);
+   return;
+}
+
+/********************************************************************************
+* power_low: Indikerar ifall matningsspnningen understiger trskeln, dvs.
+*            ifall ett strmavbrott har detekterats.
+********************************************************************************/
+bool power_low(void)
+{
+   return low;
+}
+
+/********************************************************************************
+* power_run: Anropar callback-rutinen fr strmavbrott eller terhmtning
+*            beroende p komparatorns utsignal.
+*
+*            1. Om utsignalen ACO r hg har matningsspnningen understigit
+*               trskeln. Callback-rutinen fr strmavbrott anropas, varefter
+*               samtliga vntande skrivningar till EEPROM-minnet genomfrs
+*               direkt, d avbrottsrutinen fr EEPROM-minnet inte kan kras
+*               under pgende avbrottsrutin.
+*
+*            2. Annars har matningsspnningen terhmtat sig, varvid
+*               callback-rutinen fr terhmtning anropas.
+*
+*            Varje callback-rutin anropas enbart en gng per vergng, ven
+*            om utsignalen vxlar flera gnger kring trskeln.
+********************************************************************************/
+void power_run(void)
+{
+   if (ACSR & (1 << ACO))
+   {
+      if (low) return;
+      low = true;
+      if (on_fail) on_fail();
+      eeprom_flush();
+   }
+   else if (low)
+   {
+      low = false;
+      if (on_restore) on_restore();
+   }
+   return;
+}
@@ -0,0 +1,113 @@
+/********************************************************************************
+* power.h: Innehller drivrutiner fr detektering av strmavbrott via den
+*          analoga komparatorn, s att systemets tillstnd enbart behver
+*          lagras i EEPROM-minnet precis innan matningsspnningen frsvinner,
+*          i stllet fr vid varje frndring.
+*
+*          Matningsspnningen ansluts via en spnningsdelare till pin A0
+*          (ADC-kanal POWER_ADC_CHANNEL), exempelvis enligt nedan:
+*
+*          VCC ---[ 33 kOhm ]---+---[ 10 kOhm ]--- GND
+*                               |
+*                               A0
+*
+*          Komparatorn jmfr den nedskalade spnningen med den interna
+*          bandgapsreferensen (cirka 1.1 V) och genererar avbrott nr
+*          matningsspnningen passerar trskeln POWER_THRESHOLD_MV, vilket
+*          med ovanstende spnningsdelare blir cirka 4.7 V. ADC-kanalen
+*          anvnds via komparatorns multiplexer, d AIN0 (PORTD6) r upptagen
+*          av 7-segmentsdisplayerna, vilket innebr att AD-omvandlaren inte
+*          kan anvndas samtidigt.
+*
+*          Bandgapsreferensen varierar mellan 1.0 och 1.2 V mellan olika
+*          exemplar av ATmega328P. Trskeln kalibreras drfr genom att
+*          referensens uppmtta spnning anges via POWER_BANDGAP_MV,
+*          exempelvis genom att mta spnningen p pin AREF med bandgaps-
+*          referensen vald som referens fr AD-omvandlaren.
+*
+*          Nr matningsspnningen understiger trskeln anropas angiven
+*          callback-rutin, som ska lagra systemets tillstnd (ofta via
+*          eeprom_write_byte), varefter samtliga vntande skrivningar till
+*          EEPROM-minnet genomfrs direkt. Kondensatorerna p matningen
+*          mste drmed kunna hlla spnningen ver BOD-nivn tills
+*          skrivningarna r klara (upp till 3.4 ms per skriven byte), vilket
+*          underlttas av att callback-rutinen slcker strmkrvande
+*          laster ssom displayerna. Om matningsspnningen terhmtar sig
+*          anropas ytterligare en callback-rutin, s att systemet kan
+*          fortstta som vanligt.
+*
+*          Vid anvndning, anropa funktionen power_run i avbrottsrutinen fr
+*          den analoga komparatorn ssom visas nedan:
+*
+*          ISR (ANALOG_COMP_vect)
+*          {
+*             power_run();
+*             return;
+*          }
+********************************************************************************/
+#ifndef POWER_H_
+#define POWER_H_
+
+/* Inkluderingsdirektiv: */
+#include "misc.h"
+#include "eeprom.h"
+
+/********************************************************************************
+* Makrodefinitioner (kan ersttas vid kompilering):
+*
+*   - POWER_ADC_CHANNEL   : ADC-kanal (0 - 5) som spnningsdelaren r
+*                           ansluten till, dr kanal 0 motsvarar pin A0.
+*   - POWER_BANDGAP_MV    : Bandgapsreferensens uppmtta spnning mtt i mV.
+*   - POWER_DIVIDER_TOP   : Resistansen mellan VCC och A0 mtt i kOhm.
+*   - POWER_DIVIDER_BOTTOM: Resistansen mellan A0 och jord mtt i kOhm.
+*   - POWER_THRESHOLD_MV  : Matningsspnningen d strmavbrott detekteras.
+********************************************************************************/
+#ifndef POWER_ADC_CHANNEL
+#define POWER_ADC_CHANNEL 0
+#endif
+
+#ifndef POWER_BANDGAP_MV
+#define POWER_BANDGAP_MV 1100
+#endif
+
+#ifndef POWER_DIVIDER_TOP
+#define POWER_DIVIDER_TOP 33
+#endif
+
+#ifndef POWER_DIVIDER_BOTTOM
+#define POWER_DIVIDER_BOTTOM 10
+#endif
+
+#define POWER_THRESHOLD_MV \
+   ((uint32_t)POWER_BANDGAP_MV * (POWER_DIVIDER_TOP + POWER_DIVIDER_BOTTOM) / POWER_DIVIDER_BOTTOM)
+
+#if POWER_ADC_CHANNEL < 0 || POWER_ADC_CHANNEL > 5
+#error "POWER_ADC_CHANNEL mste vara mellan 0 och 5!"
+#endif
+
+/********************************************************************************
+* power_init: Initierar detektering av strmavbrott via den analoga
+*             komparatorn med angivna callback-rutiner.
+*
+*             - fail_callback   : Callback-rutin som anropas nr matnings-
+*                                 spnningen understiger trskeln.
+*             - restore_callback: Callback-rutin som anropas nr matnings-
+*                                 spnningen terigen verstiger trskeln.
+********************************************************************************/
+void power_init(void (*fail_callback)(void),
+                void (*restore_callback)(void));
+
+/********************************************************************************
+* power_low: Indikerar ifall matningsspnningen understiger trskeln, dvs.
+*            ifall ett strmavbrott har detekterats.
+********************************************************************************/
+bool power_low(void);
+
+/********************************************************************************
+* power_run: Anropar callback-rutinen fr strmavbrott eller terhmtning
+*            beroende p komparatorns utsignal. Funktionen ska anropas i
+*            avbrottsrutinen fr den analoga komparatorn (ANALOG_COMP_vect).
+********************************************************************************/
+void power_run(void);
+
+#endif /* POWER_H_ */
@@ -4,37 +4,142 @@
 ********************************************************************************/
 #include "serial.h"
 
+/* Makrodefinitioner: */
+#define SERIAL_TX_MASK (SERIAL_TX_BUFFER_SIZE - 1) /* Bitmask fr index i bufferten. */
+#define SERIAL_RX_MASK (SERIAL_RX_BUFFER_SIZE - 1) /* Bitmask fr index i mottagningsbufferten. */
+#define SERIAL_POWER_COUNT 10                      /* Antal tiopotenser (siffror i ett 32-bitars tal). */
+
+#if SERIAL_DOUBLE_DECIMALS > SERIAL_FIXED_DECIMALS_MAX
+#error "SERIAL_DOUBLE_DECIMALS fr inte verstiga SERIAL_FIXED_DECIMALS_MAX!"
+#endif
+
+/********************************************************************************
+* serial_powers: Tiopotenser 10^9 - 10^0 fr formatering av heltal via
+*                upprepad subtraktion, lagrade i programminnet.
+********************************************************************************/
+static const uint32_t serial_powers[SERIAL_POWER_COUNT] PROGMEM =
+{
+   1000000000, 100000000, 10000000, 1000000, 100000,
+   10000, 1000, 100, 10, 1
+};
+
 /********************************************************************************
-* serial_init: Initierar USART fr seriell verfring med angiven baud rate,
-*              dr default stts till 9600 kbps (kilobits/sekund). USART 
-*              konfigureras till asynkron verfring med tta bitar i taget,
-*              utan stoppbit.
+* serial_hex_digits: Tecken fr de hexadecimala siffrorna 0 - F, lagrade i
+*                    programminnet.
+********************************************************************************/
+static const char serial_hex_digits[16] PROGMEM =
+{
+   '0', '1', '2', '3', '4', '5', '6', '7',
+   '8', '9', 'A', 'B', 'C', 'D', 'E', 'F'
+};
+
+/********************************************************************************
+* Statiska variabler:
+*
+*   - tx_buffer : Ringbuffert med tecken som vntar p att skickas.
+*   - tx_head   : Skrivindex, ndras enbart av utskriftsfunktionerna.
+*   - tx_tail   : Lsindex, ndras enbart av avbrottsrutinen.
+*   - tx_dropped: Antal byte som har kastats p grund av full buffert.
+*
+*   - rx_buffer : Ringbuffert med mottagna tecken som nnu inte har lsts.
+*   - rx_head   : Skrivindex, ndras enbart av avbrottsrutinen.
+*   - rx_tail   : Lsindex, ndras enbart av funktionen serial_read_char.
+*   - rx_dropped: Antal mottagna byte som har kastats p grund av full
+*                 mottagningsbuffert.
 *
-*              - baud_rate_kbps: verfringshastigheten, dvs. antalet bitar som 
-'                                transmitteras per sekund (default = 9600 kbps).
+*   - requested_baud: nskad baud rate, fr berkning av avvikelsen.
+*
+*   Indexen rknas upp kontinuerligt och slr om frn 255 till 0, dr
+*   skillnaden mellan dem r antalet tecken i bufferten. Position i
+*   bufferten erhlls via maskning med SERIAL_TX_MASK respektive
+*   SERIAL_RX_MASK.
+********************************************************************************/
+static uint8_t tx_buffer[SERIAL_TX_BUFFER_SIZE];
+static volatile uint8_t tx_head = 0;
+static volatile uint8_t tx_tail = 0;
+static volatile uint32_t tx_dropped = 0;
+
+static uint8_t rx_buffer[SERIAL_RX_BUFFER_SIZE];
+static volatile uint8_t rx_head = 0;
+static volatile uint8_t rx_tail = 0;
+static volatile uint32_t rx_dropped = 0;
+
+static uint32_t requested_baud = SERIAL_BAUD_DEFAULT;
+
+/********************************************************************************
+* Statiska funktioner:
 ********************************************************************************/
-void serial_init(const uint32_t baud_rate_kbps)
+static inline uint8_t serial_tx_free(void);
+static inline void serial_tx_start(void);
+static void serial_tx_poll(void);
+static void serial_print_decimal(uint32_t number,
+                                 uint8_t decimals);
+
+/********************************************************************************
+* serial_init_baud: Initierar USART fr seriell verfring med angivet vrde i
+*                   baud rate-registret. USART konfigureras till asynkron
+*                   verfring med tta databitar, utan paritetsbit och med
+*                   en stoppbit. Enbart sndaren aktiveras, se funktionen
+*                   serial_enable_receive fr mottagning. USART stts frst
+*                   p via PRR, d den stngs av vid start, se idle.h.
+*
+*                   - baud_rate   : nskad baud rate, fr berkning av
+*                                   avvikelsen.
+*                   - ubrr        : Vrde i baud rate-registret UBRR0.
+*                   - double_speed: Indikerar ifall dubbel hastighet (U2X0)
+*                                   ska anvndas.
+********************************************************************************/
+void serial_init_baud(const uint32_t baud_rate,
+                      const uint16_t ubrr,
+                      const bool double_speed)
 {
    static bool serial_initialized = false;
    if (serial_initialized) return;
 
+   PRR &= ~(1 << PRUSART0);
+   UCSR0A = double_speed ? (1 << U2X0) : 0;
    UCSR0B = (1 << TXEN0);
    UCSR0C = (1 << UCSZ00) | (1 << UCSZ01);
-
-   if (baud_rate_kbps == 0 || baud_rate_kbps == 9600)
-   {
-      UBRR0 = 103;
-   }
-   else
-   {
-      UBRR0 = (uint8_t)(F_CPU / (16.0 * baud_rate_kbps) - 1 + 0.5);  
-   }
+   UBRR0 = ubrr;
+   requested_baud = baud_rate;
 
    UDR0 = '\r';
    serial_initialized = true;
    return;
 }
 
+/********************************************************************************
+* serial_baud_rate: Returnerar faktisk baud rate utifrn baud rate-registret
+*                   samt vald hastighet.
+********************************************************************************/
+uint32_t serial_baud_rate(void)
+{
+   const uint8_t divisor = (UCSR0A & (1 << U2X0)) ? 8 : 16;
+   return F_CPU / (divisor * (UBRR0 + 1UL));
+}
+
+/********************************************************************************
+* serial_baud_error: Returnerar faktisk baud rates avvikelse frn nskad baud
+*                    rate mtt i hundradels procent. Berkningen sker med
+*                    32-bitars heltal, dr faktisk samt nskad baud rate
+*                    berknas i hundradels baud, s att avrundningen av
+*                    faktisk baud rate till heltal inte pverkar resultatet
+*                    (exempelvis 9615.38 i stllet fr 9615 vid 9600 baud,
+*                    vilket ger 16 i stllet fr 15). Avvikelsen delas
+*                    drefter med nskad baud rate delat med 100 i stllet
+*                    fr att multipliceras med 100, vilket inte kan sl om
+*                    och r exakt fr baud rates som r jmnt delbara med
+*                    100, exempelvis 9600 samt 115 200.
+********************************************************************************/
+int16_t serial_baud_error(void)
+{
+   if (requested_baud < 100) return 0;
+   const uint8_t divisor = (UCSR0A & (1 << U2X0)) ? 8 : 16;
+   const uint32_t actual = F_CPU * 100 / (divisor * (UBRR0 + 1UL));
+   const int32_t deviation = (int32_t)actual - (int32_t)(requested_baud * 100);
+   return (int16_t)(deviation / (int32_t)(requested_baud / 100));
+}
+
 /********************************************************************************
 * serial_print_string: Skriver ut text via seriell verfring.
 *
@@ -61,9 +166,7 @@ void serial_print_string(const char* s)
 ********************************************************************************/
 void serial_print_integer(const int32_t number)
 {
-   char s[20] = { '\0' };
-   sprintf(s, "%ld", number);
-   serial_print_string(s);
+   serial_print_fixed(number, 0);
    return;
 }
 
@@ -74,46 +177,339 @@ void serial_print_integer(const int32_t number)
 ********************************************************************************/
 void serial_print_unsigned(const uint32_t number)
 {
-   char s[20] = { '\0' };
-   sprintf(s, "%lu", number);
+   serial_print_decimal(number, 0);
+   return;
+}
+
+/********************************************************************************
+* serial_print_hex: Skriver ut ett osignerat heltal hexadecimalt (versaler,
+*                   utan prefix) via seriell verfring. Varje siffra hmtas
+*                   direkt ur tabellen serial_hex_digits via fyra bitar av
+*                   talet, med brjan i de mest signifikanta bitarna.
+*
+*                   - number: Heltalet som ska skrivas ut.
+*                   - digits: Minsta antal siffror (1 - 8), dr talet fylls ut
+*                             med inledande nollor. Vid 0 skrivs enbart
+*                             ndvndiga siffror ut.
+********************************************************************************/
+void serial_print_hex(const uint32_t number,
+                      const uint8_t digits)
+{
+   char s[9];
+   uint8_t length = 0;
+
+   for (uint8_t i = 8; i-- > 0;)
+   {
+      const uint8_t nibble = (uint8_t)(number >> (i * 4)) & 0x0F;
+
+      if (length || nibble || i < digits || i == 0)
+      {
+         s[length++] = (char)pgm_read_byte(&serial_hex_digits[nibble]);
+      }
+   }
+
+   s[length] = '\0';
    serial_print_string(s);
    return;
 }
 
 /********************************************************************************
-* serial_print_double: Skriver ut ett flyttal med upp till tv decimaler 
-*                      via seriell verfring.
+* serial_print_fixed: Skriver ut ett fixtal med angivet antal decimaler via
+*                     seriell verfring, dr talet anges i enheten
+*                     10^-decimals. Eventuellt minustecken skrivs ut frst,
+*                     varefter talets absolutbelopp skrivs ut, vilket ven
+*                     fungerar fr minsta mjliga tal (-2^31).
 *
-*                      - number: Flyttalet som ska skrivas ut.
+*                     - number  : Fixtalet som ska skrivas ut.
+*                     - decimals: Antal decimaler (0 - 9), dr vrden ver
+*                                 SERIAL_FIXED_DECIMALS_MAX begrnsas.
 ********************************************************************************/
-void serial_print_double(const double number)
+void serial_print_fixed(const int32_t number,
+                        const uint8_t decimals)
 {
-   const int32_t integer = (int32_t)number;
-   int32_t decimal;
-   char s[20] = { '\0' };
-   
-   if (integer >= 0)
+   if (number < 0)
    {
-      decimal = (int32_t)((number - integer) * 100 + 0.5);
+      serial_print_char('-');
+      serial_print_decimal(0 - (uint32_t)number, decimals);
    }
    else
    {
-      decimal = (int32_t)((integer - number) * 100 + 0.5);
+      serial_print_decimal((uint32_t)number, decimals);
    }
+   return;
+}
 
-   sprintf(s, "%ld.%ld", integer, decimal);
-   serial_print_string(s);
+/********************************************************************************
+* serial_print_double: Skriver ut ett flyttal avrundat till
+*                      SERIAL_DOUBLE_DECIMALS decimaler via seriell
+*                      verfring. Flyttalet omvandlas till ett fixtal via en
+*                      enda multiplikation, dr tal som inte ryms i 32 bitar
+*                      begrnsas, varefter utskrift sker som fixtal.
+*
+*                      - number: Flyttalet som ska skrivas ut.
+********************************************************************************/
+void serial_print_double(const double number)
+{
+   const double scale = pgm_read_dword(&serial_powers[SERIAL_POWER_COUNT - 1 - SERIAL_DOUBLE_DECIMALS]);
+   double fixed = number * scale + (number < 0 ? -0.5 : 0.5);
+
+   if (fixed > INT32_MAX) fixed = INT32_MAX;
+   else if (fixed < INT32_MIN) fixed = INT32_MIN;
+
+   serial_print_fixed((int32_t)fixed, SERIAL_DOUBLE_DECIMALS);
    return;
 }
 
 /********************************************************************************
-* serial_print_char: Skriver ut ett enskilt tecken via seriell verfring.
+* serial_print_char: Lgger ett enskilt tecken i bufferten fr utskrift via
+*                    seriell verfring. Vid full buffert avvaktas att plats
+*                    frigrs, dr bufferten tms direkt ifall avbrott r
+*                    inaktiverade.
 *
 *                    - character: Det tecken som ska skrivas ut.
 ********************************************************************************/
 void serial_print_char(const char character)
 {
-   while ((UCSR0A & (1 << UDRE0)) == 0);
-   UDR0 = character;
+   while (!serial_tx_free())
+   {
+      serial_tx_poll();
+   }
+
+   tx_buffer[tx_head & SERIAL_TX_MASK] = (uint8_t)character;
+   tx_head++;
+   serial_tx_start();
    return;
-}
\ No newline at end of file
+}
+
+/********************************************************************************
+* serial_try_print_char: Lgger ett tecken i bufferten fr utskrift utan att
+*                        vnta. Om bufferten r full kastas tecknet, varvid
+*                        antalet kastade byte rknas upp och felkod 1
+*                        returneras. Annars returneras 0.
+*
+*                        - character: Det tecken som ska skrivas ut.
+********************************************************************************/
+int serial_try_print_char(const char character)
+{
+   return serial_try_write(&character, 1);
+}
+
+/********************************************************************************
+* serial_try_write: Lgger angivet antal byte i bufferten fr utskrift utan
+*                   att vnta. Antingen lggs samtliga byte i bufferten och 0
+*                   returneras, eller s kastas samtliga byte, varvid antalet
+*                   kastade byte rknas upp och felkod 1 returneras.
+*
+*                   Skrivindex uppdateras frst nr samtliga byte har lagts
+*                   i bufferten, s att avbrottsrutinen aldrig skickar en
+*                   byte som nnu inte har skrivits.
+*
+*                   - data: Pekare till datan som ska skrivas ut.
+*                   - size: Antal byte som ska skrivas ut.
+********************************************************************************/
+int serial_try_write(const void* data,
+                     const uint8_t size)
+{
+   if (size > serial_tx_free())
+   {
+      tx_dropped += size;
+      return 1;
+   }
+
+   const uint8_t* bytes = (const uint8_t*)data;
+   uint8_t head = tx_head;
+
+   for (uint8_t i = 0; i < size; ++i)
+   {
+      tx_buffer[head++ & SERIAL_TX_MASK] = bytes[i];
+   }
+
+   tx_head = head;
+   serial_tx_start();
+   return 0;
+}
+
+/********************************************************************************
+* serial_dropped: Returnerar antalet byte som har kastats p grund av full
+*                 buffert sedan start.
+********************************************************************************/
+uint32_t serial_dropped(void)
+{
+   return atomic_read_u32(&tx_dropped);
+}
+
+/********************************************************************************
+* serial_flush: Vntar tills samtliga tecken i bufferten har skickats.
+*               Funktionen kan anropas ven med avbrott inaktiverade, d
+*               bufferten i s fall tms direkt av funktionen.
+********************************************************************************/
+void serial_flush(void)
+{
+   while (tx_head != tx_tail)
+   {
+      serial_tx_poll();
+   }
+   return;
+}
+
+/********************************************************************************
+* serial_transmit_next: Skriver nsta tecken i bufferten till dataregistret.
+*                       Om bufferten r tom inaktiveras avbrott fr USART, d
+*                       avbrottet annars utlses s lnge dataregistret r
+*                       tomt.
+********************************************************************************/
+void serial_transmit_next(void)
+{
+   const uint8_t tail = tx_tail;
+
+   if (tail == tx_head)
+   {
+      UCSR0B &= ~(1 << UDRIE0);
+      return;
+   }
+
+   UDR0 = tx_buffer[tail & SERIAL_TX_MASK];
+   tx_tail = tail + 1;
+   return;
+}
+
+/********************************************************************************
+* serial_enable_receive: Aktiverar mottagning via USART samt avbrott nr ett
+*                        tecken har tagits emot. Pinnen RXD (PORTD0) tas
+*                        drmed ver av USART.
+********************************************************************************/
+void serial_enable_receive(void)
+{
+   UCSR0B |= (1 << RXEN0) | (1 << RXCIE0);
+   return;
+}
+
+/********************************************************************************
+* serial_read_char: Lser nsta mottagna tecken ur mottagningsbufferten utan
+*                   att vnta. Om ett tecken fanns returneras 0 efter att
+*                   tecknet har lagrats p angiven adress. Annars returneras
+*                   felkod 1.
+*
+*                   - character: Pekare till variabeln som tecknet lagras i.
+********************************************************************************/
+int serial_read_char(char* character)
+{
+   const uint8_t tail = rx_tail;
+   if (tail == rx_head) return 1;
+
+   *character = (char)rx_buffer[tail & SERIAL_RX_MASK];
+   rx_tail = tail + 1;
+   return 0;
+}
+
+/********************************************************************************
+* serial_receive_dropped: Returnerar antalet mottagna byte som har kastats p
+*                         grund av full mottagningsbuffert sedan start.
+********************************************************************************/
+uint32_t serial_receive_dropped(void)
+{
+   return atomic_read_u32(&rx_dropped);
+}
+
+/********************************************************************************
+* serial_receive_next: Lagrar mottaget tecken i mottagningsbufferten.
+*                      Dataregistret lses alltid, vilket nollstller
+*                      avbrottsflaggan, ven om tecknet sedan kastas p grund
+*                      av full buffert.
+********************************************************************************/
+void serial_receive_next(void)
+{
+   const uint8_t data = UDR0;
+   const uint8_t head = rx_head;
+
+   if ((uint8_t)(head - rx_tail) >= SERIAL_RX_BUFFER_SIZE)
+   {
+      rx_dropped++;
+      return;
+   }
+
+   rx_buffer[head & SERIAL_RX_MASK] = data;
+   rx_head = head + 1;
+   return;
+}
+
+/********************************************************************************
+* serial_tx_free: Returnerar antalet lediga platser i bufferten.
+********************************************************************************/
+static inline uint8_t serial_tx_free(void)
+{
+   return SERIAL_TX_BUFFER_SIZE - (uint8_t)(tx_head - tx_tail);
+}
+
+/********************************************************************************
+* serial_tx_start: Aktiverar avbrott fr USART, s att bufferten tms i
+*                  bakgrunden. Om avbrottsrutinen hinner inaktivera avbrottet
+*                  under ls-modifiera-skriv-sekvensen aktiveras det enbart
+*                  p nytt, varvid avbrottsrutinen inaktiverar det igen.
+********************************************************************************/
+static inline void serial_tx_start(void)
+{
+   UCSR0B |= (1 << UDRIE0);
+   return;
+}
+
+/********************************************************************************
+* serial_tx_poll: Skickar nsta tecken direkt ifall avbrott r inaktiverade
+*                 och dataregistret r tomt, s att bufferten tms ven nr
+*                 avbrottsrutinen inte kan kras. Med avbrott aktiverade tms
+*                 bufferten av avbrottsrutinen.
+********************************************************************************/
+static void serial_tx_poll(void)
+{
+   if ((UCSR0A & (1 << UDRE0)) && !(SREG & (1 << SREG_I)))
+   {
+      serial_transmit_next();
+   }
+   return;
+}
+
+/********************************************************************************
+* serial_print_decimal: Skriver ut ett osignerat heltal decimalt via seriell
+*                       verfring, med decimalpunkt fre de angivna antalet
+*                       sista siffrorna. Varje siffra berknas via upprepad
+*                       subtraktion av motsvarande tiopotens, vilket krver
+*                       hgst nio subtraktioner per siffra i stllet fr en
+*                       32-bitars division, som saknar hrdvarustd p AVR.
+*                       Inledande nollor utelmnas, dock skrivs alltid minst
+*                       en siffra ut fre decimalpunkten.
+*
+*                       - number  : Heltalet som ska skrivas ut.
+*                       - decimals: Antal decimaler (0 - 9), dr vrden ver
+*                                   SERIAL_FIXED_DECIMALS_MAX begrnsas.
+********************************************************************************/
+static void serial_print_decimal(uint32_t number,
+                                 uint8_t decimals)
+{
+   char s[SERIAL_POWER_COUNT + 2];
+   uint8_t length = 0;
+
+   if (decimals > SERIAL_FIXED_DECIMALS_MAX) decimals = SERIAL_FIXED_DECIMALS_MAX;
+
+   for (uint8_t i = 0; i < SERIAL_POWER_COUNT; ++i)
+   {
+      const uint32_t power = pgm_read_dword(&serial_powers[i]);
+      const uint8_t position = SERIAL_POWER_COUNT - 1 - i;
+      char digit = '0';
+
+      while (number >= power)
+      {
+         number -= power;
+         digit++;
+      }
+
+      if (length || digit != '0' || position <= decimals)
+      {
+         if (decimals && position == decimals - 1) s[length++] = '.';
+         s[length++] = digit;
+      }
+   }
+
+   s[length] = '\0';
+   serial_print_string(s);
+   return;
+}
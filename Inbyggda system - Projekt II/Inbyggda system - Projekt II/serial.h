@@ -1,5 +1,64 @@
 /********************************************************************************
 * serial.h: Innehller drivrutiner fr seriell verfring via USART.
+*
+*           Utskrift sker asynkront via en ringbuffert, s att utskrifts-
+*           funktionerna returnerar direkt i stllet fr att vnta cirka 1 ms
+*           per tecken (vid 9600 baud) p att fregende tecken ska ha
+*           skickats. Bufferten tms ett tecken i taget av avbrottsrutinen
+*           fr USART, vilken mste anropa funktionen serial_transmit_next
+*           ssom visas nedan:
+*
+*           ISR (USART_UDRE_vect)
+*           {
+*              serial_transmit_next();
+*              return;
+*           }
+*
+*           Bufferten r lsfri, d enbart utskriftsfunktionerna ndrar
+*           skrivindex och enbart avbrottsrutinen ndrar lsindex. Drmed
+*           behver avbrott aldrig inaktiveras vid utskrift, frutsatt att
+*           utskrift enbart sker frn ett sammanhang t gngen (exempelvis
+*           huvudloopen).
+*
+*           Vid full buffert vntar de ordinarie utskriftsfunktionerna tills
+*           plats har frigjorts, ven med avbrott inaktiverade, d bufferten
+*           i s fall tms direkt av funktionen. Funktionerna
+*           serial_try_print_char samt serial_try_write vntar i stllet
+*           aldrig, utan kastar data som inte ryms, varvid antalet kastade
+*           byte rknas upp. Dessa funktioner lmpar sig drmed fr loggning
+*           frn tidskritisk kod.
+*
+*           Heltal formateras utan sprintf samt utan division, dr varje
+*           siffra i stllet berknas via upprepad subtraktion av tiopotenser
+*           ur en tabell i programminnet. Decimaltal skrivs ut som fixtal,
+*           exempelvis en temperatur lagrad i hundradels grader, vilket gr
+*           att flyttalsaritmetik inte behvs.
+*
+*           Mottagning aktiveras via funktionen serial_enable_receive, dr
+*           mottagna tecken lagras i en separat ringbuffert av avbrotts-
+*           rutinen fr USART, vilken mste anropa funktionen
+*           serial_receive_next ssom visas nedan:
+*
+*           ISR (USART_RX_vect)
+*           {
+*              serial_receive_next();
+*              return;
+*           }
+*
+*           Mottagna tecken lses sedan ut utan att vnta via funktionen
+*           serial_read_char, exempelvis frn huvudloopen. Tecken som tas
+*           emot nr bufferten r full kastas, varvid antalet kastade byte
+*           rknas upp.
+*
+*           Baud rate-registret UBRR0 berknas vid kompilering frn nskad
+*           baud rate, frutsatt att denna anges som en konstant, dr dubbel
+*           hastighet (U2X0) vljs nr detta ger mindre avvikelse. Vid 16 MHz
+*           ger exempelvis 250 000, 500 000 samt 1 000 000 baud ingen
+*           avvikelse alls, medan 115 200 baud avviker 2.1 % med dubbel
+*           hastighet i stllet fr -3.5 % utan. Vid hga hastigheter mste
+*           avbrottsrutinerna vara korta, d ett tecken tas emot var 160:e
+*           klockcykel vid 1 000 000 baud, medan mottagaren enbart rymmer
+*           tv tecken utver det som tas emot.
 ********************************************************************************/
 #ifndef SERIAL_H_
 #define SERIAL_H_
@@ -7,12 +66,124 @@
 /* Inkluderingsdirektiv: */
 #include "misc.h"
 
+/* Makrodefinitioner: */
+#ifndef SERIAL_TX_BUFFER_SIZE
+#define SERIAL_TX_BUFFER_SIZE 64 /* Ringbuffertens storlek (tvpotens 2 - 128). */
+#endif
+
+#if SERIAL_TX_BUFFER_SIZE < 2 || SERIAL_TX_BUFFER_SIZE > 128 || \
+    (SERIAL_TX_BUFFER_SIZE & (SERIAL_TX_BUFFER_SIZE - 1))
+#error "SERIAL_TX_BUFFER_SIZE mste vara en tvpotens mellan 2 och 128!"
+#endif
+
+#ifndef SERIAL_RX_BUFFER_SIZE
+#define SERIAL_RX_BUFFER_SIZE 32 /* Mottagningsbuffertens storlek (tvpotens 2 - 128). */
+#endif
+
+#if SERIAL_RX_BUFFER_SIZE < 2 || SERIAL_RX_BUFFER_SIZE > 128 || \
+    (SERIAL_RX_BUFFER_SIZE & (SERIAL_RX_BUFFER_SIZE - 1))
+#error "SERIAL_RX_BUFFER_SIZE mste vara en tvpotens mellan 2 och 128!"
+#endif
+
+#ifndef SERIAL_DOUBLE_DECIMALS
+#define SERIAL_DOUBLE_DECIMALS 2 /* Antal decimaler vid utskrift av flyttal. */
+#endif
+
+#define SERIAL_FIXED_DECIMALS_MAX 9 /* Maximalt antal decimaler vid utskrift av fixtal. */
+
+/********************************************************************************
+* Makrodefinitioner fr berkning av baud rate, vilka ven kan anvndas i
+* preprocessordirektiv, exempelvis fr kontroll av vald baud rate:
+*
+*   - SERIAL_BAUD_DEFAULT       : Baud rate som anvnds om 0 anges.
+*   - SERIAL_BAUD_ERROR_MAX     : Strsta rekommenderade avvikelse mtt i
+*                                 hundradels procent (2 %).
+*   - SERIAL_UBRR_MAX           : Strsta vrde i registret UBRR0 (12 bitar).
+*   - SERIAL_UBRR               : Avrundat vrde i UBRR0 fr angiven baud rate
+*                                 och delningsfaktor (16, eller 8 vid dubbel
+*                                 hastighet).
+*   - SERIAL_BAUD_ACTUAL        : Faktisk baud rate fr angiven baud rate och
+*                                 delningsfaktor.
+*   - SERIAL_BAUD_DEVIATION     : Faktisk baud rates absoluta avvikelse frn
+*                                 angiven baud rate.
+*   - SERIAL_DOUBLE_SPEED       : 1 om dubbel hastighet (U2X0) ger mindre
+*                                 avvikelse fr angiven baud rate, annars 0.
+*   - SERIAL_DIVISOR            : Delningsfaktor fr angiven baud rate.
+*   - SERIAL_BAUD_ERROR_ABS     : Absolut avvikelse fr angiven baud rate mtt
+*                                 i hundradels procent.
+********************************************************************************/
+#define SERIAL_BAUD_DEFAULT   9600
+#define SERIAL_BAUD_ERROR_MAX 200
+#define SERIAL_UBRR_MAX       4095
+
+#define SERIAL_UBRR(baud, divisor) \
+   ((F_CPU + (divisor) * (baud) / 2) / ((divisor) * (baud)) - 1)
+
+#define SERIAL_BAUD_ACTUAL(baud, divisor) \
+   (F_CPU / ((divisor) * (SERIAL_UBRR(baud, divisor) + 1)))
+
+#define SERIAL_BAUD_DEVIATION(baud, divisor)                         \
+   (SERIAL_BAUD_ACTUAL(baud, divisor) > (baud) ?                     \
+    SERIAL_BAUD_ACTUAL(baud, divisor) - (baud) :                     \
+    (baud) - SERIAL_BAUD_ACTUAL(baud, divisor))
+
+#define SERIAL_DOUBLE_SPEED(baud)                                    \
+   (SERIAL_UBRR(baud, 8) <= SERIAL_UBRR_MAX &&                        \
+    SERIAL_BAUD_DEVIATION(baud, 8) < SERIAL_BAUD_DEVIATION(baud, 16))
+
+#define SERIAL_DIVISOR(baud) (SERIAL_DOUBLE_SPEED(baud) ? 8 : 16)
+
+#define SERIAL_BAUD_ERROR_ABS(baud) \
+   (SERIAL_BAUD_DEVIATION(baud, SERIAL_DIVISOR(baud)) * 100 / ((baud) / 100))
+
+/********************************************************************************
+* serial_init_baud: Initierar USART fr seriell verfring med angivet vrde i
+*                   baud rate-registret. Anropas via funktionen serial_init,
+*                   som berknar vrdet frn nskad baud rate.
+*
+*                   - baud_rate   : nskad baud rate, fr berkning av
+*                                   avvikelsen.
+*                   - ubrr        : Vrde i baud rate-registret UBRR0.
+*                   - double_speed: Indikerar ifall dubbel hastighet (U2X0)
+*                                   ska anvndas.
+********************************************************************************/
+void serial_init_baud(const uint32_t baud_rate,
+                      const uint16_t ubrr,
+                      const bool double_speed);
+
 /********************************************************************************
-* serial_init: Initierar USART fr seriell verfring med angiven baud rate.
+* serial_init: Initierar USART fr seriell verfring med angiven baud rate,
+*              exempelvis 9600, 115 200, 250 000, 500 000 eller 1 000 000
+*              (F_CPU / 65 536 - F_CPU / 8, det vill sga 245 - 2 000 000
+*              vid 16 MHz).
+*              Om baud rate anges som en konstant berknas baud rate-
+*              registret samt valet av dubbel hastighet helt vid kompilering.
+*              Avvikelsen frn angiven baud rate kan drefter lsas av via
+*              funktionen serial_baud_error.
 *
-*              - baud_rate: verfringshastighet mtt i kilobits per sekund.
+*              - baud_rate: verfringshastighet mtt i bitar per sekund
+*                           (0 = SERIAL_BAUD_DEFAULT).
+********************************************************************************/
+static inline void serial_init(const uint32_t baud_rate)
+{
+   const uint32_t baud = baud_rate ? baud_rate : SERIAL_BAUD_DEFAULT;
+   serial_init_baud(baud, SERIAL_UBRR(baud, SERIAL_DIVISOR(baud)), SERIAL_DOUBLE_SPEED(baud));
+   return;
+}
+
+/********************************************************************************
+* serial_baud_rate: Returnerar faktisk baud rate utifrn baud rate-registret
+*                   samt vald hastighet.
+********************************************************************************/
+uint32_t serial_baud_rate(void);
+
+/********************************************************************************
+* serial_baud_error: Returnerar faktisk baud rates avvikelse frn nskad baud
+*                    rate mtt i hundradels procent, exempelvis 16 fr
+*                    +0.16 % eller -350 fr -3.5 %. Avvikelser ver
+*                    SERIAL_BAUD_ERROR_MAX kan medfra verfringsfel.
 ********************************************************************************/
-void serial_init(const uint32_t baud_rate_kbps);
+int16_t serial_baud_error(void);
 
 /********************************************************************************
 * serial_print_string: Skriver ut text via seriell verfring.
@@ -36,7 +207,39 @@ void serial_print_integer(const int32_t number);
 void serial_print_unsigned(const uint32_t number);
 
 /********************************************************************************
-* serial_print_double: Skriver ut ett flyttal via seriell verfring.
+* serial_print_hex: Skriver ut ett osignerat heltal hexadecimalt (versaler,
+*                   utan prefix) via seriell verfring.
+*
+*                   - number: Heltalet som ska skrivas ut.
+*                   - digits: Minsta antal siffror (1 - 8), dr talet fylls ut
+*                             med inledande nollor. Vid 0 skrivs enbart
+*                             ndvndiga siffror ut.
+********************************************************************************/
+void serial_print_hex(const uint32_t number,
+                      const uint8_t digits);
+
+/********************************************************************************
+* serial_print_fixed: Skriver ut ett fixtal med angivet antal decimaler via
+*                     seriell verfring, dr talet anges i enheten
+*                     10^-decimals. Exempelvis skrivs talet 2150 ut som 21.50
+*                     med tv decimaler, medan talet -5 skrivs ut som -0.05.
+*
+*                     - number  : Fixtalet som ska skrivas ut.
+*                     - decimals: Antal decimaler (0 - 9), dr vrden ver
+*                                 SERIAL_FIXED_DECIMALS_MAX begrnsas.
+********************************************************************************/
+void serial_print_fixed(const int32_t number,
+                        const uint8_t decimals);
+
+/********************************************************************************
+* serial_print_double: Skriver ut ett flyttal avrundat till
+*                      SERIAL_DOUBLE_DECIMALS decimaler via seriell
+*                      verfring. Flyttalet omvandlas till ett fixtal via en
+*                      enda multiplikation, varefter utskrift sker via
+*                      funktionen serial_print_fixed. Tal som inte ryms i 32
+*                      bitar efter omvandlingen begrnsas. Anvnd hellre
+*                      serial_print_fixed direkt, vilket undviker
+*                      flyttalsaritmetik helt.
 *
 *                      - number: Flyttalet som ska skrivas ut.
 ********************************************************************************/
@@ -49,6 +252,81 @@ void serial_print_double(const double number);
 ********************************************************************************/
 void serial_print_char(const char character);
 
+/********************************************************************************
+* serial_try_print_char: Lgger ett tecken i bufferten fr utskrift utan att
+*                        vnta. Om bufferten r full kastas tecknet, varvid
+*                        antalet kastade byte rknas upp och felkod 1
+*                        returneras. Annars returneras 0.
+*
+*                        - character: Det tecken som ska skrivas ut.
+********************************************************************************/
+int serial_try_print_char(const char character);
+
+/********************************************************************************
+* serial_try_write: Lgger angivet antal byte i bufferten fr utskrift utan
+*                   att vnta. Antingen lggs samtliga byte i bufferten och 0
+*                   returneras, eller s kastas samtliga byte, varvid antalet
+*                   kastade byte rknas upp och felkod 1 returneras. Drmed
+*                   skrivs exempelvis ett datapaket aldrig ut ofullstndigt.
+*
+*                   - data: Pekare till datan som ska skrivas ut.
+*                   - size: Antal byte som ska skrivas ut.
+********************************************************************************/
+int serial_try_write(const void* data,
+                     const uint8_t size);
+
+/********************************************************************************
+* serial_dropped: Returnerar antalet byte som har kastats p grund av full
+*                 buffert sedan start.
+********************************************************************************/
+uint32_t serial_dropped(void);
+
+/********************************************************************************
+* serial_flush: Vntar tills samtliga tecken i bufferten har skickats.
+*               Funktionen kan anropas ven med avbrott inaktiverade, d
+*               bufferten i s fall tms direkt av funktionen.
+********************************************************************************/
+void serial_flush(void);
+
+/********************************************************************************
+* serial_transmit_next: Skriver nsta tecken i bufferten till dataregistret.
+*                       Om bufferten r tom inaktiveras avbrott fr USART.
+*                       Denna funktion ska anropas i avbrottsrutinen fr
+*                       USART (USART_UDRE_vect).
+********************************************************************************/
+void serial_transmit_next(void);
+
+/********************************************************************************
+* serial_enable_receive: Aktiverar mottagning via USART, dr mottagna tecken
+*                        lagras i mottagningsbufferten av avbrottsrutinen fr
+*                        USART (USART_RX_vect). Funktionen serial_init mste
+*                        ha anropats innan.
+********************************************************************************/
+void serial_enable_receive(void);
+
+/********************************************************************************
+* serial_read_char: Lser nsta mottagna tecken ur mottagningsbufferten utan
+*                   att vnta. Om ett tecken fanns returneras 0 efter att
+*                   tecknet har lagrats p angiven adress. Annars returneras
+*                   felkod 1.
+*
+*                   - character: Pekare till variabeln som tecknet lagras i.
+********************************************************************************/
+int serial_read_char(char* character);
+
+/********************************************************************************
+* serial_receive_dropped: Returnerar antalet mottagna byte som har kastats p
+*                         grund av full mottagningsbuffert sedan start.
+********************************************************************************/
+uint32_t serial_receive_dropped(void);
+
+/********************************************************************************
+* serial_receive_next: Lagrar mottaget tecken i mottagningsbufferten. Om
+*                      bufferten r full kastas tecknet. Denna funktion ska
+*                      anropas i avbrottsrutinen fr USART (USART_RX_vect).
+********************************************************************************/
+void serial_receive_next(void);
+
 /********************************************************************************
 * serial_print_new_line: Stter nsta utskrift till lngst till vnster p 
 *                        nsta rad via utskrift av ett nyradstecken.
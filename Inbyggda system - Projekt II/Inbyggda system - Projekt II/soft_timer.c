@@ -0,0 +1,329 @@
+/********************************************************************************
+* soft_timer.c: Innehller definitioner av associerade funktioner fr strukten
+*               soft_timer samt schemalggningen av mjukvarutimers p Timer 1.
+********************************************************************************/
+#include "soft_timer.h"
+
+/********************************************************************************
+* Makrodefinitioner:
+*
+*   - SOFT_TIMER_MIN_DELTA: Minsta avstnd mellan aktuell tid och nsta
+*                           avbrott mtt i tick, s att jmfrelsevrdet inte
+*                           hinner passeras innan det har skrivits.
+*   - SOFT_TIMER_MAX_DELTA: Strsta avstnd till nsta avbrott mtt i tick,
+*                           vilket garanterar att tiden uppdateras minst en
+*                           gng per halvt varv p Timer 1.
+********************************************************************************/
+#define SOFT_TIMER_MIN_DELTA 4
+#define SOFT_TIMER_MAX_DELTA 0x8000
+
+/********************************************************************************
+* Statiska variabler:
+*
+*   - queue       : Aktiva timers sorterade efter utlsningstidpunkt.
+*   - base_time   : Tid mtt i tick vid senaste tidsuppdatering.
+*   - base_count  : Innehllet i TCNT1 vid senaste tidsuppdatering.
+*   - initialized : Indikerar ifall Timer 1 har initierats.
+********************************************************************************/
+static struct soft_timer* queue = 0;
+static uint32_t base_time = 0;
+static uint16_t base_count = 0;
+static bool initialized = false;
+
+/********************************************************************************
+* Statiska funktioner:
+********************************************************************************/
+static void soft_timer_init_circuit(void);
+static void soft_timer_update_time(void);
+static void soft_timer_insert(struct soft_timer* self);
+static void soft_timer_remove(struct soft_timer* self);
+static void soft_timer_program_next(void);
+static inline uint32_t soft_timer_get_ticks(const double time_ms);
+
+/********************************************************************************
+* soft_timer_init: Initierar ny mjukvarutimer med angiven tid mtt i
+*                  millisekunder. Timern startas inte frrn funktionen
+*                  soft_timer_start anropas. Timer 1 initieras vid frsta
+*                  anropet.
+*
+*                  - self    : Pekare till timern som ska initieras.
+*                  - time_ms : Periodtiden mtt i millisekunder.
+*                  - callback: Callback-rutin som anropas nr timern lper ut.
+********************************************************************************/
+void soft_timer_init(struct soft_timer* self,
+                     const double time_ms,
+                     void (*callback)(void))
+{
+   soft_timer_init_circuit();
+   self->deadline = 0;
+   self->period = soft_timer_get_ticks(time_ms);
+   self->callback = callback;
+   self->next = 0;
+   self->running = false;
+   return;
+}
+
+/********************************************************************************
+* soft_timer_start: Startar angiven timer, som lper ut en period efter anropet.
+*                   Om timern redan r aktiv sker ingen frndring.
+*
+*                   - self: Pekare till timern som ska startas.
+********************************************************************************/
+void soft_timer_start(struct soft_timer* self)
+{
+   const uint8_t sreg = atomic_begin();
+
+   if (!self->running)
+   {
+      soft_timer_update_time();
+      self->deadline = base_time + self->period;
+      soft_timer_insert(self);
+      soft_timer_program_next();
+   }
+
+   atomic_end(sreg);
+   return;
+}
+
+/********************************************************************************
+* soft_timer_stop: Stoppar angiven timer. Funktionen kan anropas frn timerns
+*                  egen callback-rutin fr att enbart utlsa timern en gng.
+*
+*                  - self: Pekare till timern som ska stoppas.
+********************************************************************************/
+void soft_timer_stop(struct soft_timer* self)
+{
+   const uint8_t sreg = atomic_begin();
+
+   if (self->running)
+   {
+      soft_timer_remove(self);
+      soft_timer_program_next();
+   }
+
+   atomic_end(sreg);
+   return;
+}
+
+/********************************************************************************
+* soft_timer_toggle: Togglar angiven timer. Om timern r aktiv vid anrop sker
+*                    stopp, annars sker start.
+*
+*                    - self: Pekare till timern som ska togglas.
+********************************************************************************/
+void soft_timer_toggle(struct soft_timer* self)
+{
+   if (soft_timer_running(self))
+   {
+      soft_timer_stop(self);
+   }
+   else
+   {
+      soft_timer_start(self);
+   }
+   return;
+}
+
+/********************************************************************************
+* soft_timer_set_new_time: Stter ny periodtid p angiven timer. Om timern r
+*                          aktiv startas den om med den nya perioden.
+*
+*                          - self   : Pekare till timern vars tid ska uppdateras.
+*                          - time_ms: Ny periodtid mtt i millisekunder.
+********************************************************************************/
+void soft_timer_set_new_time(struct soft_timer* self,
+                             const double time_ms)
+{
+   const uint32_t period = soft_timer_get_ticks(time_ms);
+   const uint8_t sreg = atomic_begin();
+
+   self->period = period;
+
+   if (self->running)
+   {
+      soft_timer_remove(self);
+      soft_timer_update_time();
+      self->deadline = base_time + self->period;
+      soft_timer_insert(self);
+      soft_timer_program_next();
+   }
+
+   atomic_end(sreg);
+   return;
+}
+
+/********************************************************************************
+* soft_timer_time: Returnerar aktuell tid mtt i tick (4 us) sedan Timer 1
+*                  initierades.
+********************************************************************************/
+uint32_t soft_timer_time(void)
+{
+   const uint8_t sreg = atomic_begin();
+   soft_timer_update_time();
+   const uint32_t time = base_time;
+   atomic_end(sreg);
+   return time;
+}
+
+/********************************************************************************
+* soft_timer_run: Anropar callback-rutinen fr samtliga timers som har lpt ut
+*                 och stter drefter jmfrelseregistret till tidpunkten fr
+*                 nsta utlsning.
+*
+*                 1. Aktuell tid uppdateras utifrn Timer 1.
+*
+*                 2. S lnge frsta timern i kn har lpt ut plockas den ut,
+*                    ny utlsningstidpunkt en period senare berknas och
+*                    timern sorteras in i kn igen. Drefter anropas timerns
+*                    callback-rutin, som drmed kan stoppa timern. Om timern
+*                    ligger mer n en period efter startas perioden om frn
+*                    aktuell tid, s att missade utlsningar inte tas igen
+*                    i en fljd.
+*
+*                 3. Jmfrelseregistret stts till nsta utlsningstidpunkt.
+*
+*                 Kn hanteras med avbrott inaktiverade, d callback-rutinerna
+*                 kan teraktivera avbrott.
+********************************************************************************/
+void soft_timer_run(void)
+{
+   while (1)
+   {
+      const uint8_t sreg = atomic_begin();
+      soft_timer_update_time();
+
+      struct soft_timer* self = queue;
+
+      if (!self || (int32_t)(self->deadline - base_time) > 0)
+      {
+         soft_timer_program_next();
+         atomic_end(sreg);
+         return;
+      }
+
+      soft_timer_remove(self);
+      self->deadline += self->period;
+
+      if ((int32_t)(self->deadline - base_time) <= 0)
+      {
+         self->deadline = base_time + self->period;
+      }
+
+      soft_timer_insert(self);
+      atomic_end(sreg);
+
+      self->callback();
+   }
+}
+
+/********************************************************************************
+* soft_timer_init_circuit: Initierar Timer 1 i Normal Mode med prescaler 64,
+*                          dr timern rknar kontinuerligt. Avbrottet fr
+*                          Timer 1 aktiveras frst nr en timer startas, medan
+*                          avbrott aktiveras globalt i main.c.
+********************************************************************************/
+static void soft_timer_init_circuit(void)
+{
+   if (initialized) return;
+   TCCR1A = 0x00;
+   TCCR1B = (1 << CS11) | (1 << CS10);
+   TIMSK1 &= ~(1 << OCIE1A);
+   base_count = TCNT1;
+   initialized = true;
+   return;
+}
+
+/********************************************************************************
+* soft_timer_update_time: Uppdaterar aktuell tid utifrn hur lngt Timer 1 har
+*                         rknat sedan fregende uppdatering. Mste anropas
+*                         med avbrott inaktiverade.
+********************************************************************************/
+static void soft_timer_update_time(void)
+{
+   const uint16_t count = TCNT1;
+   base_time += (uint16_t)(count - base_count);
+   base_count = count;
+   return;
+}
+
+/********************************************************************************
+* soft_timer_insert: Sorterar in angiven timer i kn efter utlsningstidpunkt.
+*                    Timers med samma tidpunkt lser ut i den ordning de
+*                    sorterades in. Mste anropas med avbrott inaktiverade.
+*
+*                    - self: Pekare till timern som ska sorteras in.
+********************************************************************************/
+static void soft_timer_insert(struct soft_timer* self)
+{
+   struct soft_timer** i = &queue;
+
+   while (*i && (int32_t)((*i)->deadline - self->deadline) <= 0)
+   {
+      i = &(*i)->next;
+   }
+
+   self->next = *i;
+   *i = self;
+   self->running = true;
+   return;
+}
+
+/********************************************************************************
+* soft_timer_remove: Plockar ut angiven timer ur kn. Mste anropas med
+*                    avbrott inaktiverade.
+*
+*                    - self: Pekare till timern som ska plockas ut.
+********************************************************************************/
+static void soft_timer_remove(struct soft_timer* self)
+{
+   for (struct soft_timer** i = &queue; *i; i = &(*i)->next)
+   {
+      if (*i == self)
+      {
+         *i = self->next;
+         break;
+      }
+   }
+
+   self->next = 0;
+   self->running = false;
+   return;
+}
+
+/********************************************************************************
+* soft_timer_program_next: Stter jmfrelseregistret OCR1A till tidpunkten fr
+*                          nsta utlsning, dock minst SOFT_TIMER_MIN_DELTA och
+*                          hgst SOFT_TIMER_MAX_DELTA tick framt i tiden. Om
+*                          kn r tom inaktiveras avbrott p Timer 1. Mste
+*                          anropas med avbrott inaktiverade.
+********************************************************************************/
+static void soft_timer_program_next(void)
+{
+   if (!queue)
+   {
+      TIMSK1 &= ~(1 << OCIE1A);
+      return;
+   }
+
+   soft_timer_update_time();
+   int32_t delta = (int32_t)(queue->deadline - base_time);
+
+   if (delta < SOFT_TIMER_MIN_DELTA) delta = SOFT_TIMER_MIN_DELTA;
+   else if (delta > SOFT_TIMER_MAX_DELTA) delta = SOFT_TIMER_MAX_DELTA;
+
+   OCR1A = (uint16_t)(base_count + (uint16_t)delta);
+   TIMSK1 |= (1 << OCIE1A);
+   return;
+}
+
+/********************************************************************************
+* soft_timer_get_ticks: Returnerar antalet tick som motsvarar angiven tid,
+*                       avrundat till nrmaste heltal (minst ett tick).
+*
+*                       - time_ms: nskad tid mtt i millisekunder.
+********************************************************************************/
+static inline uint32_t soft_timer_get_ticks(const double time_ms)
+{
+   const uint32_t ticks = (uint32_t)(time_ms * SOFT_TIMER_TICKS_PER_MS + 0.5);
+   return ticks ? ticks : 1;
+}
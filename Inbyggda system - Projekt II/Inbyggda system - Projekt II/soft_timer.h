@@ -0,0 +1,131 @@
+/********************************************************************************
+* soft_timer.h: Innehller drivrutiner fr mjukvarutimers via strukten
+*               soft_timer samt associerade funktioner. Godtyckligt antal
+*               mjukvarutimers delar p en enda hrdvarutimer (Timer 1), dr
+*               aktiva timers lagras i en k sorterad efter utlsningstidpunkt.
+*               Jmfrelseregistret OCR1A stts alltid till tidpunkten fr
+*               nsta utlsning, vilket innebr att avbrott enbart sker nr
+*               en timer faktiskt lper ut (tickless), i stllet fr med ett
+*               fast intervall.
+*
+*               Timer 1 krs i Normal Mode med prescaler 64, vilket ger en
+*               upplsning p 4 us. Lngre tider n ett varv p Timer 1
+*               (262 ms) hanteras genom att ett mellanliggande avbrott sker
+*               minst var 131:e ms s lnge ngon timer r aktiv. Timer 1 r
+*               drmed reserverad fr mjukvarutimers och fr inte konfigureras
+*               om av annan kod. Timer 0 anvnds enbart fr mtning av
+*               avbrottsrutinernas exekveringstid nr ISR_PROFILE r
+*               aktiverad (se isr_profile.h), medan Timer 2 r oanvnd. Bda
+*               stngs annars av via PRR, se idle.h.
+*
+*               Vid anvndning av mjukvarutimers, anropa funktionen
+*               soft_timer_run i avbrottsrutinen fr Timer 1 ssom visas nedan:
+*
+*               ISR (TIMER1_COMPA_vect)
+*               {
+*                  soft_timer_run();
+*                  return;
+*               }
+*
+*               Callback-rutinerna anropas frn avbrottsrutinen och br drmed
+*               vara korta.
+********************************************************************************/
+#ifndef SOFT_TIMER_H_
+#define SOFT_TIMER_H_
+
+/* Inkluderingsdirektiv: */
+#include "misc.h"
+
+/* Makrodefinitioner: */
+#define SOFT_TIMER_PRESCALER    64                                      /* Prescaler fr Timer 1. */
+#define SOFT_TIMER_TICKS_PER_MS (F_CPU / SOFT_TIMER_PRESCALER / 1000UL) /* Tick per millisekund (250). */
+
+/********************************************************************************
+* soft_timer: Strukt fr implementering av periodiska mjukvarutimers. Varje
+*             gng timern lper ut anropas angiven callback-rutin, varefter
+*             timern startas om med samma period tills den stoppas.
+********************************************************************************/
+struct soft_timer
+{
+   uint32_t deadline;          /* Tidpunkt fr nsta utlsning mtt i tick. */
+   uint32_t period;            /* Periodtid mtt i tick. */
+   void (*callback)(void);     /* Callback-rutin som anropas vid utlsning. */
+   struct soft_timer* next;    /* Pekare till nsta timer i kn. */
+   volatile bool running;      /* Indikerar ifall timern r aktiv (ligger i kn). */
+};
+
+/********************************************************************************
+* soft_timer_init: Initierar ny mjukvarutimer med angiven tid mtt i
+*                  millisekunder. Timern startas inte frrn funktionen
+*                  soft_timer_start anropas. Timer 1 initieras vid frsta
+*                  anropet.
+*
+*                  - self    : Pekare till timern som ska initieras.
+*                  - time_ms : Periodtiden mtt i millisekunder.
+*                  - callback: Callback-rutin som anropas nr timern lper ut.
+********************************************************************************/
+void soft_timer_init(struct soft_timer* self,
+                     const double time_ms,
+                     void (*callback)(void));
+
+/********************************************************************************
+* soft_timer_start: Startar angiven timer, som lper ut en period efter anropet.
+*                   Om timern redan r aktiv sker ingen frndring.
+*
+*                   - self: Pekare till timern som ska startas.
+********************************************************************************/
+void soft_timer_start(struct soft_timer* self);
+
+/********************************************************************************
+* soft_timer_stop: Stoppar angiven timer. Funktionen kan anropas frn timerns
+*                  egen callback-rutin fr att enbart utlsa timern en gng.
+*
+*                  - self: Pekare till timern som ska stoppas.
+********************************************************************************/
+void soft_timer_stop(struct soft_timer* self);
+
+/********************************************************************************
+* soft_timer_running: Indikerar ifall angiven timer r aktiv. I s fall
+*                     returneras true, annars false.
+*
+*                     - self: Pekare till timern som ska kontrolleras.
+********************************************************************************/
+static inline bool soft_timer_running(const struct soft_timer* self)
+{
+   return self->running;
+}
+
+/********************************************************************************
+* soft_timer_toggle: Togglar angiven timer. Om timern r aktiv vid anrop sker
+*                    stopp, annars sker start.
+*
+*                    - self: Pekare till timern som ska togglas.
+********************************************************************************/
+void soft_timer_toggle(struct soft_timer* self);
+
+/********************************************************************************
+* soft_timer_set_new_time: Stter ny periodtid p angiven timer. Om timern r
+*                          aktiv startas den om med den nya perioden.
+*
+*                          - self   : Pekare till timern vars tid ska uppdateras.
+*                          - time_ms: Ny periodtid mtt i millisekunder.
+********************************************************************************/
+void soft_timer_set_new_time(struct soft_timer* self,
+                             const double time_ms);
+
+/********************************************************************************
+* soft_timer_time: Returnerar aktuell tid mtt i tick (4 us) sedan Timer 1
+*                  initierades. Tiden fortskrider enbart korrekt medan minst
+*                  en timer r aktiv.
+********************************************************************************/
+uint32_t soft_timer_time(void);
+
+/********************************************************************************
+* soft_timer_run: Anropar callback-rutinen fr samtliga timers som har lpt ut
+*                 och stter drefter jmfrelseregistret till tidpunkten fr
+*                 nsta utlsning. Funktionen ska anropas i avbrottsrutinen
+*                 fr Timer 1 (TIMER1_COMPA_vect).
+********************************************************************************/
+void soft_timer_run(void);
+
+#endif /* SOFT_TIMER_H_ */
@@ -0,0 +1,130 @@
+/********************************************************************************
+* stack.c: Innehller funktionsdefinitioner fr vervakning av stackens
+*          strsta djup samt RAM-anvndningen.
+********************************************************************************/
+#include "stack.h"
+
+/* Makrodefinitioner: */
+#define STACK_SCAN_PERIOD_TICKS ((uint32_t)STACK_SCAN_PERIOD_MS * SOFT_TIMER_TICKS_PER_MS) /* Period mtt i tick. */
+
+/********************************************************************************
+* Statiska variabler:
+*
+*   - lowest   : Lgsta adress som stacken har ntt enligt senaste
+*                genomskningen (RAMEND + 1 innan stacken har anvnts).
+*   - last_scan: Tidpunkt fr senaste genomskningen mtt i tick.
+********************************************************************************/
+static uint16_t lowest = RAMEND + 1;
+static uint32_t last_scan = 0;
+
+/********************************************************************************
+* stack_init: Fyller det lediga RAM-minnet mellan de statiska variablerna och
+*             aktuell stackpekare med STACK_PAINT_PATTERN. Stackpekaren pekar
+*             p nsta lediga byte, varfr ven denna fylls. Avbrott
+*             inaktiveras under tiden, s att ingen avbrottsrutin anvnder
+*             stacken under stackpekaren medan minnet fylls.
+********************************************************************************/
+void stack_init(void)
+{
+   const uint8_t sreg = atomic_begin();
+
+   const uint16_t top = SP;
+
+   for (uint16_t address = STACK_DATA_END; address <= top; ++address)
+   {
+      STACK_RAM(address) = STACK_PAINT_PATTERN;
+   }
+
+   lowest = top + 1;
+   atomic_end(sreg);
+   return;
+}
+
+/********************************************************************************
+* stack_run: Sker igenom RAM-minnet efter stackens strsta djup ifall
+*            perioden STACK_SCAN_PERIOD_MS har lpt ut sedan fregende
+*            genomskning.
+********************************************************************************/
+void stack_run(void)
+{
+   const uint32_t time = soft_timer_time();
+
+   if (time - last_scan >= STACK_SCAN_PERIOD_TICKS)
+   {
+      last_scan = time;
+      stack_scan();
+   }
+   return;
+}
+
+/********************************************************************************
+* stack_scan: Sker omedelbart igenom RAM-minnet efter stackens strsta djup
+*             och returnerar detta mtt i byte. Skningen sker nedifrn frn
+*             slutet p de statiska variablerna upp till fregende lgsta
+*             adress, dr frsta byte som inte innehller mnstret utgr
+*             stackens nya lgsta adress. Skningen sker med avbrott
+*             aktiverade, d stacken enbart kan vxa nedt mot det skta
+*             omrdet och en byte som skrivs ver under skningen drmed
+*             upptcks senast vid nsta genomskning.
+********************************************************************************/
+uint16_t stack_scan(void)
+{
+   for (uint16_t address = STACK_DATA_END; address < lowest; ++address)
+   {
+      if (STACK_RAM(address) != STACK_PAINT_PATTERN)
+      {
+         lowest = address;
+         break;
+      }
+   }
+
+   return stack_max_usage();
+}
+
+/********************************************************************************
+* stack_static_size: Returnerar storleken p de statiska variablerna (.data
+*                    samt .bss) mtt i byte.
+********************************************************************************/
+uint16_t stack_static_size(void)
+{
+   return STACK_DATA_END - RAMSTART;
+}
+
+/********************************************************************************
+* stack_max_usage: Returnerar stackens strsta djup sedan start mtt i byte,
+*                  enligt senaste genomskningen.
+********************************************************************************/
+uint16_t stack_max_usage(void)
+{
+   return RAMEND + 1 - lowest;
+}
+
+/********************************************************************************
+* stack_free_min: Returnerar minsta lediga RAM-minne mellan de statiska
+*                 variablerna och stacken sedan start mtt i byte, enligt
+*                 senaste genomskningen.
+********************************************************************************/
+uint16_t stack_free_min(void)
+{
+   return lowest - STACK_DATA_END;
+}
+
+/********************************************************************************
+* stack_print: Sker igenom RAM-minnet och skriver ut totalt RAM-minne,
+*              statiska variabler, stackens strsta djup samt minsta lediga
+*              RAM-minne mtt i byte via seriell verfring.
+********************************************************************************/
+void stack_print(void)
+{
+   stack_scan();
+   serial_print_string("ram=");
+   serial_print_unsigned(RAMEND + 1 - RAMSTART);
+   serial_print_string(" static=");
+   serial_print_unsigned(stack_static_size());
+   serial_print_string(" stack_max=");
+   serial_print_unsigned(stack_max_usage());
+   serial_print_string(" free_min=");
+   serial_print_unsigned(stack_free_min());
+   serial_print_new_line();
+   return;
+}
@@ -0,0 +1,106 @@
+/********************************************************************************
+* stack.h: Innehller vervakning av stackens strsta djup (high-water mark)
+*          samt RAM-anvndningen p ATmega328P (2 kB RAM), dr stacken vxer
+*          nedt frn RAMEND mot slutet p de statiska variablerna (.data
+*          samt .bss). Avbrottsrutiner kan nstlas, exempelvis d tryck-
+*          knapparnas avbrottsrutin startar en mjukvarutimer, varfr stackens
+*          strsta djup inte kan avgras i frvg.
+*
+*          Vid start fylls det lediga RAM-minnet mellan de statiska
+*          variablerna och stackpekaren med mnstret STACK_PAINT_PATTERN via
+*          funktionen stack_init, som ska anropas frst i main. Funktionen
+*          stack_run, som ska anropas frn huvudloopen, sker sedan med
+*          perioden STACK_SCAN_PERIOD_MS igenom minnet nedifrn efter frsta
+*          byte som har skrivits ver, vilket utgr stackens lgsta adress
+*          hittills. Stackens strsta djup samt minsta lediga RAM-minne
+*          sedan start kan drefter lsas av via funktionerna nedan, eller
+*          skrivas ut via funktionen stack_print (kommandot stack, se
+*          command.h), exempelvis:
+*
+*          ram=2048 static=418 stack_max=164 free_min=1466
+*
+*          Stackanvndning fre anropet av stack_init (ngra byte i main)
+*          samt byte i stacken som rkar skrivas med samma vrde som mnstret
+*          ingr inte, varfr strsta djup br betraktas med viss marginal.
+*
+*          Statiska RAM-minnet per modul skrivs ut vid varje bygge via
+*          projektets post-build-steg (avr-size samt avr-nm) till filen
+*          <projektnamn>.ram.txt i katalogen fr bygget, dr summan av
+*          kolumnerna data och bss fr varje objektfil utgr modulens
+*          statiska RAM-minne.
+********************************************************************************/
+#ifndef STACK_H_
+#define STACK_H_
+
+/* Inkluderingsdirektiv: */
+#include "misc.h"
+#include "serial.h"
+#include "soft_timer.h"
+
+/* Makrodefinitioner: */
+#define STACK_PAINT_PATTERN 0xC5 /* Mnster fr oanvnt RAM-minne. */
+
+#ifndef STACK_SCAN_PERIOD_MS
+#define STACK_SCAN_PERIOD_MS 1000 /* Tid mellan tv genomskningar mtt i ms. */
+#endif
+
+/********************************************************************************
+* STACK_RAM     : tkomst till angiven adress i RAM-minnet.
+* STACK_DATA_END: Adressen direkt efter de statiska variablerna, det vill
+*                 sga brjan p heapen (__heap_start), som inte anvnds.
+*
+* Vid host build erstts dessa av det simulerade RAM-minnet, se host.h.
+********************************************************************************/
+#ifndef STACK_RAM
+extern uint8_t __heap_start;
+#define STACK_RAM(address) (*(volatile uint8_t*)(address))
+#define STACK_DATA_END     ((uint16_t)&__heap_start)
+#endif
+
+/********************************************************************************
+* stack_init: Fyller det lediga RAM-minnet mellan de statiska variablerna och
+*             aktuell stackpekare med STACK_PAINT_PATTERN. Ska anropas frst
+*             i main, innan avbrott aktiveras.
+********************************************************************************/
+void stack_init(void);
+
+/********************************************************************************
+* stack_run: Sker igenom RAM-minnet efter stackens strsta djup ifall
+*            perioden STACK_SCAN_PERIOD_MS har lpt ut sedan fregende
+*            genomskning. Ska anropas kontinuerligt frn huvudloopen.
+********************************************************************************/
+void stack_run(void);
+
+/********************************************************************************
+* stack_scan: Sker omedelbart igenom RAM-minnet efter stackens strsta djup
+*             och returnerar detta mtt i byte.
+********************************************************************************/
+uint16_t stack_scan(void);
+
+/********************************************************************************
+* stack_static_size: Returnerar storleken p de statiska variablerna (.data
+*                    samt .bss) mtt i byte.
+********************************************************************************/
+uint16_t stack_static_size(void);
+
+/********************************************************************************
+* stack_max_usage: Returnerar stackens strsta djup sedan start mtt i byte,
+*                  enligt senaste genomskningen.
+********************************************************************************/
+uint16_t stack_max_usage(void);
+
+/********************************************************************************
+* stack_free_min: Returnerar minsta lediga RAM-minne mellan de statiska
+*                 variablerna och stacken sedan start mtt i byte, enligt
+*                 senaste genomskningen.
+********************************************************************************/
+uint16_t stack_free_min(void);
+
+/********************************************************************************
+* stack_print: Sker igenom RAM-minnet och skriver ut totalt RAM-minne,
+*              statiska variabler, stackens strsta djup samt minsta lediga
+*              RAM-minne mtt i byte via seriell verfring.
+********************************************************************************/
+void stack_print(void);
+
+#endif /* STACK_H_ */
@@ -0,0 +1,276 @@
+/********************************************************************************
+* telemetry.c: Innehller funktionsdefinitioner fr den binra telemetri-
+*              strmmen via seriell verfring.
+********************************************************************************/
+#include "telemetry.h"
+
+/* Makrodefinitioner: */
+#define TELEMETRY_PERIOD_TICKS ((uint32_t)TELEMETRY_PERIOD_MS * SOFT_TIMER_TICKS_PER_MS) /* Period mtt i tick. */
+
+/********************************************************************************
+* Globala variabler:
+*
+*   - telemetry_isr_counter : Antal anrop per avbrottsvektor sedan start.
+*   - telemetry_isr_time_max: Lngsta exekveringstid fr avbrottsrutinen fr
+*                             Timer 1 sedan fregende paket mtt i tick.
+********************************************************************************/
+volatile uint32_t telemetry_isr_counter[TELEMETRY_ISR_COUNT];
+volatile uint16_t telemetry_isr_time_max = 0;
+
+/********************************************************************************
+* Statiska variabler:
+*
+*   - enabled    : Indikerar ifall telemetrin r aktiverad.
+*   - frame      : Kodat paket som vntar p plats i sndbufferten.
+*   - pending    : Antal byte i det vntande paketet (0 = inget paket).
+*   - sequence   : Sekvensnummer fr nsta paket.
+*   - last_packet: Tidpunkt d fregende paket skapades mtt i tick.
+*   - last_loop  : Tidpunkt fr fregende varv i huvudloopen mtt i tick.
+*   - loop_max   : Lngsta varv i huvudloopen under perioden mtt i tick.
+*   - loops      : Antal varv i huvudloopen under perioden.
+********************************************************************************/
+static bool enabled = false;
+static uint8_t frame[TELEMETRY_FRAME_SIZE];
+static uint8_t pending = 0;
+static uint16_t sequence = 0;
+static uint32_t last_packet = 0;
+static uint32_t last_loop = 0;
+static uint16_t loop_max = 0;
+static uint32_t loops = 0;
+
+/********************************************************************************
+* Statiska funktioner:
+********************************************************************************/
+static void telemetry_create_packet(const uint32_t time);
+static uint8_t* telemetry_put(uint8_t* s,
+                              uint32_t value,
+                              const uint8_t size);
+static uint8_t telemetry_encode(const uint8_t* data,
+                                const uint8_t size,
+                                uint8_t* output);
+
+/********************************************************************************
+* telemetry_init: Aktiverar telemetrin, dr frsta paketet skickas en period
+*                 efter anropet. Seriell verfring mste ha initierats innan.
+********************************************************************************/
+void telemetry_init(void)
+{
+   last_loop = soft_timer_time();
+   loop_max = 0;
+   loops = 0;
+   telemetry_enable();
+   return;
+}
+
+/********************************************************************************
+* telemetry_enabled: Indikerar ifall telemetrin r aktiverad.
+********************************************************************************/
+bool telemetry_enabled(void)
+{
+   return enabled;
+}
+
+/********************************************************************************
+* telemetry_enable: Aktiverar telemetrin, dr nsta paket skickas en period
+*                   efter anropet. Statistiken fr huvudloopen nollstlls, s
+*                   att frsta paketet enbart avser perioden efter anropet.
+********************************************************************************/
+void telemetry_enable(void)
+{
+   if (enabled) return;
+   last_packet = soft_timer_time();
+   loop_max = 0;
+   loops = 0;
+   enabled = true;
+   return;
+}
+
+/********************************************************************************
+* telemetry_disable: Inaktiverar telemetrin. Ett paket som vntar p plats i
+*                    sndbufferten frkastas.
+********************************************************************************/
+void telemetry_disable(void)
+{
+   enabled = false;
+   pending = 0;
+   return;
+}
+
+/********************************************************************************
+* telemetry_toggle: Togglar aktivering av telemetrin.
+********************************************************************************/
+void telemetry_toggle(void)
+{
+   if (enabled)
+   {
+      telemetry_disable();
+   }
+   else
+   {
+      telemetry_enable();
+   }
+   return;
+}
+
+/********************************************************************************
+* telemetry_run: Uppdaterar tidsstatistiken fr huvudloopen och skickar ett
+*                telemetripaket ifall perioden har lpt ut.
+*
+*                1. Tiden sedan fregende anrop lagras som lngsta varv i
+*                   huvudloopen ifall den verstiger tidigare varv, dr tider
+*                   ver 65535 tick mttas.
+*
+*                2. Nr perioden har lpt ut skapas ett nytt paket, varvid
+*                   statistiken fr perioden nollstlls. Nsta period rknas
+*                   frn fregende periods slut, s att perioden inte glider.
+*
+*                3. Ett vntande paket skickas i sin helhet ifall det ryms i
+*                   sndbufferten, annars grs ett nytt frsk nsta varv.
+********************************************************************************/
+void telemetry_run(void)
+{
+   const uint32_t time = soft_timer_time();
+   const uint32_t loop_time = time - last_loop;
+
+   last_loop = time;
+   loops++;
+
+   if (loop_time > loop_max)
+   {
+      loop_max = loop_time > UINT16_MAX ? UINT16_MAX : (uint16_t)loop_time;
+   }
+
+   if (!enabled) return;
+
+   if (!pending && time - last_packet >= TELEMETRY_PERIOD_TICKS)
+   {
+      last_packet += TELEMETRY_PERIOD_TICKS;
+      if (time - last_packet >= TELEMETRY_PERIOD_TICKS) last_packet = time;
+      telemetry_create_packet(time);
+   }
+
+   if (pending && serial_try_write(frame, pending) == 0)
+   {
+      pending = 0;
+   }
+   return;
+}
+
+/********************************************************************************
+* telemetry_create_packet: Skapar ett nytt paket enligt formatet i telemetry.h
+*                          och lagrar det kodat i den statiska bufferten frame.
+*                          Avbrottsrknarna kopieras med avbrott inaktiverade,
+*                          s att samtliga rknare avser samma tidpunkt.
+*
+*                          - time: Aktuell tid mtt i tick.
+********************************************************************************/
+static void telemetry_create_packet(const uint32_t time)
+{
+   uint8_t packet[TELEMETRY_PAYLOAD_SIZE];
+   uint32_t isr_counter[TELEMETRY_ISR_COUNT];
+   uint8_t flags = 0;
+   uint8_t* s = packet;
+
+   /* Rknarna kopieras och lngsta exekveringstid nollstlls tillsammans: */
+   const uint8_t sreg = atomic_begin();
+
+   for (uint8_t i = 0; i < TELEMETRY_ISR_COUNT; ++i)
+   {
+      isr_counter[i] = telemetry_isr_counter[i];
+   }
+
+   const uint16_t isr_time_max = telemetry_isr_time_max;
+   telemetry_isr_time_max = 0;
+   atomic_end(sreg);
+
+   if (display_count_enabled()) flags |= (1 << TELEMETRY_FLAG_COUNT);
+   if (display_get_count_direction() == DISPLAY_COUNT_DIRECTION_DOWN) flags |= (1 << TELEMETRY_FLAG_COUNT_DOWN);
+   if (display_output_enabled()) flags |= (1 << TELEMETRY_FLAG_OUTPUT);
+   if (power_low()) flags |= (1 << TELEMETRY_FLAG_POWER_LOW);
+
+   s = telemetry_put(s, TELEMETRY_VERSION, 1);
+   s = telemetry_put(s, sequence++, 2);
+   s = telemetry_put(s, time, 4);
+   s = telemetry_put(s, display_get_number(), 4);
+   s = telemetry_put(s, display_get_radix(), 1);
+   s = telemetry_put(s, flags, 1);
+
+   for (uint8_t i = 0; i < TELEMETRY_ISR_COUNT; ++i)
+   {
+      s = telemetry_put(s, isr_counter[i], TELEMETRY_COUNTER_SIZE);
+   }
+
+   s = telemetry_put(s, isr_time_max, 2);
+   s = telemetry_put(s, loop_max, 2);
+   s = telemetry_put(s, loops, 4);
+   s = telemetry_put(s, serial_dropped(), 4);
+   s = telemetry_put(s, serial_receive_dropped(), 4);
+   s = telemetry_put(s, crc16(packet, (uint16_t)(s - packet)), 2);
+
+   loop_max = 0;
+   loops = 0;
+
+   frame[0] = 0x00;
+   pending = telemetry_encode(packet, (uint8_t)(s - packet), frame + 1) + 1;
+   frame[pending++] = 0x00;
+   return;
+}
+
+/********************************************************************************
+* telemetry_put: Lagrar angivet vrde med minst signifikant byte frst och
+*                returnerar adressen efter sista lagrade byte.
+*
+*                - s    : Pekare till adressen dr vrdet ska lagras.
+*                - value: Vrdet som ska lagras.
+*                - size : Antal byte som ska lagras (1 - 4).
+********************************************************************************/
+static uint8_t* telemetry_put(uint8_t* s,
+                              uint32_t value,
+                              const uint8_t size)
+{
+   for (uint8_t i = 0; i < size; ++i)
+   {
+      *s++ = (uint8_t)value;
+      value >>= 8;
+   }
+
+   return s;
+}
+
+/********************************************************************************
+* telemetry_encode: Kodar angivet datablock med COBS och returnerar antalet
+*                   kodade byte, vilket r en byte fler n datablocket.
+*                   Varje nolla erstts med avstndet till nsta nolla (eller
+*                   till blockets slut), dr frsta byten anger avstndet
+*                   till frsta nollan. Datablocket fr vara hgst 253 byte,
+*                   s att inga ytterligare byte behver lggas till.
+*
+*                   - data  : Pekare till datablocket som ska kodas.
+*                   - size  : Datablockets storlek mtt i byte.
+*                   - output: Pekare till bufferten som kodade byte lagras i.
+********************************************************************************/
+static uint8_t telemetry_encode(const uint8_t* data,
+                                const uint8_t size,
+                                uint8_t* output)
+{
+   uint8_t code_index = 0;
+   uint8_t code = 1;
+
+   for (uint8_t i = 0; i < size; ++i)
+   {
+      if (data[i] == 0x00)
+      {
+         output[code_index] = code;
+         code_index += code;
+         code = 1;
+      }
+      else
+      {
+         output[code_index + code] = data[i];
+         code++;
+      }
+   }
+
+   output[code_index] = code;
+   return size + 1;
+}
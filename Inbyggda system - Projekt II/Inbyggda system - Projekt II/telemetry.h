@@ -0,0 +1,187 @@
+/********************************************************************************
+* telemetry.h: Innehller en binr telemetristrm via seriell verfring fr
+*              vervakning av systemet under last, som komplement till
+*              kommandot status i kommandogrnssnittet, se command.h.
+*
+*              Ett telemetripaket skickas med perioden TELEMETRY_PERIOD_MS
+*              via funktionen telemetry_run, som ska anropas frn
+*              huvudloopen. Varje paket innehller aktuellt tal, talbas samt
+*              tillstnd fr displayerna, antalet avbrott per avbrottsvektor
+*              sedan start samt tidsstatistik fr perioden sedan fregende
+*              paket. Samtliga flt lagras med minst signifikant byte frst
+*              (little endian), dr tid anges i tick fr Timer 1 (4 us):
+*
+*              Offset  Storlek  Flt
+*                 0       1     Version (TELEMETRY_VERSION).
+*                 1       2     Sekvensnummer, rknas upp per skickat paket.
+*                 3       4     Tid sedan start mtt i tick.
+*                 7       4     Aktuellt tal p displayerna.
+*                11       1     Aktuell talbas.
+*                12       1     Flaggor, se enum telemetry_flag.
+*                13      24     Antal avbrott per avbrottsvektor sedan start
+*                               (4 byte per vektor i ordningen enligt enum
+*                               telemetry_isr).
+*                37       2     Lngsta exekveringstid fr avbrottsrutinen
+*                               fr Timer 1 under perioden mtt i tick.
+*                39       2     Lngsta varv i huvudloopen under perioden
+*                               mtt i tick.
+*                41       4     Antal varv i huvudloopen under perioden.
+*                45       4     Antal kastade byte vid utskrift sedan start.
+*                49       4     Antal kastade mottagna byte sedan start.
+*                53       2     CRC-16 fr fregende byte, se crc.h.
+*
+*              Offset ovan gller fr sex avbrottsvektorer. Paketets storlek
+*              TELEMETRY_PAYLOAD_SIZE berknas utifrn flten fre och efter
+*              avbrottsrknarna samt antalet vektorer TELEMETRY_ISR_COUNT, s
+*              att en ny vektor i enum telemetry_isr ndrar storleken, varvid
+*              det kontrolleras vid kompilering att paketet fortfarande ryms
+*              i sndbufferten. Avkodaren i tools/telemetry_decode.c mste
+*              drefter uppdateras med samma antal vektorer.
+*
+*              Paketet kodas med COBS (Consistent Overhead Byte Stuffing),
+*              vilket eliminerar samtliga nollor i paketet p bekostnad av en
+*              extra byte. Det kodade paketet skickas mellan tv nollor, s
+*              att mottagaren kan synkronisera mot ramgrnserna direkt och
+*              textsvar frn kommandogrnssnittet mellan tv paket hamnar i
+*              egna ramar, vilka frkastas av mottagaren d kontrollsumman
+*              inte stmmer. Ett fullstndigt paket upptar TELEMETRY_FRAME_SIZE
+*              byte och skickas i sin helhet eller inte alls via funktionen
+*              serial_try_write, dr paketet skickas s snart det ryms i
+*              sndbufferten. Telemetrin blockerar drmed aldrig huvudloopen.
+*
+*              Avbrottsrutinerna rknar sina anrop via funktionen
+*              telemetry_count_isr, medan avbrottsrutinen fr Timer 1 ven
+*              mter sin exekveringstid via funktionen telemetry_time_isr.
+*              Paket kan avkodas p vrddatorn via tools/telemetry_decode.c.
+********************************************************************************/
+#ifndef TELEMETRY_H_
+#define TELEMETRY_H_
+
+/* Inkluderingsdirektiv: */
+#include "misc.h"
+#include "crc.h"
+#include "serial.h"
+#include "display.h"
+#include "power.h"
+#include "soft_timer.h"
+
+/********************************************************************************
+* Makrodefinitioner:
+*
+*   - TELEMETRY_HEADER_SIZE : Flten fre avbrottsrknarna (version,
+*                             sekvensnummer, tid, tal, talbas samt flaggor).
+*   - TELEMETRY_COUNTER_SIZE: Antal byte per avbrottsrknare.
+*   - TELEMETRY_TRAILER_SIZE: Flten efter avbrottsrknarna (tidsstatistik,
+*                             kastade byte samt CRC-16).
+*   - TELEMETRY_PAYLOAD_SIZE: Paketets storlek inklusive CRC-16 (55 byte fr
+*                             sex avbrottsvektorer).
+*   - TELEMETRY_FRAME_SIZE  : Kodat paket inklusive nollor.
+********************************************************************************/
+#define TELEMETRY_VERSION      1
+#define TELEMETRY_HEADER_SIZE  (1 + 2 + 4 + 4 + 1 + 1)
+#define TELEMETRY_COUNTER_SIZE 4
+#define TELEMETRY_TRAILER_SIZE (2 + 2 + 4 + 4 + 4 + 2)
+#define TELEMETRY_PAYLOAD_SIZE \
+   (TELEMETRY_HEADER_SIZE + TELEMETRY_COUNTER_SIZE * TELEMETRY_ISR_COUNT + TELEMETRY_TRAILER_SIZE)
+#define TELEMETRY_FRAME_SIZE   (TELEMETRY_PAYLOAD_SIZE + 3)
+
+#ifndef TELEMETRY_PERIOD_MS
+#define TELEMETRY_PERIOD_MS 1000 /* Tid mellan tv paket mtt i ms. */
+#endif
+
+/********************************************************************************
+* telemetry_isr: Enumeration fr avbrottsvektorerna vars anrop rknas.
+********************************************************************************/
+enum telemetry_isr
+{
+   TELEMETRY_ISR_PCINT0,       /* Tryckknapparna. */
+   TELEMETRY_ISR_TIMER1_COMPA, /* Mjukvarutimers p Timer 1. */
+   TELEMETRY_ISR_EE_READY,     /* Skrivning till EEPROM-minnet. */
+   TELEMETRY_ISR_ANALOG_COMP,  /* Detektering av strmavbrott. */
+   TELEMETRY_ISR_USART_UDRE,   /* Seriell verfring. */
+   TELEMETRY_ISR_USART_RX,     /* Seriell mottagning. */
+   TELEMETRY_ISR_COUNT         /* Antal avbrottsvektorer. */
+};
+
+/* Antalet vektorer r en enumerator, varfr kontrollen sker vid kompilering
+   i stllet fr via preprocessorn: */
+_Static_assert(TELEMETRY_FRAME_SIZE <= SERIAL_TX_BUFFER_SIZE,
+               "Telemetripaketen ryms inte i sndbufferten, ka SERIAL_TX_BUFFER_SIZE!");
+
+/********************************************************************************
+* telemetry_flag: Enumeration fr bitarna i paketets flaggor.
+********************************************************************************/
+enum telemetry_flag
+{
+   TELEMETRY_FLAG_COUNT,      /* Upprkning aktiverad. */
+   TELEMETRY_FLAG_COUNT_DOWN, /* Nedrkning i stllet fr upprkning. */
+   TELEMETRY_FLAG_OUTPUT,     /* Displayerna p. */
+   TELEMETRY_FLAG_POWER_LOW   /* Strmavbrott detekterat. */
+};
+
+/* Rknare som uppdateras av avbrottsrutinerna, se telemetry.c: */
+extern volatile uint32_t telemetry_isr_counter[TELEMETRY_ISR_COUNT];
+extern volatile uint16_t telemetry_isr_time_max;
+
+/********************************************************************************
+* telemetry_count_isr: Rknar upp antalet anrop fr angiven avbrottsvektor.
+*                      Ska anropas frn motsvarande avbrottsrutin.
+*
+*                      - isr: Avbrottsvektorn som har anropats.
+********************************************************************************/
+static inline void telemetry_count_isr(const enum telemetry_isr isr)
+{
+   telemetry_isr_counter[isr]++;
+   return;
+}
+
+/********************************************************************************
+* telemetry_time_isr: Uppdaterar lngsta exekveringstid fr avbrottsrutinen
+*                     fr Timer 1. Ska anropas i slutet av avbrottsrutinen.
+*
+*                     - start: Innehllet i TCNT1 i brjan av avbrottsrutinen.
+********************************************************************************/
+static inline void telemetry_time_isr(const uint16_t start)
+{
+   const uint16_t time = TCNT1 - start;
+   if (time > telemetry_isr_time_max) telemetry_isr_time_max = time;
+   return;
+}
+
+/********************************************************************************
+* telemetry_init: Aktiverar telemetrin, dr frsta paketet skickas en period
+*                 efter anropet. Seriell verfring mste ha initierats innan.
+********************************************************************************/
+void telemetry_init(void);
+
+/********************************************************************************
+* telemetry_enabled: Indikerar ifall telemetrin r aktiverad.
+********************************************************************************/
+bool telemetry_enabled(void);
+
+/********************************************************************************
+* telemetry_enable: Aktiverar telemetrin, dr nsta paket skickas en period
+*                   efter anropet.
+********************************************************************************/
+void telemetry_enable(void);
+
+/********************************************************************************
+* telemetry_disable: Inaktiverar telemetrin. Ett paket som vntar p plats i
+*                    sndbufferten frkastas.
+********************************************************************************/
+void telemetry_disable(void);
+
+/********************************************************************************
+* telemetry_toggle: Togglar aktivering av telemetrin.
+********************************************************************************/
+void telemetry_toggle(void);
+
+/********************************************************************************
+* telemetry_run: Uppdaterar tidsstatistiken fr huvudloopen och skickar ett
+*                telemetripaket ifall perioden har lpt ut. Funktionen vntar
+*                aldrig p sndbufferten och ska anropas en gng per varv i
+*                huvudloopen.
+********************************************************************************/
+void telemetry_run(void);
+
+#endif /* TELEMETRY_H_ */
@@ -1,176 +0,0 @@
-/********************************************************************************
-* timer.h: Innehller drivrutiner fr interruptbaserade timerkretsar via 
-*          strukten timer samt associerade funktioner. Dessa timerkretsar 
-*          fungerar ocks utmrkt att anvnda som rknare.
-********************************************************************************/
-#ifndef TIMER_H_
-#define TIMER_H_
-
-/* Inkluderingsdirektiv: */
-#include "misc.h"
-
-/********************************************************************************
-* timer_sel: Enumeration fr val av timerkrets.
-********************************************************************************/
-enum timer_sel
-{
-   TIMER_SEL_0,   /* Timer 0. */
-   TIMER_SEL_1,   /* Timer 1. */
-   TIMER_SEL_2,   /* Timer 2. */
-   TIMER_SEL_NONE /* Timer ospecificerad. */
-};
-
-/********************************************************************************
-* timer: Strukt fr implementering av interruptbaserade timerkretsar, som
-*        vid behov kan anvndas som rknare.
-********************************************************************************/
-struct timer
-{
-   volatile uint32_t counter; /* 32-bitars rknare. */
-   uint32_t max_count;        /* Maxvrde som upprkning ska ske till. */
-   volatile uint8_t* timsk;   /* Pekare till maskregister fr aktivering av avbrott. */
-   uint8_t timsk_bit;         /* Bit fr aktivering av avbrott i motsvarande maskregister. */
-   enum timer_sel timer_sel;  /* Val av timerkrets. */
-};
-
-/********************************************************************************
-* timer_init: Initierar ny timerkrets med angiven tid mtt i millisekunder.
-*             Om timern ska anvndas som rknare fr att rkna upp till ett
-*             specifikt maxvrde br funktionen timer_set_max_count anropas
-*             direkt efter initieringen.
-*
-*             - self     : Pekare till timern som ska initieras.
-*             - timer_sel: Val av timerkrets.
-*             - time_ms  : Tiden timern ska sttas p mtt i millisekunder.
-********************************************************************************/
-void timer_init(struct timer* self, 
-                const enum timer_sel timer_sel, 
-                const double time_ms);
-
-/********************************************************************************
-* timer_clear: Genomfr total nollstllning av angiven timerkrets.
-*
-*              - self: Pekare till timern som ska nollstllas.
-********************************************************************************/
-void timer_clear(struct timer* self);
-
-/********************************************************************************
-* timer_enable_interrupt: Aktiverar timergenererat avbrott, som ger rum nr
-*                         timern rknar upp till overflow eller specificerat max.
-*
-*                         Timer 0 samt Timer 2 aktiveras i Normal Mode, medan
-*                         Timer 1 aktiveras i CTC Mode med upprkning till 256,
-*                         vilket gr att tiden mellan varje timergenererat
-*                         avbrott r samma oavsett anvnd timerkrets.
-*
-*                         Avbrottsvektorer fr timerkretsarna deklareras nedan:
-*
-*                         Timerkrets     Avbrottsvektor
-*                           Timer 0     TIMER0_OVF_vect
-*                           Timer 1     TIMER1_COMPA_vect
-*                           Timer 2     TIMER2_OVF_vect
-*
-*                         - self: Pekare till timern som timergenererat
-*                                 avbrott ska aktiveras p.
-********************************************************************************/
-static inline void timer_enable_interrupt(struct timer* self)
-{
-   *(self->timsk) |= (1 << self->timsk_bit);
-   return;
-}
-
-/********************************************************************************
-* timer_disable_interrupt: Inaktiverar timergenererat avbrott p angiven timer.
-*
-*                          - self: Pekare till timern som timergenererat
-*                                  avbrott ska inaktiveras p.
-********************************************************************************/
-static inline void timer_disable_interrupt(struct timer* self)
-{
-   *(self->timsk) &= ~(1 << self->timsk_bit);
-   return;
-}
-
-/********************************************************************************
-* timer_toggle_interrupt: Togglar aktivering av timergenererat avbrott p
-*                         angiven timer.
-*
-*                         - self: Pekare till timern som aktivering av 
-*                                 timergenererat avbrott ska togglas p.
-********************************************************************************/
-void timer_toggle_interrupt(struct timer* self);
-
-/********************************************************************************
-* timer_interrupt_enabled: Indikerar ifall timergenererat avbrott r aktiverat
-*                          p angiven timer.
-*
-*                          - self: Pekare till timern vars avbrottstillstnd
-*                                  ska kontrolleras.
-********************************************************************************/
-static inline bool timer_interrupt_enabled(const struct timer* self)
-{
-   return (*(self->timsk) & (1 << self->timsk_bit));
-}
-
-/********************************************************************************
-* timer_count: Rknar upp angiven timer.
-*
-*              - self: Pekare till timern som ska rknas upp.
-********************************************************************************/
-static inline void timer_count(struct timer* self)
-{
-   self->counter++;
-   return;
-}
-
-/********************************************************************************
-* timer_elapsed: Indikerar ifall angiven timer har lpt ut genom att returnera
-*                true eller false. Ifall timern har lpt ut nollstlls rknaren
-*                infr nsta upprkning.
-*
-*                - self: Pekare till timern som ska kontrolleras.
-********************************************************************************/
-bool timer_elapsed(struct timer* self);
-
-/********************************************************************************
-* timer_reset_counter: Nollstller rknaren p angiven timer.
-*
-*                      - self: Pekare till timern vars rknare ska nollstllas.
-********************************************************************************/
-static inline void timer_reset_counter(struct timer* self)
-{
-   self->counter = 0;
-   return;
-}
-
-/********************************************************************************
-* timer_reset: terstller angiven timer till startlget.
-*
-               - self: Pekare till timern som ska terstllas.
-********************************************************************************/
-void timer_reset(struct timer* self);
-
-/********************************************************************************
-* timer_set_new_time: Stter ny tid p angiven timerkrets.
-*
-*                    - self   : Pekare till timern vars tid ska uppdateras.
-*                    - time_ms: Tiden timern ska sttas p mtt i millisekunder.
-********************************************************************************/
-void timer_set_new_time(struct timer* self, 
-                        const double time_ms);
-
-/********************************************************************************
-* timer_set_new_max_count: Stter nytt maxvrde fr upprkning av timern nr
-*                          denna ska anvndas som en rknare.
-*
-*                          - self   : Pekare till timern.
-*                          - max_count: Maxvrde fr upprkningen.
-********************************************************************************/
-static inline void timer_set_max_count(struct timer* self,
-                                       const uint32_t max_count)
-{
-   self->max_count = max_count;
-   return;
-}
-
-#endif /* TIMER_H_ */
\ No newline at end of file
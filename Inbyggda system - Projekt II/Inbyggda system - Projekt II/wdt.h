@@ -33,13 +33,15 @@ enum wdt_timeout
 /********************************************************************************
 * wdt_reset: terstller Watchdog-timern, vilket mste ske kontinuerligt innan
 *            timern lper ut fr att undvika systemterstllning eller avbrott.
+*            Statusregistret terstlls eftert, s att funktionen kan anropas
+*            med avbrott inaktiverade utan att dessa aktiveras.
 ********************************************************************************/
 static inline void wdt_reset(void)
 {
-   asm("CLI");
+   const uint8_t sreg = atomic_begin();
    asm("WDR");
    MCUSR &= ~(1 << WDRF);
-   asm("SEI");
+   atomic_end(sreg);
    return;
 }
 
@@ -50,10 +52,10 @@ static inline void wdt_reset(void)
 ********************************************************************************/
 static inline void wdt_init(const enum wdt_timeout timeout_ms)
 {
-   asm("CLI");
+   const uint8_t sreg = atomic_begin();
    WDTCSR = (1 << WDE) | (1 << WDCE);
    WDTCSR = (1 << WDE) | (uint8_t)(timeout_ms);
-   asm("SEI");
+   atomic_end(sreg);
    WDTCSR &= ~(1 << WDE);
    return;
 }
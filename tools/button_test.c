@@ -0,0 +1,239 @@
+/********************************************************************************
+* button_test.c: Test av tryckknapparna, se isr.c, dr knapptryckningar
+*                simuleras via insignalerna p pin 11 - 13 (PORTB3 - PORTB5)
+*                i host.h. Testet krs p vrddatorn, dr PCI-avbrott p
+*                I/O-port B, avstudsningen via mjukvarutimern samt
+*                upprkningen av talet krs som p mikrodatorn.
+*
+*                Fr varje testfall simuleras en eller flera knapptryckningar,
+*                varefter effekten p upprkning, upprkningsriktning samt
+*                7-segmentsdisplayernas utsignal kontrolleras direkt via
+*                drivrutinerna. Drtill kontrolleras att kontaktstudsar under
+*                avstudsningstiden ignoreras och att PCI-avbrott teraktiveras
+*                nr avstudsningstimern har lpt ut.
+*
+*                Kompilering, frn katalogen med kllfilerna (samtliga
+*                kllfiler utom main.c lnkas):
+*
+*                gcc -O2 -DHOST_BUILD -I . -o button_test ../../tools/button_test.c
+*                    $(ls [a-z]*.c | grep -v main.c)
+*
+*                Anvndning:
+*
+*                ./button_test
+*
+*                Resultatet skrivs ut per testfall, fljt av en sammanfattning
+*                i JSON-format. Om ngot testfall misslyckas returneras 1.
+********************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include "header.h"
+
+/********************************************************************************
+* Makrodefinitioner:
+********************************************************************************/
+#define BUTTON1_PIN       11                /* Tryckknapp fr upprkning (PORTB3). */
+#define BUTTON2_PIN       12                /* Tryckknapp fr upprkningsriktning (PORTB4). */
+#define BUTTON3_PIN       13                /* Tryckknapp fr utsignal (PORTB5). */
+#define DEBOUNCE_MS       300               /* Avstudsningstid mtt i ms, ssom i main.c. */
+#define PRESS_MS          20                /* Tid som knappen hlls nedtryckt mtt i ms. */
+#define BOUNCE_MS         5                 /* Tid mellan kontaktstudsar mtt i ms. */
+#define COUNT_SPEED_MS    10                /* Upprkningshastighet mtt i ms. */
+#define COUNT_RUN_MS      200               /* Krtid fr kontroll av upprkningen mtt i ms. */
+#define CYCLES_PER_MS     (F_CPU / 1000UL)
+
+/********************************************************************************
+* test_case: Strukt fr ett testfall.
+********************************************************************************/
+struct test_case
+{
+   const char* name;    /* Testfallets namn. */
+   bool (*run)(void);   /* Simulering samt kontroll av tillstndet eftert. */
+};
+
+/* Globala variabler som refereras av avbrottsrutinerna: */
+struct button button1;
+struct button button2;
+struct button button3;
+struct soft_timer debounce_timer;
+
+/********************************************************************************
+* debounce_timer_elapsed: Callback-rutin fr avstudsningstimern, ssom i main.c.
+********************************************************************************/
+static void debounce_timer_elapsed(void)
+{
+   soft_timer_stop(&debounce_timer);
+   enable_pin_change_interrupt(IO_PORTB);
+   return;
+}
+
+/********************************************************************************
+* run: Lter simulerad tid fortskrida angivet antal millisekunder.
+*
+*      - time_ms: Krtid mtt i millisekunder.
+********************************************************************************/
+static void run(const uint32_t time_ms)
+{
+   host_run_cycles(time_ms * CYCLES_PER_MS);
+   return;
+}
+
+/********************************************************************************
+* pci_enabled: Indikerar ifall PCI-avbrott r aktiverat p I/O-port B.
+********************************************************************************/
+static bool pci_enabled(void)
+{
+   return PCICR & (1 << IO_PORTB);
+}
+
+/********************************************************************************
+* press: Simulerar en knapptryckning p angiven pin, dr knappen hlls
+*        nedtryckt i PRESS_MS ms och drefter slpps. Drefter krs systemet
+*        tills avstudsningstiden har lpt ut, ven fr PCI-avbrottet som
+*        flaggades nr knappen slpptes.
+*
+*        - pin: Tryckknappens pin-nummer.
+********************************************************************************/
+static void press(const uint8_t pin)
+{
+   host_set_pin(pin, true);
+   run(PRESS_MS);
+   host_set_pin(pin, false);
+   run(DEBOUNCE_MS * 3);
+   return;
+}
+
+/********************************************************************************
+* test_count: Kontrollerar att BUTTON1 aktiverar upprkning av talet och att
+*             nsta tryckning stoppar upprkningen igen.
+********************************************************************************/
+static bool test_count(void)
+{
+   const display_number_t before = display_get_number();
+   bool ok = !display_count_enabled();
+
+   press(BUTTON1_PIN);
+   ok = ok && display_count_enabled();
+   run(COUNT_RUN_MS);
+   ok = ok && display_get_number() != before;
+
+   press(BUTTON1_PIN);
+   const display_number_t stopped = display_get_number();
+   run(COUNT_RUN_MS);
+   return ok && !display_count_enabled() && display_get_number() == stopped;
+}
+
+/********************************************************************************
+* test_direction: Kontrollerar att BUTTON2 togglar upprkningsriktningen,
+*                 vilket ven pverkar upprkningen av talet.
+********************************************************************************/
+static bool test_direction(void)
+{
+   bool ok = display_get_count_direction() == DISPLAY_COUNT_DIRECTION_UP;
+
+   press(BUTTON2_PIN);
+   ok = ok && display_get_count_direction() == DISPLAY_COUNT_DIRECTION_DOWN;
+
+   display_set_number(50);
+   press(BUTTON1_PIN);
+   run(COUNT_RUN_MS);
+   press(BUTTON1_PIN);
+   ok = ok && display_get_number() < 50;
+
+   press(BUTTON2_PIN);
+   return ok && display_get_count_direction() == DISPLAY_COUNT_DIRECTION_UP;
+}
+
+/********************************************************************************
+* test_output: Kontrollerar att BUTTON3 togglar 7-segmentsdisplayernas
+*              utsignal av och p.
+********************************************************************************/
+static bool test_output(void)
+{
+   bool ok = display_output_enabled();
+   press(BUTTON3_PIN);
+   ok = ok && !display_output_enabled();
+   press(BUTTON3_PIN);
+   return ok && display_output_enabled();
+}
+
+/********************************************************************************
+* test_debounce: Kontrollerar att kontaktstudsar vid bde tryckning och
+*                slpp ignoreras under avstudsningstiden, det vill sga att
+*                utsignalen enbart togglas en gng, samt att PCI-avbrott r
+*                inaktiverat under avstudsningstiden och teraktiveras nr
+*                denna har lpt ut.
+********************************************************************************/
+static bool test_debounce(void)
+{
+   const uint32_t isr_before = host_isr_count(PCINT0_vect_num);
+   bool ok = display_output_enabled() && pci_enabled();
+
+   for (uint8_t i = 0; i < 5; ++i)
+   {
+      host_set_pin(BUTTON3_PIN, true);
+      run(BOUNCE_MS);
+      host_set_pin(BUTTON3_PIN, false);
+      run(BOUNCE_MS);
+   }
+
+   ok = ok && !display_output_enabled() && !pci_enabled();
+   ok = ok && host_isr_count(PCINT0_vect_num) == isr_before + 1;
+
+   run(DEBOUNCE_MS / 2);
+   ok = ok && !pci_enabled();
+   run(DEBOUNCE_MS * 3);
+   ok = ok && pci_enabled() && !display_output_enabled();
+
+   press(BUTTON3_PIN);
+   return ok && display_output_enabled() && pci_enabled();
+}
+
+/********************************************************************************
+* tests: Samtliga testfall, som krs i ordning utan omstart emellan.
+********************************************************************************/
+static const struct test_case tests[] =
+{
+   { "count", test_count },
+   { "direction", test_direction },
+   { "output", test_output },
+   { "debounce", test_debounce },
+};
+
+/********************************************************************************
+* main: Initierar systemet ssom i main.c, kr samtliga testfall och skriver
+*       ut resultatet.
+********************************************************************************/
+int main(void)
+{
+   uint32_t failed = 0;
+
+   eeprom_init();
+   display_init();
+   display_enable_output();
+   display_set_count(DISPLAY_COUNT_DIRECTION_UP, COUNT_SPEED_MS);
+   display_disable_count();
+
+   button_init(&button1, BUTTON1_PIN);
+   button_init(&button2, BUTTON2_PIN);
+   button_init(&button3, BUTTON3_PIN);
+
+   button_enable_interrupt(&button1);
+   button_enable_interrupt(&button2);
+   button_enable_interrupt(&button3);
+
+   soft_timer_init(&debounce_timer, DEBOUNCE_MS, debounce_timer_elapsed);
+   atomic_enable();
+
+   for (uint8_t i = 0; i < sizeof(tests) / sizeof(tests[0]); ++i)
+   {
+      const bool ok = tests[i].run();
+      if (!ok) failed++;
+      printf("%s %s\n", ok ? "PASS" : "FAIL", tests[i].name);
+   }
+
+   printf("{\"tests\": %lu, \"failed\": %lu, \"pcint0_isr\": %lu}\n",
+          (unsigned long)(sizeof(tests) / sizeof(tests[0])), (unsigned long)failed,
+          (unsigned long)host_isr_count(PCINT0_vect_num));
+   return failed ? 1 : 0;
+}
@@ -0,0 +1,318 @@
+/********************************************************************************
+* command_test.c: Test av kommandogrnssnittet fr fjrrstyrning av
+*                 7-segmentsdisplayerna, se command.h. Testet krs p
+*                 vrddatorn via de simulerade registren i host.h, dr
+*                 kommandona skickas via den simulerade mottagningen p USART
+*                 i takt med vald baud rate, medan huvudloopen och
+*                 avbrottsrutinerna krs som p mikrodatorn.
+*
+*                 Fr varje testfall skickas ett antal kommandorader, varefter
+*                 svaren frn systemet jmfrs med frvntade svar (utan
+*                 vagnretur) och tillstndet eventuellt kontrolleras direkt
+*                 via drivrutinerna fr displayerna. Drtill kontrolleras att
+*                 inga mottagna tecken har kastats, medan antalet avbrott p
+*                 Timer 1 per ms rapporteras, vilket visar att multiplexningen
+*                 av displayerna har fortgtt under kommandona.
+*
+*                 Kompilering, frn katalogen med kllfilerna (samtliga
+*                 kllfiler utom main.c lnkas):
+*
+*                 gcc -O2 -DHOST_BUILD -I . -o command_test ../../tools/command_test.c
+*                     $(ls [a-z]*.c | grep -v main.c)
+*
+*                 Anvndning:
+*
+*                 ./command_test
+*
+*                 Resultatet skrivs ut per testfall, fljt av en sammanfattning
+*                 i JSON-format. Om ngot testfall misslyckas returneras 1.
+********************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "header.h"
+
+/********************************************************************************
+* Makrodefinitioner:
+********************************************************************************/
+#define BAUD_RATE       9600                 /* verfringshastighet fr kommandona. */
+#define LOOP_CYCLES     (F_CPU / 10000UL)    /* Klockcykler per varv i huvudloopen (0.1 ms). */
+#define SETTLE_LOOPS    200                  /* Varv efter sista mottagna tecken (20 ms). */
+#define OUTPUT_SIZE     1024                 /* Strsta antal tecken i svaren per testfall. */
+
+/********************************************************************************
+* test_case: Strukt fr ett testfall.
+********************************************************************************/
+struct test_case
+{
+   const char* name;       /* Testfallets namn. */
+   const char* input;      /* Kommandorader som skickas. */
+   uint32_t run_ms;        /* Extra krtid efter kommandona mtt i ms. */
+   const char* followup;   /* Kommandorader som skickas efter krtiden (eller 0). */
+   const char* expected;   /* Frvntade svar utan vagnretur (eller 0 = kontrolleras ej). */
+   bool (*check)(void);    /* Kontroll av tillstndet eftert (eller 0). */
+};
+
+/* Globala variabler som refereras av avbrottsrutinerna: */
+struct button button1;
+struct button button2;
+struct button button3;
+struct soft_timer debounce_timer;
+
+/********************************************************************************
+* Statiska variabler:
+*
+*   - capture: Temporr fil som utskriften frn systemet dirigeras om till.
+*   - console: Filbeskrivare fr ursprunglig stdout, fr testresultatet.
+********************************************************************************/
+static FILE* capture = 0;
+static int console = -1;
+
+/********************************************************************************
+* check_counted_down: Kontrollerar att nedrkning har skett frn 255 och att
+*                     upprkningen har stoppats igen.
+********************************************************************************/
+static bool check_counted_down(void)
+{
+   return display_get_number() < 255 && display_get_number() > 200 &&
+          !display_count_enabled() &&
+          display_get_count_direction() == DISPLAY_COUNT_DIRECTION_DOWN;
+}
+
+/********************************************************************************
+* check_output_off: Kontrollerar att displayerna r avstngda.
+********************************************************************************/
+static bool check_output_off(void)
+{
+   return !display_output_enabled();
+}
+
+/********************************************************************************
+* check_telemetry_off: Kontrollerar att telemetrin r inaktiverad.
+********************************************************************************/
+static bool check_telemetry_off(void)
+{
+   return !telemetry_enabled();
+}
+
+/********************************************************************************
+* check_load_display_on: Kontrollerar att processorlasten visas p displayerna
+*                        via felskningslget, medan talet r ofrndrat.
+********************************************************************************/
+static bool check_load_display_on(void)
+{
+   return cpu_load_display_enabled() && display_debug_enabled() &&
+          display_get_number() == 7;
+}
+
+/********************************************************************************
+* check_load_display_off: Kontrollerar att displayerna ter visar talet.
+********************************************************************************/
+static bool check_load_display_off(void)
+{
+   return !cpu_load_display_enabled() && !display_debug_enabled();
+}
+
+/********************************************************************************
+* check_sleep_on: Kontrollerar att vilolget ter r aktiverat.
+********************************************************************************/
+static bool check_sleep_on(void)
+{
+   return idle_sleep_enabled();
+}
+
+/********************************************************************************
+* tests: Samtliga testfall, som krs i ordning utan omstart emellan.
+********************************************************************************/
+static const struct test_case tests[] =
+{
+   { "status", "status\n", 0, 0,
+     "number=0 radix=10 count=0 direction=up output=1 baud=9615 err=0.16\nOK\n", 0 },
+   { "number_crlf", "number 42\r\nstatus\r\n", 0, 0,
+     "OK\nnumber=42 radix=10 count=0 direction=up output=1 baud=9615 err=0.16\nOK\n", 0 },
+   { "number_too_large", "number 100\n", 0, 0, "ERR\n", 0 },
+   { "radix_hex", "radix 16\rnumber 0xff\rstatus\r", 0, 0,
+     "OK\nOK\nnumber=255 radix=16 count=0 direction=up output=1 baud=9615 err=0.16\nOK\n", 0 },
+   { "radix_invalid", "radix 17\nradix 1\nradix\nradix 0x\n", 0, 0,
+     "ERR\nERR\nERR\nERR\n", 0 },
+   { "number_invalid", "number 0x1G\nnumber\nnumber -1\nnumber 99999999999\n", 0, 0,
+     "ERR\nERR\nERR\nERR\n", 0 },
+   { "unknown", "bogus\nstatus now\nNUMBER 1\n", 0, 0, "ERR\nERR\nERR\n", 0 },
+   { "overlong", "number 1234567890123456789012345678901234567890\nstatus\n", 0, 0,
+     "ERR\nnumber=255 radix=16 count=0 direction=up output=1 baud=9615 err=0.16\nOK\n", 0 },
+   { "output", "output off\noutput toggle\noutput toggle\nstatus\n", 0, 0,
+     "OK\nOK\nOK\nnumber=255 radix=16 count=0 direction=up output=0 baud=9615 err=0.16\nOK\n", check_output_off },
+   { "count", "output on\ndirection down\nspeed 10\ncount on\n", 200, "count off\n",
+     "OK\nOK\nOK\nOK\nOK\n", check_counted_down },
+   { "burst", "number 7\nnumber 7\nnumber 7\nnumber 7\nnumber 7\nnumber 7\nnumber 7\n"
+              "number 7\nnumber 7\nnumber 7\nnumber 7\nnumber 7\nnumber 7\nnumber 7\n"
+              "number 7\nnumber 7\nnumber 7\nnumber 7\nnumber 7\nnumber 7\nstatus\n", 0, 0,
+     "OK\nOK\nOK\nOK\nOK\nOK\nOK\nOK\nOK\nOK\nOK\nOK\nOK\nOK\nOK\nOK\nOK\nOK\nOK\nOK\n"
+     "number=7 radix=16 count=0 direction=down output=1 baud=9615 err=0.16\nOK\n", 0 },
+   { "telemetry", "telemetry on\ntelemetry toggle\ntelemetry maybe\n", 0, 0,
+     "OK\nOK\nERR\n", check_telemetry_off },
+   { "profile", "profile reset\nprofile bogus\n", 0, 0, "OK\nERR\n", 0 },
+   { "load_display", "load reset\nload display on\nload display maybe\nload bogus\n", 0, 0,
+     "OK\nOK\nERR\nERR\n", check_load_display_on },
+   { "load_display_off", "load display toggle\nstatus\n", 0, 0,
+     "OK\nnumber=7 radix=16 count=0 direction=down output=1 baud=9615 err=0.16\nOK\n", check_load_display_off },
+   { "sleep", "sleep off\nsleep toggle\nsleep maybe\nsleep\n", 0, 0,
+     "OK\nOK\nERR\nsleep=1 residency=0.0 wakes=0\nOK\n", check_sleep_on },
+};
+
+/********************************************************************************
+* loop: Kr ett varv i huvudloopen ssom i main.c, med konsolen aktiverad.
+********************************************************************************/
+static void loop(void)
+{
+   host_run_cycles(LOOP_CYCLES);
+   config_commit();
+   command_run();
+   return;
+}
+
+/********************************************************************************
+* send: Skickar angivna kommandorader och kr huvudloopen tills samtliga
+*       tecken har tagits emot, fljt av SETTLE_LOOPS varv fr svaren.
+*
+*       - s: Kommandoraderna som ska skickas.
+********************************************************************************/
+static void send(const char* s)
+{
+   host_serial_receive(s, (uint16_t)strlen(s));
+
+   while (host_serial_pending())
+   {
+      loop();
+   }
+
+   for (uint16_t i = 0; i < SETTLE_LOOPS; ++i)
+   {
+      loop();
+   }
+   return;
+}
+
+/********************************************************************************
+* read_output: Lser in utskriften frn systemet sedan fregende anrop utan
+*              vagnretur och tmmer drefter den temporra filen.
+*
+*              - s: Array som utskriften lagras i (OUTPUT_SIZE tecken).
+********************************************************************************/
+static void read_output(char* s)
+{
+   size_t length = 0;
+   int c;
+
+   fflush(stdout);
+   rewind(capture);
+
+   while ((c = fgetc(capture)) != EOF && length < OUTPUT_SIZE - 1)
+   {
+      if (c != '\r') s[length++] = (char)c;
+   }
+
+   s[length] = '\0';
+   fflush(capture);
+   if (ftruncate(fileno(capture), 0)) perror("ftruncate");
+   rewind(capture);
+   return;
+}
+
+/********************************************************************************
+* print_escaped: Skriver ut angiven text med nyradstecken som \n.
+*
+*                - out: Filen som texten ska skrivas ut till.
+*                - s  : Texten som ska skrivas ut.
+********************************************************************************/
+static void print_escaped(FILE* out,
+                          const char* s)
+{
+   for (; *s; ++s)
+   {
+      if (*s == '\n') fputs("\\n", out);
+      else fputc(*s, out);
+   }
+   return;
+}
+
+/********************************************************************************
+* main: Initierar systemet ssom i main.c med aktiverad konsol, kr samtliga
+*       testfall och skriver ut resultatet.
+********************************************************************************/
+int main(void)
+{
+   char output[OUTPUT_SIZE];
+   uint32_t failed = 0;
+
+   console = dup(STDOUT_FILENO);
+   capture = tmpfile();
+   FILE* result = fdopen(console, "w");
+
+   if (console < 0 || !capture || !result)
+   {
+      perror("capture");
+      return 1;
+   }
+
+   fflush(stdout);
+   dup2(fileno(capture), STDOUT_FILENO);
+
+   eeprom_init();
+   asm("SEI");
+   display_init();
+   display_enable_output();
+   serial_init(BAUD_RATE);
+   command_init();
+
+   for (uint16_t i = 0; i < 10; ++i) loop();
+   read_output(output);
+
+   const uint32_t mux_before = host_isr_count(TIMER1_COMPA_vect_num);
+   const uint64_t cycles_before = host_cycles();
+
+   for (uint8_t i = 0; i < sizeof(tests) / sizeof(tests[0]); ++i)
+   {
+      const struct test_case* test = &tests[i];
+      send(test->input);
+
+      for (uint32_t j = 0; j < test->run_ms * 10; ++j)
+      {
+         loop();
+      }
+
+      if (test->followup) send(test->followup);
+      read_output(output);
+
+      const bool reply_ok = !test->expected || !strcmp(output, test->expected);
+      const bool state_ok = !test->check || test->check();
+
+      fprintf(result, "%s %s", reply_ok && state_ok ? "PASS" : "FAIL", test->name);
+
+      if (!reply_ok)
+      {
+         fputs(" (svar: \"", result);
+         print_escaped(result, output);
+         fputs("\", frvntat: \"", result);
+         print_escaped(result, test->expected);
+         fputs("\")", result);
+      }
+
+      if (!state_ok) fputs(" (tillstnd)", result);
+      fputc('\n', result);
+      if (!reply_ok || !state_ok) failed++;
+   }
+
+   const double elapsed_ms = (host_cycles() - cycles_before) / (F_CPU / 1000.0);
+   const uint32_t mux_calls = host_isr_count(TIMER1_COMPA_vect_num) - mux_before;
+   const uint32_t dropped = serial_receive_dropped();
+   if (dropped) failed++;
+
+   fprintf(result, "{\"tests\": %u, \"failed\": %u, \"rx_dropped\": %u, "
+                   "\"elapsed_ms\": %.1f, \"timer1_isr_per_ms\": %.2f}\n",
+           (unsigned)(sizeof(tests) / sizeof(tests[0])), (unsigned)failed,
+           (unsigned)dropped, elapsed_ms, mux_calls / elapsed_ms);
+   fclose(result);
+   return failed ? 1 : 0;
+}
@@ -0,0 +1,184 @@
+/********************************************************************************
+* digits_bench.c: Benchmark som mter antalet klockcykler fr uppdelning av
+*                 heltal i siffror p ATmega328P, dels via division (ssom
+*                 display_set_number tidigare gjorde), dels via strukten
+*                 digits utan division. Mtningen sker med Timer 1 utan
+*                 prescaler, s att varje tick motsvarar en klockcykel.
+*                 Resultatet skrivs ut via seriell verfring i JSON-format,
+*                 en rad per mtning.
+*
+*                 Kompilering (krver avr-gcc), frn katalogen tools:
+*
+*                 avr-gcc -mmcu=atmega328p -O2 -I "../Inbyggda system - Projekt II/Inbyggda system - Projekt II"
+*                         -o digits_bench.elf digits_bench.c
+*                         "../Inbyggda system - Projekt II/Inbyggda system - Projekt II/digits.c"
+*                         "../Inbyggda system - Projekt II/Inbyggda system - Projekt II/serial.c"
+*
+*                 Krning i simavr (utskriften hamnar i terminalen):
+*
+*                 simavr -m atmega328p -f 16000000 digits_bench.elf
+*
+*                 Alternativt kan firmwaren laddas ned till ett Arduino Uno,
+*                 dr utskriften lses av via en seriell terminal (9600 baud).
+********************************************************************************/
+#include "misc.h"
+#include "digits.h"
+#include "serial.h"
+
+/********************************************************************************
+* Makrodefinitioner:
+********************************************************************************/
+#define BENCH_ROUNDS 16 /* Antal mtningar per kombination, dr lgsta vrdet anvnds. */
+
+/********************************************************************************
+* Statiska variabler:
+*
+*   - radices: Talbaser som mts.
+*   - counts : Antal siffror som mts.
+*   - sink   : Ml fr siffrorna, s att berkningen inte optimeras bort.
+********************************************************************************/
+static const uint8_t radices[] = { 2, 8, 10, 16 };
+static const uint8_t counts[] = { 2, 4, 8 };
+static volatile uint8_t sink[DIGITS_MAX_COUNT];
+
+/********************************************************************************
+* split_divide: Delar upp angivet heltal i siffror via division, ssom
+*               display_set_number tidigare gjorde. Anvnds som referens.
+*
+*               - value : Talet som ska delas upp.
+*               - radix : Talbas.
+*               - count : Antal siffror.
+*               - digits: Array som siffrorna ska lagras i.
+********************************************************************************/
+static void __attribute__((noinline)) split_divide(uint32_t value,
+                                                   const uint8_t radix,
+                                                   const uint8_t count,
+                                                   uint8_t* digits)
+{
+   for (uint8_t i = count; i-- > 0;)
+   {
+      const uint32_t quotient = value / radix;
+      digits[i] = (uint8_t)(value - quotient * radix);
+      value = quotient;
+   }
+   return;
+}
+
+/********************************************************************************
+* split_digits: Delar upp angivet heltal i siffror via strukten digits.
+*
+*               - self  : Pekare till strukten med aktuell talbas.
+*               - value : Talet som ska delas upp.
+*               - digits: Array som siffrorna ska lagras i.
+********************************************************************************/
+static void __attribute__((noinline)) split_digits(const struct digits* self,
+                                                   const uint32_t value,
+                                                   uint8_t* digits)
+{
+   digits_split(self, value, digits);
+   return;
+}
+
+/********************************************************************************
+* measure: Returnerar lgsta antalet klockcykler fr ett anrop av angiven
+*          uppdelning (division om self r en nollpekare, annars via strukten
+*          digits), exklusive mtningens egen overhead.
+*
+*          - self  : Pekare till strukten med aktuell talbas, eller 0.
+*          - value : Talet som ska delas upp.
+*          - radix : Talbas.
+*          - count : Antal siffror.
+********************************************************************************/
+static uint16_t measure(const struct digits* self,
+                        const uint32_t value,
+                        const uint8_t radix,
+                        const uint8_t count)
+{
+   uint16_t best = UINT16_MAX;
+   uint8_t digits[DIGITS_MAX_COUNT];
+
+   for (uint8_t i = 0; i < BENCH_ROUNDS; ++i)
+   {
+      const uint16_t start = TCNT1;
+
+      if (self) split_digits(self, value, digits);
+      else split_divide(value, radix, count, digits);
+
+      const uint16_t cycles = TCNT1 - start;
+      if (cycles < best) best = cycles;
+   }
+
+   for (uint8_t i = 0; i < count; ++i)
+   {
+      sink[i] = digits[i];
+   }
+   return best;
+}
+
+/********************************************************************************
+* print_result: Skriver ut resultatet fr en mtning som en rad i JSON-format.
+*
+*               - radix : Talbas.
+*               - count : Antal siffror.
+*               - value : Talet som delades upp.
+*               - divide: Antal klockcykler via division.
+*               - split : Antal klockcykler via strukten digits.
+********************************************************************************/
+static void print_result(const uint8_t radix,
+                         const uint8_t count,
+                         const uint32_t value,
+                         const uint16_t divide,
+                         const uint16_t split)
+{
+   serial_print_string("{\"radix\": ");
+   serial_print_unsigned(radix);
+   serial_print_string(", \"count\": ");
+   serial_print_unsigned(count);
+   serial_print_string(", \"value\": ");
+   serial_print_unsigned(value);
+   serial_print_string(", \"divide\": ");
+   serial_print_unsigned(divide);
+   serial_print_string(", \"digits\": ");
+   serial_print_unsigned(split);
+   serial_print_string("}");
+   serial_print_new_line();
+   return;
+}
+
+/********************************************************************************
+* main: Mter uppdelning av noll, ungefr en tredjedel av maxvrdet samt
+*       maxvrdet fr samtliga kombinationer av talbas och antal siffror.
+*       Mtningen sker med avbrott inaktiverade.
+********************************************************************************/
+int main(void)
+{
+   struct digits digits;
+   serial_init(9600);
+
+   asm("CLI");
+   TCCR1A = 0x00;
+   TCCR1B = (1 << CS10);
+
+   const uint16_t overhead = measure(0, 0, 2, 0);
+
+   for (uint8_t i = 0; i < sizeof(radices); ++i)
+   {
+      for (uint8_t j = 0; j < sizeof(counts); ++j)
+      {
+         digits_init(&digits, radices[i], counts[j]);
+         const uint32_t max = digits_max(&digits);
+         const uint32_t values[] = { 0, max / 3, max };
+
+         for (uint8_t k = 0; k < 3; ++k)
+         {
+            const uint16_t divide = measure(0, values[k], radices[i], counts[j]) - overhead;
+            const uint16_t split = measure(&digits, values[k], radices[i], counts[j]) - overhead;
+            print_result(radices[i], counts[j], values[k], divide, split);
+         }
+      }
+   }
+
+   serial_flush();
+   while (1);
+   return 0;
+}
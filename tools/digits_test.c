@@ -0,0 +1,225 @@
+/********************************************************************************
+* digits_test.c: Test av uppdelningen av heltal i siffror via strukten digits,
+*                se digits.h. Testet krs p vrddatorn, dr resultatet frn
+*                digits_split jmfrs mot uppdelning via operatorerna / och %
+*                fr samtliga talbaser 2 - 16 samt samtliga antal siffror
+*                1 - 8.
+*
+*                Fr varje kombination av talbas och antal siffror kontrolleras
+*                maxvrdet frn digits_max samt fljande vrden:
+*
+*                - Samtliga vrden frn 0 upp till TEST_LOW_COUNT - 1.
+*                - De TEST_HIGH_COUNT strsta vrdena upp till maxvrdet.
+*                - Varje potens av talbasen samt nrmast lgre och hgre vrde.
+*                - TEST_RANDOM_COUNT pseudoslumpmssiga vrden upp till
+*                  maxvrdet, med fast startvrde s att krningen kan
+*                  upprepas.
+*
+*                Drtill kontrolleras att vrden som verstiger maxvrdet ger
+*                radix - 1 som mest signifikant siffra, samt att felaktig
+*                talbas eller felaktigt antal siffror avvisas av digits_init.
+*
+*                Kompilering, frn katalogen med kllfilerna:
+*
+*                gcc -O2 -DHOST_BUILD -I . -o digits_test ../../tools/digits_test.c
+*                    digits.c
+*
+*                Anvndning:
+*
+*                ./digits_test
+*
+*                Varje avvikelse skrivs ut, fljt av en sammanfattning i
+*                JSON-format. Om ngon avvikelse ptrffas returneras 1.
+********************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include "digits.h"
+
+/********************************************************************************
+* Makrodefinitioner:
+********************************************************************************/
+#define TEST_LOW_COUNT    4096    /* Antal vrden som testas frn 0 och uppt. */
+#define TEST_HIGH_COUNT   256     /* Antal vrden som testas frn maxvrdet och nedt. */
+#define TEST_RANDOM_COUNT 20000   /* Antal pseudoslumpmssiga vrden per kombination. */
+#define TEST_MAX_ERRORS   10      /* Maximalt antal avvikelser som skrivs ut. */
+
+/* Statiska variabler: */
+static uint32_t checked = 0;
+static uint32_t errors = 0;
+static uint32_t random_state = 12345;
+
+/********************************************************************************
+* random_next: Returnerar nsta pseudoslumpmssiga 32-bitars vrde (xorshift).
+********************************************************************************/
+static uint32_t random_next(void)
+{
+   random_state ^= random_state << 13;
+   random_state ^= random_state >> 17;
+   random_state ^= random_state << 5;
+   return random_state;
+}
+
+/********************************************************************************
+* report: Rknar upp antalet avvikelser och skriver ut de frsta.
+*
+*         - self    : Pekare till strukten med aktuell talbas.
+*         - value   : Talet som delades upp.
+*         - position: Index fr den avvikande siffran.
+*         - actual  : Siffran frn digits_split.
+*         - expected: Frvntad siffra.
+********************************************************************************/
+static void report(const struct digits* self,
+                   const uint32_t value,
+                   const uint8_t position,
+                   const uint8_t actual,
+                   const uint8_t expected)
+{
+   if (errors++ < TEST_MAX_ERRORS)
+   {
+      printf("FAIL radix %u, count %u, value %lu: digit %u is %u, expected %u\n",
+             self->radix, self->count, (unsigned long)value, position, actual, expected);
+   }
+   return;
+}
+
+/********************************************************************************
+* check: Delar upp angivet vrde via digits_split och jmfr varje siffra mot
+*        uppdelning via operatorerna / och %.
+*
+*        - self : Pekare till strukten med aktuell talbas.
+*        - value: Talet som ska delas upp, hgst maxvrdet.
+********************************************************************************/
+static void check(const struct digits* self,
+                  const uint32_t value)
+{
+   uint8_t digits[DIGITS_MAX_COUNT];
+   uint32_t rest = value;
+
+   digits_split(self, value, digits);
+   checked++;
+
+   for (uint8_t i = self->count; i-- > 0;)
+   {
+      const uint8_t expected = (uint8_t)(rest % self->radix);
+      if (digits[i] != expected) report(self, value, i, digits[i], expected);
+      rest /= self->radix;
+   }
+   return;
+}
+
+/********************************************************************************
+* check_overflow: Kontrollerar att angivet vrde, som verstiger maxvrdet,
+*                 ger radix - 1 som mest signifikant siffra.
+*
+*                 - self : Pekare till strukten med aktuell talbas.
+*                 - value: Talet som ska delas upp, strre n maxvrdet.
+********************************************************************************/
+static void check_overflow(const struct digits* self,
+                           const uint32_t value)
+{
+   uint8_t digits[DIGITS_MAX_COUNT];
+   digits_split(self, value, digits);
+   checked++;
+   if (digits[0] != self->radix - 1) report(self, value, 0, digits[0], self->radix - 1);
+   return;
+}
+
+/********************************************************************************
+* check_combination: Kontrollerar maxvrdet samt samtliga testvrden fr
+*                    angiven talbas och angivet antal siffror.
+*
+*                    - radix: Talbas.
+*                    - count: Antal siffror.
+********************************************************************************/
+static void check_combination(const uint8_t radix,
+                              const uint8_t count)
+{
+   struct digits self;
+   uint64_t limit = 1;
+
+   for (uint8_t i = 0; i < count; ++i) limit *= radix;
+   const uint32_t max = limit - 1 > UINT32_MAX ? UINT32_MAX : (uint32_t)(limit - 1);
+
+   if (digits_init(&self, radix, count) || digits_max(&self) != max)
+   {
+      printf("FAIL radix %u, count %u: max is %lu, expected %lu\n",
+             radix, count, (unsigned long)digits_max(&self), (unsigned long)max);
+      errors++;
+      return;
+   }
+
+   for (uint32_t value = 0; value < TEST_LOW_COUNT && value <= max; ++value)
+   {
+      check(&self, value);
+   }
+
+   for (uint32_t i = 0; i < TEST_HIGH_COUNT && i <= max; ++i)
+   {
+      check(&self, max - i);
+   }
+
+   for (uint64_t power = radix; power <= max; power *= radix)
+   {
+      check(&self, (uint32_t)power - 1);
+      check(&self, (uint32_t)power);
+      if (power < max) check(&self, (uint32_t)power + 1);
+   }
+
+   for (uint32_t i = 0; i < TEST_RANDOM_COUNT; ++i)
+   {
+      check(&self, max == UINT32_MAX ? random_next() : random_next() % (max + 1));
+   }
+
+   if (max < UINT32_MAX)
+   {
+      check_overflow(&self, max + 1);
+      check_overflow(&self, UINT32_MAX);
+   }
+   return;
+}
+
+/********************************************************************************
+* check_invalid: Kontrollerar att digits_init avvisar felaktig talbas samt
+*                felaktigt antal siffror.
+********************************************************************************/
+static void check_invalid(void)
+{
+   static const uint8_t invalid[][2] =
+   {
+      { DIGITS_MIN_RADIX - 1, 1 },
+      { DIGITS_MAX_RADIX + 1, 1 },
+      { 10, 0 },
+      { 10, DIGITS_MAX_COUNT + 1 },
+   };
+
+   for (uint8_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); ++i)
+   {
+      struct digits self;
+
+      if (!digits_init(&self, invalid[i][0], invalid[i][1]))
+      {
+         printf("FAIL radix %u, count %u accepted\n", invalid[i][0], invalid[i][1]);
+         errors++;
+      }
+   }
+   return;
+}
+
+/********************************************************************************
+* main: Kontrollerar samtliga kombinationer av talbas och antal siffror och
+*       skriver ut resultatet.
+********************************************************************************/
+int main(void)
+{
+   for (uint8_t radix = DIGITS_MIN_RADIX; radix <= DIGITS_MAX_RADIX; ++radix)
+   {
+      for (uint8_t count = 1; count <= DIGITS_MAX_COUNT; ++count)
+      {
+         check_combination(radix, count);
+      }
+   }
+
+   check_invalid();
+   printf("{\"checked\": %lu, \"errors\": %lu}\n", (unsigned long)checked, (unsigned long)errors);
+   return errors ? 1 : 0;
+}
@@ -0,0 +1,164 @@
+/********************************************************************************
+* eeprom_bench.c: Benchmark som mter antalet klockcykler fr inlsning av
+*                 block frn EEPROM-minnet p ATmega328P, dels byte fr byte
+*                 via eeprom_read_byte (ssom inlsning tidigare skedde), dels
+*                 via eeprom_read_block samt via strukten eeprom_cursor.
+*                 Blockstorlekarna motsvarar instllningarna (12 byte), ett
+*                 omrde fr loggdata (100 byte) samt ett strre omrde
+*                 (400 byte). Mtningen sker med Timer 1 utan prescaler, s
+*                 att varje tick motsvarar en klockcykel. Resultatet skrivs
+*                 ut via seriell verfring i JSON-format, en rad per
+*                 blockstorlek.
+*
+*                 Kompilering (krver avr-gcc), frn katalogen tools:
+*
+*                 avr-gcc -mmcu=atmega328p -O2 -I "../Inbyggda system - Projekt II/Inbyggda system - Projekt II"
+*                         -o eeprom_bench.elf eeprom_bench.c
+*                         "../Inbyggda system - Projekt II/Inbyggda system - Projekt II/eeprom.c"
+*                         "../Inbyggda system - Projekt II/Inbyggda system - Projekt II/serial.c"
+*
+*                 Krning i simavr (utskriften hamnar i terminalen):
+*
+*                 simavr -m atmega328p -f 16000000 eeprom_bench.elf
+*
+*                 Alternativt kan firmwaren laddas ned till ett Arduino Uno,
+*                 dr utskriften lses av via en seriell terminal (9600 baud).
+********************************************************************************/
+#include "misc.h"
+#include "eeprom.h"
+#include "serial.h"
+
+/********************************************************************************
+* Makrodefinitioner:
+*
+*   - BENCH_ADDRESS : Frsta adressen som lses. Ligger utanfr omrdet som
+*                     speglas i RAM, s att samtliga metoder lser EEPROM-
+*                     minnet.
+*   - BENCH_MAX_SIZE: Strsta blockstorlek som mts.
+********************************************************************************/
+#define BENCH_ADDRESS  0
+#define BENCH_MAX_SIZE 400
+
+/********************************************************************************
+* bench_method: Enumeration fr metoderna som mts.
+********************************************************************************/
+enum bench_method
+{
+   BENCH_METHOD_BYTE,   /* Byte fr byte via eeprom_read_byte. */
+   BENCH_METHOD_BLOCK,  /* Via eeprom_read_block. */
+   BENCH_METHOD_CURSOR  /* Via strukten eeprom_cursor. */
+};
+
+/********************************************************************************
+* Statiska variabler:
+*
+*   - sizes : Blockstorlekar som mts.
+*   - buffer: Ml fr avlst data, s att lsningen inte optimeras bort.
+********************************************************************************/
+static const uint16_t sizes[] = { 12, 100, BENCH_MAX_SIZE };
+static volatile uint8_t buffer[BENCH_MAX_SIZE];
+
+/********************************************************************************
+* load: Lser angivet antal byte till bufferten med angiven metod.
+*
+*       - method: Metoden som ska anvndas.
+*       - size  : Antal byte som ska lsas.
+********************************************************************************/
+static void __attribute__((noinline)) load(const enum bench_method method,
+                                           const uint16_t size)
+{
+   if (method == BENCH_METHOD_BYTE)
+   {
+      for (uint16_t i = 0; i < size; ++i)
+      {
+         buffer[i] = eeprom_read_byte(BENCH_ADDRESS + i);
+      }
+   }
+   else if (method == BENCH_METHOD_BLOCK)
+   {
+      eeprom_read_block(BENCH_ADDRESS, (uint8_t*)buffer, size);
+   }
+   else
+   {
+      struct eeprom_cursor cursor;
+      eeprom_cursor_begin(&cursor, BENCH_ADDRESS);
+
+      for (uint16_t i = 0; i < size; ++i)
+      {
+         buffer[i] = eeprom_cursor_read(&cursor);
+      }
+
+      eeprom_cursor_end(&cursor);
+   }
+   return;
+}
+
+/********************************************************************************
+* measure: Returnerar antalet klockcykler fr inlsning av angivet antal byte
+*          med angiven metod.
+*
+*          - method: Metoden som ska anvndas.
+*          - size  : Antal byte som ska lsas.
+********************************************************************************/
+static uint16_t measure(const enum bench_method method,
+                        const uint16_t size)
+{
+   const uint16_t start = TCNT1;
+   load(method, size);
+   return TCNT1 - start;
+}
+
+/********************************************************************************
+* print_result: Skriver ut resultatet fr en blockstorlek som en rad i
+*               JSON-format.
+*
+*               - size  : Antal byte som lstes.
+*               - byte  : Antal klockcykler via eeprom_read_byte.
+*               - block : Antal klockcykler via eeprom_read_block.
+*               - cursor: Antal klockcykler via strukten eeprom_cursor.
+********************************************************************************/
+static void print_result(const uint16_t size,
+                         const uint16_t byte,
+                         const uint16_t block,
+                         const uint16_t cursor)
+{
+   serial_print_string("{\"size\": ");
+   serial_print_unsigned(size);
+   serial_print_string(", \"read_byte\": ");
+   serial_print_unsigned(byte);
+   serial_print_string(", \"read_block\": ");
+   serial_print_unsigned(block);
+   serial_print_string(", \"cursor\": ");
+   serial_print_unsigned(cursor);
+   serial_print_string("}");
+   serial_print_new_line();
+   return;
+}
+
+/********************************************************************************
+* main: Mter inlsning av samtliga blockstorlekar med samtliga metoder.
+*       Mtningen sker med avbrott inaktiverade, dr en frsta lsning
+*       laddar speglingen i RAM, s att denna inte belastar mtningarna.
+********************************************************************************/
+int main(void)
+{
+   eeprom_init();
+   serial_init(9600);
+
+   asm("CLI");
+   TCCR1A = 0x00;
+   TCCR1B = (1 << CS10);
+   (void)eeprom_read_byte(BENCH_ADDRESS);
+
+   for (uint8_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i)
+   {
+      const uint16_t byte = measure(BENCH_METHOD_BYTE, sizes[i]);
+      const uint16_t block = measure(BENCH_METHOD_BLOCK, sizes[i]);
+      const uint16_t cursor = measure(BENCH_METHOD_CURSOR, sizes[i]);
+      print_result(sizes[i], byte, block, cursor);
+   }
+
+   serial_flush();
+   while (1);
+   return 0;
+}
@@ -0,0 +1,164 @@
+/********************************************************************************
+* eeprom_wear.c: Simulering av slitaget p EEPROM-minnet vid lagring av
+*                rknarvrdet p 7-segmentsdisplayerna, dels till en fast
+*                adress (ssom display_set_number tidigare gjorde), dels
+*                slitageutjmnat via strukten eeprom_ring. Simuleringen krs
+*                p vrddatorn via de simulerade registren i host.h, dr
+*                antalet fysiska skrivningar per adress rknas.
+*
+*                Varje simulerad sekund rknas vrdet upp och lagras, varefter
+*                kn tms via eeprom_flush, d avbrottsrutinen fr EEPROM-
+*                minnet inte lnkas och kn annars fylls. En gng
+*                per simulerad timme initieras omrdet p nytt (motsvarande
+*                omstart), varvid det terstllda vrdet kontrolleras.
+*
+*                Slutligen simuleras ett spnningsbortfall nr omrdet slr
+*                om, dr frsta platsens sekvensnummer har raderats men inte
+*                hunnit skrivas. Drefter ska fregende vrde terstllas,
+*                i stllet fr att omrdet betraktas som tomt, och nsta
+*                skrivning ska terstllas efter ytterligare en omstart.
+*
+*                Resultatet skrivs ut i JSON-format.
+*
+*                Kompilering, frn katalogen tools:
+*
+*                gcc -O2 -DHOST_BUILD -I "../Inbyggda system - Projekt II/Inbyggda system - Projekt II"
+*                    -o eeprom_wear eeprom_wear.c
+*                    "../Inbyggda system - Projekt II/Inbyggda system - Projekt II/eeprom.c"
+*                    "../Inbyggda system - Projekt II/Inbyggda system - Projekt II/eeprom_ring.c"
+*                    "../Inbyggda system - Projekt II/Inbyggda system - Projekt II/host.c"
+*
+*                Anvndning:
+*
+*                eeprom_wear [veckor] [platser]
+*
+*                - veckor : Simulerad tid mtt i veckor (default = 4).
+*                - platser: Antal platser i omrdet (default = 100).
+********************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include "eeprom_ring.h"
+
+/********************************************************************************
+* Makrodefinitioner:
+********************************************************************************/
+#define FIXED_ADDRESS      500    /* Adress fr lagring utan slitageutjmning. */
+#define RING_ADDRESS       512    /* Frsta adressen i omrdet. */
+#define DEFAULT_WEEKS      4      /* Default simulerad tid mtt i veckor. */
+#define DEFAULT_SLOTS      100    /* Default antal platser i omrdet. */
+#define SECONDS_PER_HOUR   3600UL /* Antal sekunder per timme. */
+#define SECONDS_PER_WEEK   (7UL * 24UL * SECONDS_PER_HOUR)
+#define ENDURANCE          100000 /* Garanterat antal skrivningar per adress. */
+
+/********************************************************************************
+* torn_wrap_failures: Simulerar spnningsbortfall mitt i omskrivningen av
+*                     frsta platsens sekvensnummer nr omrdet slr om och
+*                     returnerar antalet misslyckade terstllningar.
+*
+*                     1. Vrden skrivs tills sista platsen r nyaste platsen,
+*                        s att nsta skrivning sker till frsta platsen.
+*
+*                     2. Nsta vrde skrivs, varefter frsta platsens
+*                        sekvensnummer stts till 0xFF, motsvarande avbrott
+*                        mellan radering och skrivning.
+*
+*                     3. Efter omstart ska fregende vrde terstllas.
+*                        Drefter skrivs ett nytt vrde, som ska terstllas
+*                        efter ytterligare en omstart.
+*
+*                     - ring : Pekare till omrdet.
+*                     - slots: Antal platser i omrdet.
+*                     - value: Senast skrivna vrdet.
+********************************************************************************/
+static uint32_t torn_wrap_failures(struct eeprom_ring* ring,
+                                   const uint8_t slots,
+                                   uint32_t value)
+{
+   uint32_t failures = 0;
+   uint32_t recovered = 0;
+
+   while (ring->newest != slots - 1)
+   {
+      eeprom_ring_write(ring, ++value);
+      eeprom_flush();
+   }
+
+   eeprom_ring_write(ring, value + 1);
+   eeprom_flush();
+   host_eeprom_data()[RING_ADDRESS + EEPROM_RING_SLOT_SIZE - 1] = EEPROM_RING_EMPTY;
+
+   eeprom_ring_init(ring, RING_ADDRESS, slots);
+   if (eeprom_ring_read(ring, &recovered) || recovered != value) failures++;
+
+   eeprom_ring_write(ring, value + 2);
+   eeprom_flush();
+
+   eeprom_ring_init(ring, RING_ADDRESS, slots);
+   if (eeprom_ring_read(ring, &recovered) || recovered != value + 2) failures++;
+   return failures;
+}
+
+/********************************************************************************
+* main: Kr simuleringen och skriver ut antalet skrivningar fr fast adress
+*       samt lgsta och hgsta antalet skrivningar per adress i omrdet,
+*       uppskattad livslngd samt antalet misslyckade terstllningar.
+********************************************************************************/
+int main(int argc, char** argv)
+{
+   const uint32_t weeks = argc > 1 ? (uint32_t)atoi(argv[1]) : DEFAULT_WEEKS;
+   const uint8_t slots = argc > 2 ? (uint8_t)atoi(argv[2]) : DEFAULT_SLOTS;
+   const uint32_t seconds = weeks * SECONDS_PER_WEEK;
+   struct eeprom_ring ring;
+   uint32_t value = 0;
+   uint32_t failed_recoveries = 0;
+
+   eeprom_init();
+
+   if (eeprom_ring_init(&ring, RING_ADDRESS, slots))
+   {
+      fprintf(stderr, "Invalid number of slots: %u\n", slots);
+      return 1;
+   }
+
+   for (uint32_t second = 1; second <= seconds; ++second)
+   {
+      value++;
+      eeprom_write_byte(FIXED_ADDRESS, (uint8_t)value);
+      eeprom_ring_write(&ring, value);
+      eeprom_flush();
+
+      if (second % SECONDS_PER_HOUR == 0)
+      {
+         uint32_t recovered = 0;
+         eeprom_ring_init(&ring, RING_ADDRESS, slots);
+         if (eeprom_ring_read(&ring, &recovered) || recovered != value) failed_recoveries++;
+      }
+   }
+
+   uint32_t min = UINT32_MAX;
+   uint32_t max = 0;
+
+   for (uint16_t address = RING_ADDRESS; address < RING_ADDRESS + slots * EEPROM_RING_SLOT_SIZE; ++address)
+   {
+      const uint32_t writes = host_eeprom_write_count(address);
+      if (writes < min) min = writes;
+      if (writes > max) max = writes;
+   }
+
+   const uint32_t fixed = host_eeprom_write_count(FIXED_ADDRESS);
+   const uint32_t torn_failures = torn_wrap_failures(&ring, slots, value);
+
+   printf("{\n");
+   printf("  \"weeks\": %lu,\n", (unsigned long)weeks);
+   printf("  \"writes\": %lu,\n", (unsigned long)seconds);
+   printf("  \"fixed_address_writes\": %lu,\n", (unsigned long)fixed);
+   printf("  \"fixed_address_lifetime_days\": %.1f,\n", fixed ? (double)ENDURANCE * seconds / fixed / 86400.0 : 0.0);
+   printf("  \"ring_slots\": %u,\n", slots);
+   printf("  \"ring_min_cell_writes\": %lu,\n", (unsigned long)min);
+   printf("  \"ring_max_cell_writes\": %lu,\n", (unsigned long)max);
+   printf("  \"ring_lifetime_days\": %.1f,\n", max ? (double)ENDURANCE * seconds / max / 86400.0 : 0.0);
+   printf("  \"failed_recoveries\": %lu,\n", (unsigned long)failed_recoveries);
+   printf("  \"torn_wrap_failures\": %lu\n", (unsigned long)torn_failures);
+   printf("}\n");
+   return failed_recoveries || torn_failures ? 1 : 0;
+}
@@ -0,0 +1,327 @@
+/********************************************************************************
+* isr_bench.c: Benchmark som kr den kompilerade firmwaren fr ATmega328P i
+*              simavr och mter antalet klockcykler per avbrottsrutin (min,
+*              medel samt max) samt den totala andelen CPU-tid som spenderas i
+*              avbrottsrutiner. Resultatet skrivs ut i JSON-format, s att
+*              regressioner kan jmfras mellan olika commits.
+*
+*              Kompilering (krver simavr samt libelf):
+*
+*              gcc -O2 -o isr_bench isr_bench.c -lsimavr -lelf
+*
+*              Firmwaren r den ELF-fil som Atmel Studio genererar, exempelvis
+*              "Debug/Inbyggda system - Projekt II.elf".
+*
+*              Anvndning:
+*
+*              isr_bench [-d tid_ms] [-p pin@tid_ms]... firmware.elf [rapport.json]
+*
+*              - tid_ms      : Simulerad krtid mtt i millisekunder
+*                              (default = 5000 ms).
+*              - pin@tid_ms  : Trycker ned tryckknappen p angiven pin under
+*                              50 ms vid angiven tidpunkt, exempelvis B3@1000
+*                              fr tryckknappen p pin 11 efter en sekund.
+*              - rapport.json: Fil som rapporten ska skrivas till. Om ingen
+*                              fil anges skrivs rapporten ut till stdout.
+*
+*              Mtningen sker frn att avbrottsrutinen startar (vektorn har
+*              anropats) till dess att instruktionen RETI har genomfrts.
+*              Vid nstlade avbrott inkluderar den yttre rutinens tid ven den
+*              inre rutinens tid, medan CPU-andelen rknas utan dubbletter.
+********************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <simavr/sim_avr.h>
+#include <simavr/sim_elf.h>
+#include <simavr/sim_irq.h>
+#include <simavr/sim_interrupts.h>
+#include <simavr/avr_ioport.h>
+
+/********************************************************************************
+* Makrodefinitioner:
+********************************************************************************/
+#define F_CPU              16000000UL /* Klockfrekvens (16 MHz). */
+#define VECTOR_COUNT       26         /* Antal avbrottsvektorer p ATmega328P. */
+#define MAX_PRESSES        16         /* Maximalt antal knapptryckningar. */
+#define PRESS_DURATION_MS  50         /* Tid som tryckknappen hlls nedtryckt. */
+#define DEFAULT_RUN_TIME_MS 5000      /* Default simulerad krtid. */
+
+/********************************************************************************
+* vector_stats: Strukt fr mtdata fr en enskild avbrottsvektor.
+********************************************************************************/
+struct vector_stats
+{
+   uint64_t count;   /* Antal genomfrda anrop av avbrottsrutinen. */
+   uint64_t total;   /* Totalt antal klockcykler i avbrottsrutinen. */
+   uint64_t min;     /* Lgsta antal klockcykler fr ett anrop. */
+   uint64_t max;     /* Hgsta antal klockcykler fr ett anrop. */
+   uint64_t started; /* Klockcykel nr pgende anrop startade. */
+   int running;      /* Indikerar ifall avbrottsrutinen pgr. */
+};
+
+/********************************************************************************
+* button_press: Strukt fr en schemalagd knapptryckning.
+********************************************************************************/
+struct button_press
+{
+   char port;         /* I/O-port (B, C eller D). */
+   uint8_t pin;       /* Pin-nummer p aktuell I/O-port. */
+   uint64_t press;    /* Klockcykel nr tryckknappen trycks ned. */
+   uint64_t release;  /* Klockcykel nr tryckknappen slpps. */
+   int state;         /* 0 = ej pbrjad, 1 = nedtryckt, 2 = avslutad. */
+};
+
+/********************************************************************************
+* Statiska variabler:
+*
+*   - avr          : Den simulerade mikrodatorn.
+*   - stats        : Mtdata per avbrottsvektor.
+*   - depth        : Aktuellt nstlingsdjup fr avbrottsrutiner.
+*   - isr_started  : Klockcykel nr yttersta pgende avbrottsrutin startade.
+*   - isr_cycles   : Totalt antal klockcykler i avbrottsrutiner.
+*   - presses      : Schemalagda knapptryckningar.
+*   - num_presses  : Antal schemalagda knapptryckningar.
+********************************************************************************/
+static avr_t* avr = 0;
+static struct vector_stats stats[VECTOR_COUNT];
+static int depth = 0;
+static uint64_t isr_started = 0;
+static uint64_t isr_cycles = 0;
+static struct button_press presses[MAX_PRESSES];
+static int num_presses = 0;
+
+/********************************************************************************
+* vector_names: Namn p avbrottsvektorerna, indexerade efter vektornummer.
+********************************************************************************/
+static const char* vector_names[VECTOR_COUNT] =
+{
+   "RESET_vect", "INT0_vect", "INT1_vect", "PCINT0_vect", "PCINT1_vect",
+   "PCINT2_vect", "WDT_vect", "TIMER2_COMPA_vect", "TIMER2_COMPB_vect",
+   "TIMER2_OVF_vect", "TIMER1_CAPT_vect", "TIMER1_COMPA_vect",
+   "TIMER1_COMPB_vect", "TIMER1_OVF_vect", "TIMER0_COMPA_vect",
+   "TIMER0_COMPB_vect", "TIMER0_OVF_vect", "SPI_STC_vect", "USART_RX_vect",
+   "USART_UDRE_vect", "USART_TX_vect", "ADC_vect", "EE_READY_vect",
+   "ANALOG_COMP_vect", "TWI_vect", "SPM_READY_vect"
+};
+
+/********************************************************************************
+* vector_running: Anropas av simavr nr en avbrottsrutin startar (value = 1)
+*                 eller avslutas via RETI (value = 0).
+*
+*                 - irq  : Pekare till avbrottsvektorns IRQ (anvnds ej).
+*                 - value: 1 vid start, 0 vid avslut.
+*                 - param: Avbrottsvektorns nummer.
+********************************************************************************/
+static void vector_running(struct avr_irq_t* irq, uint32_t value, void* param)
+{
+   struct vector_stats* self = &stats[(uintptr_t)param];
+   (void)irq;
+
+   if (value)
+   {
+      if (self->running) return;
+      self->running = 1;
+      self->started = avr->cycle;
+      if (depth++ == 0) isr_started = avr->cycle;
+   }
+   else if (self->running)
+   {
+      const uint64_t cycles = avr->cycle - self->started;
+      self->running = 0;
+      self->count++;
+      self->total += cycles;
+      if (self->count == 1 || cycles < self->min) self->min = cycles;
+      if (cycles > self->max) self->max = cycles;
+      if (--depth == 0) isr_cycles += avr->cycle - isr_started;
+   }
+   return;
+}
+
+/********************************************************************************
+* parse_press: Tolkar en knapptryckning angiven p formen pin@tid_ms,
+*              exempelvis B3@1000. Vid lyckad tolkning returneras 0,
+*              annars returneras felkod 1.
+*
+*              - arg: Argumentet som ska tolkas.
+********************************************************************************/
+static int parse_press(const char* arg)
+{
+   char port;
+   unsigned pin, time_ms;
+
+   if (num_presses >= MAX_PRESSES) return 1;
+   if (sscanf(arg, "%c%u@%u", &port, &pin, &time_ms) != 3) return 1;
+   if (port != 'B' && port != 'C' && port != 'D') return 1;
+   if (pin > 7) return 1;
+
+   presses[num_presses].port = port;
+   presses[num_presses].pin = (uint8_t)pin;
+   presses[num_presses].press = (uint64_t)time_ms * (F_CPU / 1000);
+   presses[num_presses].release = (uint64_t)(time_ms + PRESS_DURATION_MS) * (F_CPU / 1000);
+   presses[num_presses].state = 0;
+   num_presses++;
+   return 0;
+}
+
+/********************************************************************************
+* update_presses: Trycker ned eller slpper schemalagda tryckknappar nr
+*                 respektive tidpunkt har passerats.
+********************************************************************************/
+static void update_presses(void)
+{
+   for (int i = 0; i < num_presses; ++i)
+   {
+      struct button_press* self = &presses[i];
+
+      if (self->state == 2) continue;
+      if ((self->state == 0 && avr->cycle >= self->press) ||
+          (self->state == 1 && avr->cycle >= self->release))
+      {
+         avr_irq_t* irq = avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ(self->port), self->pin);
+         avr_raise_irq(irq, self->state == 0 ? 1 : 0);
+         self->state++;
+      }
+   }
+   return;
+}
+
+/********************************************************************************
+* print_report: Skriver ut mtresultatet i JSON-format.
+*
+*               - ostream : Utstrm som rapporten ska skrivas till.
+*               - firmware: Skvg till den simulerade firmwaren.
+*               - cycles  : Totalt antal simulerade klockcykler.
+********************************************************************************/
+static void print_report(FILE* ostream, const char* firmware, const uint64_t cycles)
+{
+   int first = 1;
+
+   fprintf(ostream, "{\n");
+   fprintf(ostream, "  \"firmware\": \"%s\",\n", firmware);
+   fprintf(ostream, "  \"f_cpu\": %lu,\n", F_CPU);
+   fprintf(ostream, "  \"cycles\": %llu,\n", (unsigned long long)cycles);
+   fprintf(ostream, "  \"isr_cycles\": %llu,\n", (unsigned long long)isr_cycles);
+   fprintf(ostream, "  \"isr_cpu_share\": %.6f,\n", cycles ? (double)isr_cycles / cycles : 0.0);
+   fprintf(ostream, "  \"vectors\": [");
+
+   for (int i = 1; i < VECTOR_COUNT; ++i)
+   {
+      const struct vector_stats* self = &stats[i];
+      if (!self->count) continue;
+
+      fprintf(ostream, "%s\n    { \"vector\": %d, \"name\": \"%s\", \"count\": %llu, "
+              "\"min\": %llu, \"avg\": %.1f, \"max\": %llu, \"total\": %llu, "
+              "\"cpu_share\": %.6f }",
+              first ? "" : ",", i, vector_names[i],
+              (unsigned long long)self->count, (unsigned long long)self->min,
+              (double)self->total / self->count, (unsigned long long)self->max,
+              (unsigned long long)self->total,
+              cycles ? (double)self->total / cycles : 0.0);
+      first = 0;
+   }
+
+   fprintf(ostream, "\n  ]\n}\n");
+   return;
+}
+
+/********************************************************************************
+* main: Lser in firmwaren, registrerar mtpunkter fr samtliga avbrotts-
+*       vektorer och kr simuleringen under angiven tid. Drefter skrivs
+*       rapporten ut.
+********************************************************************************/
+int main(int argc, char** argv)
+{
+   uint32_t run_time_ms = DEFAULT_RUN_TIME_MS;
+   const char* firmware = 0;
+   const char* report = 0;
+   elf_firmware_t elf;
+   int state = cpu_Running;
+
+   for (int i = 1; i < argc; ++i)
+   {
+      if (!strcmp(argv[i], "-d") && i + 1 < argc)
+      {
+         run_time_ms = (uint32_t)strtoul(argv[++i], 0, 10);
+      }
+      else if (!strcmp(argv[i], "-p") && i + 1 < argc)
+      {
+         if (parse_press(argv[++i]))
+         {
+            fprintf(stderr, "Ogiltig knapptryckning: %s\n", argv[i]);
+            return 1;
+         }
+      }
+      else if (!firmware)
+      {
+         firmware = argv[i];
+      }
+      else
+      {
+         report = argv[i];
+      }
+   }
+
+   if (!firmware)
+   {
+      fprintf(stderr, "Anvndning: %s [-d tid_ms] [-p pin@tid_ms]... firmware.elf [rapport.json]\n", argv[0]);
+      return 1;
+   }
+
+   memset(&elf, 0, sizeof(elf));
+   if (elf_read_firmware(firmware, &elf))
+   {
+      fprintf(stderr, "Kunde inte lsa in %s\n", firmware);
+      return 1;
+   }
+
+   strcpy(elf.mmcu, "atmega328p");
+   elf.frequency = F_CPU;
+   avr = avr_make_mcu_by_name(elf.mmcu);
+   if (!avr)
+   {
+      fprintf(stderr, "simavr saknar std fr %s\n", elf.mmcu);
+      return 1;
+   }
+
+   avr_init(avr);
+   avr_load_firmware(avr, &elf);
+
+   for (uintptr_t vector = 1; vector < VECTOR_COUNT; ++vector)
+   {
+      avr_irq_t* irq = avr_get_interrupt_irq(avr, (uint8_t)vector);
+      if (irq) avr_irq_register_notify(irq + AVR_INT_IRQ_RUNNING, vector_running, (void*)vector);
+   }
+
+   const uint64_t end = (uint64_t)run_time_ms * (F_CPU / 1000);
+
+   while (avr->cycle < end && state != cpu_Done && state != cpu_Crashed)
+   {
+      update_presses();
+      state = avr_run(avr);
+   }
+
+   if (state == cpu_Crashed)
+   {
+      fprintf(stderr, "Firmwaren kraschade efter %llu klockcykler\n", (unsigned long long)avr->cycle);
+   }
+
+   if (report)
+   {
+      FILE* ostream = fopen(report, "w");
+      if (!ostream)
+      {
+         fprintf(stderr, "Kunde inte ppna %s\n", report);
+         return 1;
+      }
+      print_report(ostream, firmware, avr->cycle);
+      fclose(ostream);
+   }
+   else
+   {
+      print_report(stdout, firmware, avr->cycle);
+   }
+
+   return state == cpu_Crashed ? 1 : 0;
+}
@@ -0,0 +1,287 @@
+/********************************************************************************
+* power_fail.c: Simulering av strmavbrott, som kontrollerar att talet p
+*               7-segmentsdisplayerna samt instllningarna verlever upprepade
+*               strmavbrott nr tillstndet enbart lagras vid detekterat
+*               strmavbrott, se power.h. Simuleringen krs p vrddatorn via
+*               de simulerade registren i host.h.
+*
+*               Varje uppstart krs i en egen process (motsvarande omstart,
+*               dr RAM-minnet nollstlls), medan EEPROM-minnet frs vidare
+*               mellan processerna via delat minne. Vid varje uppstart:
+*
+*               1. Systemet initieras ssom i main.c, varvid terstllt tal
+*                  samt instllningar jmfrs med tillstndet vid fregende
+*                  strmavbrott.
+*
+*               2. Systemet krs en slumpmssig tid (upp till tre sekunder)
+*                  med upprkning var 10:e ms, dr upprkningsriktningen
+*                  ibland togglas (motsvarande knapptryckning). Antalet
+*                  skrivningar till EEPROM-minnet under normal drift rknas.
+*
+*               3. Ibland simuleras en kort spnningsdipp, dr matningen
+*                  terhmtar sig, varefter systemet krs vidare en stund.
+*                  Skrivningarna under dippen rknas som lagring vid
+*                  strmavbrott, inte som normal drift.
+*
+*               4. Ett strmavbrott injiceras via den analoga komparatorn,
+*                  varvid antalet skrivningar under lagringen rknas.
+*
+*               Resultatet skrivs ut i JSON-format, dr ndvndig hlltid
+*               fr matningen uppskattas utifrn hgsta antalet skrivningar
+*               vid ett strmavbrott (3.4 ms per byte).
+*
+*               Kompilering, frn katalogen tools (samtliga kllfiler utom
+*               main.c lnkas):
+*
+*               D="../Inbyggda system - Projekt II/Inbyggda system - Projekt II"
+*               gcc -O2 -DHOST_BUILD -I "$D" -o power_fail power_fail.c
+*                   $(ls "$D"/[a-z]*.c | grep -v main.c)
+*
+*               Anvndning:
+*
+*               power_fail [uppstarter] [fr]
+*
+*               - uppstarter: Antal simulerade uppstarter (default = 200).
+*               - fr       : Fr fr slumptalsgeneratorn (default = 1).
+********************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "header.h"
+
+/********************************************************************************
+* Makrodefinitioner:
+********************************************************************************/
+#define DEFAULT_BOOTS      200  /* Default antal simulerade uppstarter. */
+#define COUNT_SPEED_MS     10   /* Upprkningshastighet mtt i ms. */
+#define MAX_RUN_MS         3000 /* Lngsta krtid per uppstart mtt i ms. */
+#define WRITE_TIME_MS      3.4  /* Lngsta tid per skriven byte mtt i ms. */
+#define CYCLES_PER_MS      (F_CPU / 1000UL)
+
+/********************************************************************************
+* shared_state: Strukt fr tillstndet som frs vidare mellan uppstarterna.
+********************************************************************************/
+struct shared_state
+{
+   uint8_t eeprom[EEPROM_ADDRESS_MAX + 1]; /* Innehllet i EEPROM-minnet. */
+   bool valid;                             /* Indikerar ifall ett tillstnd har lagrats. */
+   display_number_t number;                /* Talet vid senaste strmavbrott. */
+   uint8_t count_direction;                /* Upprkningsriktning vid senaste strmavbrott. */
+   uint32_t counter_writes;                /* Skrivningar av talet under normal drift. */
+   uint32_t config_writes;                 /* Skrivningar av instllningarna under normal drift. */
+   uint32_t save_writes_max;               /* Hgsta antal skrivningar vid ett strmavbrott. */
+   uint32_t dips;                          /* Antal spnningsdippar med terhmtning. */
+   uint32_t failed_restores;               /* Antal uppstarter med felaktigt terstllt tillstnd. */
+};
+
+/* Globala variabler som refereras av avbrottsrutinerna: */
+struct button button1;
+struct button button2;
+struct button button3;
+struct soft_timer debounce_timer;
+
+/********************************************************************************
+* Statiska variabler:
+*
+*   - random_state: Tillstnd fr slumptalsgeneratorn.
+********************************************************************************/
+static uint32_t random_state = 1;
+
+/********************************************************************************
+* random_next: Returnerar ett pseudoslumpmssigt tal 0 - (limit - 1).
+*
+*              - limit: vre grns (exklusive).
+********************************************************************************/
+static uint32_t random_next(const uint32_t limit)
+{
+   random_state = random_state * 1103515245UL + 12345UL;
+   return (random_state >> 8) % limit;
+}
+
+/********************************************************************************
+* eeprom_writes: Returnerar totalt antal fysiska skrivningar inom angivet
+*                adressintervall.
+*
+*                - first: Frsta adressen.
+*                - last : Sista adressen.
+********************************************************************************/
+static uint32_t eeprom_writes(const uint16_t first,
+                              const uint16_t last)
+{
+   uint32_t writes = 0;
+
+   for (uint16_t address = first; address <= last; ++address)
+   {
+      writes += host_eeprom_write_count(address);
+   }
+   return writes;
+}
+
+/********************************************************************************
+* power_fail_detected: Callback-rutin vid strmavbrott, ssom i main.c.
+********************************************************************************/
+static void power_fail_detected(void)
+{
+   display_power_fail();
+   config_commit();
+   return;
+}
+
+/********************************************************************************
+* power_restored: Callback-rutin vid terhmtning, ssom i main.c.
+********************************************************************************/
+static void power_restored(void)
+{
+   display_power_restore();
+   return;
+}
+
+/********************************************************************************
+* run: Kr huvudloopen angivet antal millisekunder, dr instllningarna
+*      lagras vid behov ssom i main.c.
+*
+*      - time_ms: Krtid mtt i millisekunder.
+********************************************************************************/
+static void run(const uint32_t time_ms)
+{
+   for (uint32_t i = 0; i < time_ms; ++i)
+   {
+      host_run_cycles(CYCLES_PER_MS);
+      config_commit();
+   }
+   return;
+}
+
+/********************************************************************************
+* boot: Simulerar en uppstart fram till nsta strmavbrott.
+*
+*       - state: Pekare till tillstndet som frs vidare mellan uppstarterna.
+********************************************************************************/
+static void boot(struct shared_state* state)
+{
+   const uint16_t config_first = CONFIG_ADDRESS;
+   const uint16_t config_last = CONFIG_ADDRESS + CONFIG_SLOT_COUNT * sizeof(struct config) - 1;
+
+   memcpy(host_eeprom_data(), state->eeprom, sizeof(state->eeprom));
+   eeprom_init();
+   asm("SEI");
+
+   display_init();
+   display_enable_output();
+   power_init(power_fail_detected, power_restored);
+
+   if (state->valid && (display_get_number() != state->number ||
+                        config_get()->count_direction != state->count_direction))
+   {
+      state->failed_restores++;
+   }
+
+   if (!display_count_enabled())
+   {
+      display_set_count(DISPLAY_COUNT_DIRECTION_UP, COUNT_SPEED_MS);
+      display_enable_count();
+   }
+   else
+   {
+      display_set_count(config_get()->count_direction ? DISPLAY_COUNT_DIRECTION_UP :
+                        DISPLAY_COUNT_DIRECTION_DOWN, COUNT_SPEED_MS);
+   }
+
+   const uint32_t config_before = eeprom_writes(config_first, config_last);
+   const uint32_t total_before = eeprom_writes(EEPROM_ADDRESS_MIN, EEPROM_ADDRESS_MAX);
+
+   run(random_next(MAX_RUN_MS));
+   if (random_next(4) == 0) display_toggle_count_direction();
+   run(random_next(MAX_RUN_MS / 4));
+
+   uint32_t dip_writes = 0;
+   uint32_t dip_config_writes = 0;
+
+   if (random_next(8) == 0)
+   {
+      eeprom_flush();
+      const uint32_t config_dip = eeprom_writes(config_first, config_last);
+      const uint32_t total_dip = eeprom_writes(EEPROM_ADDRESS_MIN, EEPROM_ADDRESS_MAX);
+      host_set_analog_comparator(true);
+      host_set_analog_comparator(false);
+      dip_config_writes = eeprom_writes(config_first, config_last) - config_dip;
+      dip_writes = eeprom_writes(EEPROM_ADDRESS_MIN, EEPROM_ADDRESS_MAX) - total_dip;
+      if (dip_writes > state->save_writes_max) state->save_writes_max = dip_writes;
+      run(random_next(MAX_RUN_MS / 4));
+      state->dips++;
+   }
+
+   eeprom_flush();
+   const uint32_t config_writes = eeprom_writes(config_first, config_last) - config_before - dip_config_writes;
+   const uint32_t total_writes = eeprom_writes(EEPROM_ADDRESS_MIN, EEPROM_ADDRESS_MAX) - total_before - dip_writes;
+   state->config_writes += config_writes;
+   state->counter_writes += total_writes - config_writes;
+
+   const uint32_t total_fail = eeprom_writes(EEPROM_ADDRESS_MIN, EEPROM_ADDRESS_MAX);
+   host_set_analog_comparator(true);
+   const uint32_t save_writes = eeprom_writes(EEPROM_ADDRESS_MIN, EEPROM_ADDRESS_MAX) - total_fail;
+   if (save_writes > state->save_writes_max) state->save_writes_max = save_writes;
+
+   state->number = display_get_number();
+   state->count_direction = config_get()->count_direction;
+   state->valid = true;
+   memcpy(state->eeprom, host_eeprom_data(), sizeof(state->eeprom));
+   return;
+}
+
+/********************************************************************************
+* main: Kr samtliga uppstarter och skriver ut resultatet. Vid felaktigt
+*       terstllt tillstnd eller skrivning av talet under normal drift
+*       returneras 1, annars 0.
+********************************************************************************/
+int main(int argc, char** argv)
+{
+   const uint32_t boots = argc > 1 ? (uint32_t)atoi(argv[1]) : DEFAULT_BOOTS;
+   const uint32_t seed = argc > 2 ? (uint32_t)atoi(argv[2]) : 1;
+   struct shared_state* state = mmap(0, sizeof(struct shared_state), PROT_READ | PROT_WRITE,
+                                     MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+
+   if (state == MAP_FAILED)
+   {
+      perror("mmap");
+      return 1;
+   }
+
+   memset(state, 0, sizeof(*state));
+   memset(state->eeprom, 0xFF, sizeof(state->eeprom));
+
+   for (uint32_t i = 0; i < boots; ++i)
+   {
+      const pid_t pid = fork();
+
+      if (pid == 0)
+      {
+         random_state = seed + i * 7919UL;
+         boot(state);
+         _exit(0);
+      }
+
+      int status = 0;
+      waitpid(pid, &status, 0);
+
+      if (!WIFEXITED(status) || WEXITSTATUS(status))
+      {
+         fprintf(stderr, "Boot %lu failed\n", (unsigned long)i);
+         return 1;
+      }
+   }
+
+   printf("{\n");
+   printf("  \"boots\": %lu,\n", (unsigned long)boots);
+   printf("  \"voltage_dips\": %lu,\n", (unsigned long)state->dips);
+   printf("  \"counter_writes_normal_operation\": %lu,\n", (unsigned long)state->counter_writes);
+   printf("  \"config_writes_normal_operation\": %lu,\n", (unsigned long)state->config_writes);
+   printf("  \"max_writes_per_power_fail\": %lu,\n", (unsigned long)state->save_writes_max);
+   printf("  \"required_hold_up_ms\": %.1f,\n", state->save_writes_max * WRITE_TIME_MS);
+   printf("  \"failed_restores\": %lu\n", (unsigned long)state->failed_restores);
+   printf("}\n");
+   return state->failed_restores || state->counter_writes ? 1 : 0;
+}
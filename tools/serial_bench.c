@@ -0,0 +1,250 @@
+/********************************************************************************
+* serial_bench.c: Benchmark som mter antalet klockcykler fr utskrift av tal
+*                 via seriell verfring p ATmega328P, dels via sprintf
+*                 (ssom serial_print_integer, serial_print_unsigned samt
+*                 serial_print_double tidigare gjorde), dels via den nuvarande
+*                 formateringen utan sprintf. Varje anrop mts frn ett tomt
+*                 sndbuffert, s att enbart formateringen samt kopieringen
+*                 till bufferten ingr. Mtningen sker med Timer 1 utan
+*                 prescaler, s att varje tick motsvarar en klockcykel.
+*                 Resultatet skrivs ut via seriell verfring i JSON-format,
+*                 en rad per mtning, fregnget av de utskrivna talen (en
+*                 rad per mtvarv), s att utskrifterna kan jmfras.
+*
+*                 Kompilering (krver avr-gcc), frn katalogen tools:
+*
+*                 avr-gcc -mmcu=atmega328p -O2 -ffunction-sections -Wl,--gc-sections
+*                         -I "../Inbyggda system - Projekt II/Inbyggda system - Projekt II"
+*                         -o serial_bench.elf serial_bench.c
+*                         "../Inbyggda system - Projekt II/Inbyggda system - Projekt II/serial.c"
+*
+*                 Krning i simavr (utskriften hamnar i terminalen):
+*
+*                 simavr -m atmega328p -f 16000000 serial_bench.elf
+*
+*                 Alternativt kan firmwaren laddas ned till ett Arduino Uno,
+*                 dr utskriften lses av via en seriell terminal (9600 baud).
+*
+*                 Flashminne: Kompilera med -DBENCH_FLASH=1 respektive
+*                 -DBENCH_FLASH=2 i stllet, varvid enbart utskrift via
+*                 sprintf respektive via den nuvarande formateringen lnkas
+*                 in. Skillnaden i storleken p sektionen .text (avr-size
+*                 serial_bench.elf) utgr det flashminne som sparas.
+********************************************************************************/
+#include "misc.h"
+#include "serial.h"
+
+/********************************************************************************
+* Makrodefinitioner:
+*
+*   - BENCH_ROUNDS: Antal mtningar per fall, dr lgsta vrdet anvnds.
+*   - BENCH_FLASH : 0 = mt klockcykler, 1 = lnka enbart utskrift via
+*                   sprintf, 2 = lnka enbart den nuvarande formateringen.
+********************************************************************************/
+#define BENCH_ROUNDS 8
+
+#ifndef BENCH_FLASH
+#define BENCH_FLASH 0
+#endif
+
+/********************************************************************************
+* bench_case: Enumeration fr de utskriftsfunktioner som mts.
+********************************************************************************/
+enum bench_case
+{
+   BENCH_CASE_UNSIGNED, /* Osignerat heltal. */
+   BENCH_CASE_INTEGER,  /* Signerat heltal. */
+   BENCH_CASE_HEX,      /* Hexadecimalt heltal med tta siffror. */
+   BENCH_CASE_DOUBLE,   /* Flyttal med tv decimaler. */
+   BENCH_CASE_FIXED     /* Fixtal med tv decimaler (jmfrs med flyttal via sprintf). */
+};
+
+/********************************************************************************
+* Statiska variabler:
+*
+*   - values: Tal som mts fr respektive fall, dr flyttal och fixtal
+*             anges i hundradelar.
+*   - names : Namn p respektive fall i utskriften.
+********************************************************************************/
+static const int32_t values[] = { 0, 12345, -2147483647, 2147483647 };
+
+#if BENCH_FLASH == 0
+static const char* const names[] = { "unsigned", "integer", "hex", "double", "fixed" };
+#endif
+
+#if BENCH_FLASH != 2
+/********************************************************************************
+* legacy_print: Skriver ut angivet tal via sprintf, ssom serial.c tidigare
+*               gjorde. Anvnds som referens.
+*
+*               - type : Utskriftsfunktionen som ska efterliknas.
+*               - value: Talet som ska skrivas ut (hundradelar fr flyttal).
+********************************************************************************/
+static void __attribute__((noinline)) legacy_print(const enum bench_case type,
+                                                   const int32_t value)
+{
+   char s[20] = { '\0' };
+
+   if (type == BENCH_CASE_UNSIGNED)
+   {
+      sprintf(s, "%lu", (uint32_t)value);
+   }
+   else if (type == BENCH_CASE_INTEGER)
+   {
+      sprintf(s, "%ld", value);
+   }
+   else if (type == BENCH_CASE_HEX)
+   {
+      sprintf(s, "%08lX", (uint32_t)value);
+   }
+   else
+   {
+      const double number = value / 100.0;
+      const int32_t integer = (int32_t)number;
+      int32_t decimal;
+
+      if (integer >= 0)
+      {
+         decimal = (int32_t)((number - integer) * 100 + 0.5);
+      }
+      else
+      {
+         decimal = (int32_t)((integer - number) * 100 + 0.5);
+      }
+
+      sprintf(s, "%ld.%ld", integer, decimal);
+   }
+
+   serial_print_string(s);
+   return;
+}
+#endif /* BENCH_FLASH != 2 */
+
+#if BENCH_FLASH != 1
+/********************************************************************************
+* current_print: Skriver ut angivet tal via den nuvarande formateringen.
+*
+*                - type : Utskriftsfunktionen som ska anvndas.
+*                - value: Talet som ska skrivas ut (hundradelar fr flyttal).
+********************************************************************************/
+static void __attribute__((noinline)) current_print(const enum bench_case type,
+                                                    const int32_t value)
+{
+   if (type == BENCH_CASE_UNSIGNED)
+   {
+      serial_print_unsigned((uint32_t)value);
+   }
+   else if (type == BENCH_CASE_INTEGER)
+   {
+      serial_print_integer(value);
+   }
+   else if (type == BENCH_CASE_HEX)
+   {
+      serial_print_hex((uint32_t)value, 8);
+   }
+   else if (type == BENCH_CASE_DOUBLE)
+   {
+      serial_print_double(value / 100.0);
+   }
+   else
+   {
+      serial_print_fixed(value, 2);
+   }
+   return;
+}
+#endif /* BENCH_FLASH != 1 */
+
+#if BENCH_FLASH == 0
+/********************************************************************************
+* measure: Returnerar lgsta antalet klockcykler fr en utskrift av angivet
+*          tal, inklusive mtningens egen overhead. Sndbufferten tms fre
+*          varje mtning.
+*
+*          - legacy: Indikerar ifall utskrift ska ske via sprintf.
+*          - type  : Utskriftsfunktionen som ska mtas.
+*          - value : Talet som ska skrivas ut.
+********************************************************************************/
+static uint16_t measure(const bool legacy,
+                        const enum bench_case type,
+                        const int32_t value)
+{
+   uint16_t best = UINT16_MAX;
+
+   for (uint8_t i = 0; i < BENCH_ROUNDS; ++i)
+   {
+      serial_print_new_line();
+      serial_flush();
+      const uint16_t start = TCNT1;
+
+      if (legacy) legacy_print(type, value);
+      else current_print(type, value);
+
+      const uint16_t cycles = TCNT1 - start;
+      if (cycles < best) best = cycles;
+   }
+
+   serial_print_new_line();
+   return best;
+}
+
+/********************************************************************************
+* print_result: Skriver ut resultatet fr en mtning som en rad i JSON-format.
+*
+*               - type          : Utskriftsfunktionen som mttes.
+*               - value         : Talet som skrevs ut.
+*               - sprintf_cycles: Antal klockcykler via sprintf.
+*               - current_cycles: Antal klockcykler via den nuvarande
+*                                 formateringen.
+********************************************************************************/
+static void print_result(const enum bench_case type,
+                         const int32_t value,
+                         const uint16_t sprintf_cycles,
+                         const uint16_t current_cycles)
+{
+   serial_print_string("{\"function\": \"");
+   serial_print_string(names[type]);
+   serial_print_string("\", \"value\": ");
+   serial_print_integer(value);
+   serial_print_string(", \"sprintf\": ");
+   serial_print_unsigned(sprintf_cycles);
+   serial_print_string(", \"serial\": ");
+   serial_print_unsigned(current_cycles);
+   serial_print_string("}");
+   serial_print_new_line();
+   return;
+}
+#endif /* BENCH_FLASH == 0 */
+
+/********************************************************************************
+* main: Mter samtliga utskriftsfunktioner fr samtliga tal. Mtningen sker
+*       med avbrott inaktiverade, dr sndbufferten tms direkt av
+*       drivrutinen. Vid mtning av flashminne skrivs talen enbart ut.
+********************************************************************************/
+int main(void)
+{
+   serial_init(9600);
+
+   asm("CLI");
+   TCCR1A = 0x00;
+   TCCR1B = (1 << CS10);
+
+   for (uint8_t type = BENCH_CASE_UNSIGNED; type <= BENCH_CASE_FIXED; ++type)
+   {
+      for (uint8_t i = 0; i < sizeof(values) / sizeof(values[0]); ++i)
+      {
+#if BENCH_FLASH == 1
+         legacy_print((enum bench_case)type, values[i]);
+#elif BENCH_FLASH == 2
+         current_print((enum bench_case)type, values[i]);
+#else
+         const uint16_t legacy = measure(true, (enum bench_case)type, values[i]);
+         const uint16_t current = measure(false, (enum bench_case)type, values[i]);
+         print_result((enum bench_case)type, values[i], legacy, current);
+#endif
+      }
+   }
+
+   serial_flush();
+   while (1);
+   return 0;
+}
@@ -0,0 +1,206 @@
+/********************************************************************************
+* serial_test.c: Test av utskriften av tal via seriell verfring, se
+*                serial.h. Testet krs p vrddatorn via de simulerade
+*                registren i host.h, dr utskriften dirigeras om till en
+*                temporr fil och jmfrs med frvntad text.
+*
+*                Testfallen tcker fixtal med och utan minustecken (exempelvis
+*                0.05 samt -21.50), grnsvrdena INT32_MIN, INT32_MAX samt
+*                0xFFFFFFFF, hexadecimal utskrift med och utan utfyllnad,
+*                nio decimaler (samt begrnsning av fler decimaler) och
+*                avrundning samt begrnsning av flyttal.
+*
+*                Avbrott aktiveras aldrig, varfr bufferten tms direkt av
+*                drivrutinen, ssom vid utskrift frn en avbrottsrutin.
+*
+*                Kompilering, frn katalogen med kllfilerna:
+*
+*                gcc -O2 -DHOST_BUILD -I . -o serial_test ../../tools/serial_test.c
+*                    serial.c host.c
+*
+*                Anvndning:
+*
+*                ./serial_test
+*
+*                Resultatet skrivs ut per testfall, fljt av en sammanfattning
+*                i JSON-format. Om ngot testfall misslyckas returneras 1.
+********************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "serial.h"
+
+/********************************************************************************
+* Makrodefinitioner:
+********************************************************************************/
+#define BAUD_RATE    9600              /* verfringshastighet. */
+#define OUTPUT_SIZE  64                /* Strsta antal tecken i utskriften per testfall. */
+#define FLUSH_CYCLES (F_CPU / 1000UL)  /* Krtid tills sista tecknet har skrivits ut (1 ms). */
+
+/********************************************************************************
+* test_format: Enumeration fr utskriftsfunktionen som ett testfall anvnder.
+********************************************************************************/
+enum test_format
+{
+   TEST_FORMAT_INTEGER,  /* serial_print_integer. */
+   TEST_FORMAT_UNSIGNED, /* serial_print_unsigned. */
+   TEST_FORMAT_HEX,      /* serial_print_hex med angivet antal siffror. */
+   TEST_FORMAT_FIXED,    /* serial_print_fixed med angivet antal decimaler. */
+   TEST_FORMAT_DOUBLE    /* serial_print_double. */
+};
+
+/********************************************************************************
+* test_case: Strukt fr ett testfall.
+********************************************************************************/
+struct test_case
+{
+   const char* name;        /* Testfallets namn. */
+   enum test_format format; /* Utskriftsfunktionen som anvnds. */
+   int64_t number;          /* Heltalet som skrivs ut (ej flyttal). */
+   uint8_t digits;          /* Antal siffror (hex) eller decimaler (fixtal). */
+   double real;             /* Flyttalet som skrivs ut (enbart flyttal). */
+   const char* expected;    /* Frvntad utskrift. */
+};
+
+/********************************************************************************
+* Statiska variabler:
+*
+*   - capture: Temporr fil som utskriften frn systemet dirigeras om till.
+*   - console: Filbeskrivare fr ursprunglig stdout, fr testresultatet.
+********************************************************************************/
+static FILE* capture = 0;
+static int console = -1;
+
+/********************************************************************************
+* tests: Samtliga testfall.
+********************************************************************************/
+static const struct test_case tests[] =
+{
+   { "integer_zero", TEST_FORMAT_INTEGER, 0, 0, 0.0, "0" },
+   { "integer_negative", TEST_FORMAT_INTEGER, -42, 0, 0.0, "-42" },
+   { "integer_min", TEST_FORMAT_INTEGER, INT32_MIN, 0, 0.0, "-2147483648" },
+   { "integer_max", TEST_FORMAT_INTEGER, INT32_MAX, 0, 0.0, "2147483647" },
+   { "unsigned_max", TEST_FORMAT_UNSIGNED, UINT32_MAX, 0, 0.0, "4294967295" },
+   { "unsigned_power", TEST_FORMAT_UNSIGNED, 1000000000, 0, 0.0, "1000000000" },
+   { "hex_zero", TEST_FORMAT_HEX, 0, 0, 0.0, "0" },
+   { "hex_max", TEST_FORMAT_HEX, 0xFFFFFFFF, 0, 0.0, "FFFFFFFF" },
+   { "hex_padded", TEST_FORMAT_HEX, 0xAB, 4, 0.0, "00AB" },
+   { "hex_zero_padded", TEST_FORMAT_HEX, 0, 8, 0.0, "00000000" },
+   { "hex_wider_than_padding", TEST_FORMAT_HEX, 0x12345, 2, 0.0, "12345" },
+   { "fixed_small", TEST_FORMAT_FIXED, 5, 2, 0.0, "0.05" },
+   { "fixed_small_negative", TEST_FORMAT_FIXED, -5, 2, 0.0, "-0.05" },
+   { "fixed_negative", TEST_FORMAT_FIXED, -2150, 2, 0.0, "-21.50" },
+   { "fixed_zero", TEST_FORMAT_FIXED, 0, 3, 0.0, "0.000" },
+   { "fixed_nine_decimals", TEST_FORMAT_FIXED, 1, 9, 0.0, "0.000000001" },
+   { "fixed_min_nine_decimals", TEST_FORMAT_FIXED, INT32_MIN, 9, 0.0, "-2.147483648" },
+   { "fixed_decimals_limited", TEST_FORMAT_FIXED, 123, 12, 0.0, "0.000000123" },
+   { "double_small", TEST_FORMAT_DOUBLE, 0, 0, 0.05, "0.05" },
+   { "double_negative", TEST_FORMAT_DOUBLE, 0, 0, -21.5, "-21.50" },
+   { "double_rounded", TEST_FORMAT_DOUBLE, 0, 0, 3.14159, "3.14" },
+   { "double_limited", TEST_FORMAT_DOUBLE, 0, 0, 1e12, "21474836.47" },
+   { "double_limited_negative", TEST_FORMAT_DOUBLE, 0, 0, -1e12, "-21474836.48" },
+};
+
+/********************************************************************************
+* print: Skriver ut angivet testfalls tal via motsvarande utskriftsfunktion
+*        och vntar tills samtliga tecken har skickats. Drefter krs
+*        simuleringen i 1 ms, s att sista tecknet i dataregistret skrivs ut.
+*
+*        - test: Pekare till testfallet.
+********************************************************************************/
+static void print(const struct test_case* test)
+{
+   switch (test->format)
+   {
+      case TEST_FORMAT_INTEGER:
+         serial_print_integer((int32_t)test->number);
+         break;
+      case TEST_FORMAT_UNSIGNED:
+         serial_print_unsigned((uint32_t)test->number);
+         break;
+      case TEST_FORMAT_HEX:
+         serial_print_hex((uint32_t)test->number, test->digits);
+         break;
+      case TEST_FORMAT_FIXED:
+         serial_print_fixed((int32_t)test->number, test->digits);
+         break;
+      case TEST_FORMAT_DOUBLE:
+         serial_print_double(test->real);
+         break;
+   }
+
+   serial_flush();
+   host_run_cycles(FLUSH_CYCLES);
+   return;
+}
+
+/********************************************************************************
+* read_output: Lser in utskriften frn systemet sedan fregende anrop och
+*              tmmer drefter den temporra filen.
+*
+*              - s: Array som utskriften lagras i (OUTPUT_SIZE tecken).
+********************************************************************************/
+static void read_output(char* s)
+{
+   size_t length = 0;
+   int c;
+
+   fflush(stdout);
+   rewind(capture);
+
+   while ((c = fgetc(capture)) != EOF && length < OUTPUT_SIZE - 1)
+   {
+      s[length++] = (char)c;
+   }
+
+   s[length] = '\0';
+   fflush(capture);
+   if (ftruncate(fileno(capture), 0)) perror("ftruncate");
+   rewind(capture);
+   return;
+}
+
+/********************************************************************************
+* main: Initierar seriell verfring, varvid vagnreturen som skickas vid
+*       initiering ignoreras, kr samtliga testfall och skriver ut resultatet.
+********************************************************************************/
+int main(void)
+{
+   char output[OUTPUT_SIZE];
+   uint32_t failed = 0;
+
+   console = dup(STDOUT_FILENO);
+   capture = tmpfile();
+   FILE* result = fdopen(console, "w");
+
+   if (console < 0 || !capture || !result)
+   {
+      perror("capture");
+      return 1;
+   }
+
+   fflush(stdout);
+   dup2(fileno(capture), STDOUT_FILENO);
+   serial_init(BAUD_RATE);
+   host_run_cycles(FLUSH_CYCLES);
+   read_output(output);
+
+   for (uint8_t i = 0; i < sizeof(tests) / sizeof(tests[0]); ++i)
+   {
+      const struct test_case* test = &tests[i];
+      print(test);
+      read_output(output);
+
+      const bool ok = !strcmp(output, test->expected);
+      fprintf(result, "%s %s", ok ? "PASS" : "FAIL", test->name);
+      if (!ok) fprintf(result, " (utskrift: \"%s\", frvntat: \"%s\")", output, test->expected);
+      fputc('\n', result);
+      if (!ok) failed++;
+   }
+
+   fprintf(result, "{\"tests\": %u, \"failed\": %u}\n",
+           (unsigned)(sizeof(tests) / sizeof(tests[0])), (unsigned)failed);
+   fclose(result);
+   return failed ? 1 : 0;
+}
@@ -0,0 +1,459 @@
+/********************************************************************************
+* telemetry_decode.c: Avkodare fr den binra telemetristrmmen frn
+*                     systemet, se telemetry.h. Strmmen lses frn en fil
+*                     (exempelvis en inspelning), en terminal ssom en
+*                     seriell port eller pty, eller frn stdin. Ramar avgrnsas
+*                     av nollor och avkodas med COBS, varefter lngd, version
+*                     samt CRC-16 kontrolleras.
+*
+*                     Varje giltigt paket skrivs ut som en rad i JSON-format p
+*                     stdout, s att utskriften kan lsas direkt av en
+*                     dashboard. Frn och med andra paketet ingr ven antalet
+*                     avbrott per sekund per avbrottsvektor, berknat utifrn
+*                     fregende paket. Tider anges i mikrosekunder.
+*
+*                     Ramar som inte r giltiga paket, exempelvis textsvar frn
+*                     kommandogrnssnittet, skrivs ut p stderr ifall de bestr
+*                     av text, annars rknas de som felaktiga. Luckor i
+*                     sekvensnumren rknas som frlorade paket. En
+*                     sammanfattning skrivs ut p stderr nr strmmen tar slut.
+*
+*                     Avkodaren r fristende frn kllfilerna fr systemet,
+*                     s att den kan byggas p valfri vrddator. Paketformatet
+*                     mste drmed hllas i synk med telemetry.h.
+*
+*                     Kompilering, frn katalogen tools:
+*
+*                     gcc -O2 -o telemetry_decode telemetry_decode.c
+*
+*                     Anvndning:
+*
+*                     telemetry_decode [fil] [baud rate]
+*
+*                     - fil      : Fil, seriell port eller pty som strmmen
+*                                  lses frn (default = stdin).
+*                     - baud rate: verfringshastighet ifall filen r en
+*                                  terminal (default = 9600).
+********************************************************************************/
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+
+/********************************************************************************
+* Makrodefinitioner:
+********************************************************************************/
+#define DEFAULT_BAUD_RATE 9600 /* Default verfringshastighet fr terminaler. */
+#define CHUNK_SIZE        256  /* Strsta ram som lagras innan den frkastas. */
+#define US_PER_TICK       4    /* Mikrosekunder per tick fr Timer 1. */
+
+#define TELEMETRY_VERSION      1      /* Version av paketformatet. */
+#define TELEMETRY_ISR_COUNT    6      /* Antal avbrottsvektorer i paketet. */
+#define TELEMETRY_HEADER_SIZE  13     /* Flten fre avbrottsrknarna. */
+#define TELEMETRY_COUNTER_SIZE 4      /* Antal byte per avbrottsrknare. */
+#define TELEMETRY_TRAILER_SIZE 18     /* Flten efter avbrottsrknarna inklusive CRC-16. */
+#define CRC16_POLYNOMIAL       0x1021 /* Generatorpolynom fr CRC-16. */
+#define CRC16_INIT             0xFFFF /* Startvrde fr CRC-16. */
+
+#define TELEMETRY_PAYLOAD_SIZE \
+   (TELEMETRY_HEADER_SIZE + TELEMETRY_COUNTER_SIZE * TELEMETRY_ISR_COUNT + TELEMETRY_TRAILER_SIZE)
+
+#define FLAG_COUNT      0x01 /* Upprkning aktiverad. */
+#define FLAG_COUNT_DOWN 0x02 /* Nedrkning i stllet fr upprkning. */
+#define FLAG_OUTPUT     0x04 /* Displayerna p. */
+#define FLAG_POWER_LOW  0x08 /* Strmavbrott detekterat. */
+
+/********************************************************************************
+* packet: Strukt fr ett avkodat telemetripaket.
+********************************************************************************/
+struct packet
+{
+   uint8_t version;                          /* Paketformatets version. */
+   uint16_t sequence;                        /* Sekvensnummer. */
+   uint32_t time;                            /* Tid sedan start mtt i tick. */
+   uint32_t number;                          /* Aktuellt tal p displayerna. */
+   uint8_t radix;                            /* Aktuell talbas. */
+   uint8_t flags;                            /* Flaggor, se FLAG_COUNT - FLAG_POWER_LOW. */
+   uint32_t isr_counter[TELEMETRY_ISR_COUNT]; /* Antal avbrott per vektor. */
+   uint16_t isr_time_max;                    /* Lngsta avbrottsrutin fr Timer 1. */
+   uint16_t loop_max;                        /* Lngsta varv i huvudloopen. */
+   uint32_t loops;                           /* Antal varv i huvudloopen. */
+   uint32_t tx_dropped;                      /* Kastade byte vid utskrift. */
+   uint32_t rx_dropped;                      /* Kastade mottagna byte. */
+};
+
+/********************************************************************************
+* Statiska variabler:
+*
+*   - isr_names: Namn p avbrottsvektorerna i ordningen enligt enum
+*                telemetry_isr i telemetry.h.
+*   - previous : Fregende giltiga paket, fr berkning av avbrott per
+*                sekund samt frlorade paket.
+*   - valid    : Indikerar ifall fregende paket finns.
+*   - packets  : Antal giltiga paket.
+*   - invalid  : Antal felaktiga ramar (frutom text).
+*   - lost     : Antal frlorade paket enligt sekvensnumren.
+*   - texts    : Antal ramar med text.
+********************************************************************************/
+static const char* const isr_names[TELEMETRY_ISR_COUNT] =
+{
+   "pcint0", "timer1_compa", "ee_ready", "analog_comp", "usart_udre", "usart_rx"
+};
+
+static struct packet previous;
+static bool valid = false;
+static uint32_t packets = 0;
+static uint32_t invalid = 0;
+static uint32_t lost = 0;
+static uint32_t texts = 0;
+
+/********************************************************************************
+* crc16: Returnerar CRC-16 fr angivet datablock, berknad ssom i crc.c.
+*
+*        - data: Pekare till datablocket.
+*        - size: Datablockets storlek mtt i byte.
+********************************************************************************/
+static uint16_t crc16(const uint8_t* data,
+                      const size_t size)
+{
+   uint16_t crc = CRC16_INIT;
+
+   for (size_t i = 0; i < size; ++i)
+   {
+      crc ^= (uint16_t)data[i] << 8;
+
+      for (uint8_t j = 0; j < 8; ++j)
+      {
+         crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ CRC16_POLYNOMIAL) : (uint16_t)(crc << 1);
+      }
+   }
+
+   return crc;
+}
+
+/********************************************************************************
+* get: Lser ett vrde med minst signifikant byte frst och flyttar fram
+*      angiven pekare.
+*
+*      - s   : Pekare till pekaren till vrdet som ska lsas.
+*      - size: Antal byte som ska lsas (1 - 4).
+********************************************************************************/
+static uint32_t get(const uint8_t** s,
+                    const uint8_t size)
+{
+   uint32_t value = 0;
+
+   for (uint8_t i = 0; i < size; ++i)
+   {
+      value |= (uint32_t)(*s)[i] << (8 * i);
+   }
+
+   *s += size;
+   return value;
+}
+
+/********************************************************************************
+* cobs_decode: Avkodar angiven ram med COBS och returnerar antalet avkodade
+*              byte, eller -1 ifall ramen inte r giltig COBS.
+*
+*              - data  : Pekare till ramen utan avgrnsande nollor.
+*              - size  : Ramens storlek mtt i byte.
+*              - output: Pekare till bufferten som avkodade byte lagras i
+*                        (minst size byte).
+********************************************************************************/
+static int cobs_decode(const uint8_t* data,
+                       const size_t size,
+                       uint8_t* output)
+{
+   size_t i = 0;
+   int length = 0;
+
+   while (i < size)
+   {
+      const uint8_t code = data[i++];
+      if (code == 0 || i + code - 1 > size) return -1;
+
+      for (uint8_t j = 1; j < code; ++j)
+      {
+         output[length++] = data[i++];
+      }
+
+      if (code < 0xFF && i < size) output[length++] = 0x00;
+   }
+
+   return length;
+}
+
+/********************************************************************************
+* parse: Tolkar angivet avkodat paket. Om lngd, kontrollsumma och version
+*        stmmer returneras 0 efter att paketet har lagrats p angiven adress,
+*        annars returneras felkod 1.
+*
+*        - data  : Pekare till det avkodade paketet.
+*        - size  : Paketets storlek mtt i byte.
+*        - packet: Pekare till strukten som paketet lagras i.
+********************************************************************************/
+static int parse(const uint8_t* data,
+                 const int size,
+                 struct packet* packet)
+{
+   const uint8_t* s = data;
+
+   if (size != TELEMETRY_PAYLOAD_SIZE) return 1;
+   if (crc16(data, TELEMETRY_PAYLOAD_SIZE - 2) !=
+       (uint16_t)(data[size - 2] | (data[size - 1] << 8))) return 1;
+
+   packet->version = (uint8_t)get(&s, 1);
+   packet->sequence = (uint16_t)get(&s, 2);
+   packet->time = get(&s, 4);
+   packet->number = get(&s, 4);
+   packet->radix = (uint8_t)get(&s, 1);
+   packet->flags = (uint8_t)get(&s, 1);
+
+   for (uint8_t i = 0; i < TELEMETRY_ISR_COUNT; ++i)
+   {
+      packet->isr_counter[i] = get(&s, TELEMETRY_COUNTER_SIZE);
+   }
+
+   packet->isr_time_max = (uint16_t)get(&s, 2);
+   packet->loop_max = (uint16_t)get(&s, 2);
+   packet->loops = get(&s, 4);
+   packet->tx_dropped = get(&s, 4);
+   packet->rx_dropped = get(&s, 4);
+   return packet->version == TELEMETRY_VERSION ? 0 : 1;
+}
+
+/********************************************************************************
+* print_packet: Skriver ut angivet paket som en rad i JSON-format.
+*
+*               - packet: Pekare till paketet som ska skrivas ut.
+********************************************************************************/
+static void print_packet(const struct packet* packet)
+{
+   const uint32_t elapsed = packet->time - previous.time;
+
+   printf("{\"seq\": %u, \"time_s\": %.3f, \"number\": %u, \"radix\": %u, "
+          "\"count\": %d, \"direction\": \"%s\", \"output\": %d, \"power_low\": %d, "
+          "\"isr\": {",
+          packet->sequence, packet->time * (US_PER_TICK / 1e6), packet->number,
+          packet->radix, !!(packet->flags & FLAG_COUNT),
+          packet->flags & FLAG_COUNT_DOWN ? "down" : "up",
+          !!(packet->flags & FLAG_OUTPUT),
+          !!(packet->flags & FLAG_POWER_LOW));
+
+   for (uint8_t i = 0; i < TELEMETRY_ISR_COUNT; ++i)
+   {
+      printf("%s\"%s\": %u", i ? ", " : "", isr_names[i], packet->isr_counter[i]);
+   }
+
+   printf("}");
+
+   if (valid && elapsed)
+   {
+      printf(", \"isr_per_s\": {");
+
+      for (uint8_t i = 0; i < TELEMETRY_ISR_COUNT; ++i)
+      {
+         const uint32_t calls = packet->isr_counter[i] - previous.isr_counter[i];
+         printf("%s\"%s\": %.1f", i ? ", " : "", isr_names[i],
+                calls / (elapsed * (US_PER_TICK / 1e6)));
+      }
+
+      printf("}");
+   }
+
+   printf(", \"timer1_isr_max_us\": %u, \"loop_max_us\": %u, \"loops\": %u, "
+          "\"tx_dropped\": %u, \"rx_dropped\": %u}\n",
+          packet->isr_time_max * US_PER_TICK, packet->loop_max * US_PER_TICK,
+          packet->loops, packet->tx_dropped, packet->rx_dropped);
+   fflush(stdout);
+   return;
+}
+
+/********************************************************************************
+* print_text: Skriver ut angiven ram p stderr ifall den bestr av text
+*             (utskrivbara tecken, vagnretur och nyradstecken) och returnerar
+*             0, annars returneras felkod 1. Ramar med enbart vagnretur och
+*             nyradstecken skrivs inte ut.
+*
+*             - data: Pekare till ramen.
+*             - size: Ramens storlek mtt i byte.
+********************************************************************************/
+static int print_text(const uint8_t* data,
+                      const size_t size)
+{
+   bool empty = true;
+
+   for (size_t i = 0; i < size; ++i)
+   {
+      if ((data[i] < ' ' || data[i] > '~') && data[i] != '\r' && data[i] != '\n') return 1;
+      if (data[i] != '\r' && data[i] != '\n') empty = false;
+   }
+
+   if (empty) return 0;
+
+   fputs("text: ", stderr);
+
+   for (size_t i = 0; i < size; ++i)
+   {
+      if (data[i] == '\n') fputs("\\n", stderr);
+      else if (data[i] != '\r') fputc(data[i], stderr);
+   }
+
+   fputc('\n', stderr);
+   return 0;
+}
+
+/********************************************************************************
+* process: Behandlar en ram utan avgrnsande nollor, dr tomma ramar (mellan
+*          tv nollor i fljd) ignoreras.
+*
+*          - data: Pekare till ramen.
+*          - size: Ramens storlek mtt i byte.
+********************************************************************************/
+static void process(const uint8_t* data,
+                    const size_t size)
+{
+   uint8_t decoded[CHUNK_SIZE];
+   struct packet packet;
+
+   if (!size) return;
+   const int length = cobs_decode(data, size, decoded);
+
+   if (length < 0 || parse(decoded, length, &packet))
+   {
+      if (print_text(data, size) == 0) texts++;
+      else invalid++;
+      return;
+   }
+
+   if (valid) lost += (uint16_t)(packet.sequence - previous.sequence - 1);
+   print_packet(&packet);
+   previous = packet;
+   valid = true;
+   packets++;
+   return;
+}
+
+/********************************************************************************
+* baud_constant: Returnerar konstanten fr angiven baud rate fr termios, eller
+*                B0 ifall den inte stds.
+*
+*                - baud_rate: nskad baud rate.
+********************************************************************************/
+static speed_t baud_constant(const unsigned long baud_rate)
+{
+   switch (baud_rate)
+   {
+      case 9600: return B9600;
+      case 19200: return B19200;
+      case 38400: return B38400;
+      case 57600: return B57600;
+      case 115200: return B115200;
+      case 230400: return B230400;
+#ifdef B500000
+      case 500000: return B500000;
+#endif
+#ifdef B1000000
+      case 1000000: return B1000000;
+#endif
+#ifdef B2000000
+      case 2000000: return B2000000;
+#endif
+      default: return B0;
+   }
+}
+
+/********************************************************************************
+* configure_terminal: Stller in angiven terminal fr r verfring av binra
+*                     data med angiven baud rate. Returnerar 0 vid lyckad
+*                     instllning, annars felkod 1.
+*
+*                     - fd       : Filbeskrivare fr terminalen.
+*                     - baud_rate: nskad baud rate.
+********************************************************************************/
+static int configure_terminal(const int fd,
+                              const unsigned long baud_rate)
+{
+   struct termios settings;
+   const speed_t speed = baud_constant(baud_rate);
+
+   if (speed == B0)
+   {
+      fprintf(stderr, "Baud rate %lu stds inte!\n", baud_rate);
+      return 1;
+   }
+
+   if (tcgetattr(fd, &settings)) return 1;
+   cfmakeraw(&settings);
+   cfsetispeed(&settings, speed);
+   cfsetospeed(&settings, speed);
+   settings.c_cc[VMIN] = 1;
+   settings.c_cc[VTIME] = 0;
+   return tcsetattr(fd, TCSANOW, &settings) ? 1 : 0;
+}
+
+/********************************************************************************
+* main: ppnar angiven fil, lser strmmen tills den tar slut och avkodar
+*       samtliga ramar. Ramar som inte ryms i CHUNK_SIZE byte frkastas.
+********************************************************************************/
+int main(const int argc,
+         const char** argv)
+{
+   uint8_t chunk[CHUNK_SIZE];
+   uint8_t buffer[256];
+   size_t length = 0;
+   bool overflow = false;
+   ssize_t count;
+   int fd = STDIN_FILENO;
+
+   if (argc > 1)
+   {
+      fd = open(argv[1], O_RDONLY | O_NOCTTY);
+
+      if (fd < 0)
+      {
+         perror(argv[1]);
+         return 1;
+      }
+   }
+
+   if (isatty(fd) &&
+       configure_terminal(fd, argc > 2 ? strtoul(argv[2], 0, 10) : DEFAULT_BAUD_RATE))
+   {
+      fprintf(stderr, "Terminalen kunde inte stllas in!\n");
+      return 1;
+   }
+
+   while ((count = read(fd, buffer, sizeof(buffer))) > 0)
+   {
+      for (ssize_t i = 0; i < count; ++i)
+      {
+         if (buffer[i] == 0x00)
+         {
+            if (overflow) invalid++;
+            else process(chunk, length);
+            length = 0;
+            overflow = false;
+         }
+         else if (length < CHUNK_SIZE)
+         {
+            chunk[length++] = buffer[i];
+         }
+         else
+         {
+            overflow = true;
+         }
+      }
+   }
+
+   if (length && !overflow && print_text(chunk, length) == 0) texts++;
+
+   fprintf(stderr, "{\"packets\": %u, \"lost\": %u, \"invalid\": %u, \"text\": %u}\n",
+           packets, lost, invalid, texts);
+   if (fd != STDIN_FILENO) close(fd);
+   return 0;
+}
@@ -0,0 +1,278 @@
+/********************************************************************************
+* telemetry_test.c: Test av telemetristrmmen frn sndning till avkodning,
+*                   se telemetry.h. Testet krs p vrddatorn via de
+*                   simulerade registren i host.h, dr telemetrin krs ssom
+*                   i main.c och den seriella utskriften spelas in till en
+*                   temporr fil. Inspelningen avkodas drefter med
+*                   avkodaren tools/telemetry_decode.c, vars utskrift
+*                   jmfrs med systemets tillstnd.
+*
+*                   1. Samtliga inspelade paket ska avkodas utan felaktiga
+*                      ramar eller frlorade paket, vilket ven innebr att
+*                      lngd, version samt CRC-16 stmmer.
+*
+*                   2. Varje paket ska innehlla rtt sekvensnummer, tal,
+*                      talbas, flaggor samt tidpunkt (en period per paket)
+*                      och avbrottsrknaren fr Timer 1 ska ha kat.
+*
+*                   3. Efter att en bit i talet i sista paketet har ndrats
+*                      ska paketet frkastas av avkodaren p grund av
+*                      felaktig kontrollsumma, medan vriga paket avkodas
+*                      som frut. Talet r skilt frn noll och lagras
+*                      drmed ofrndrat av COBS, s att enbart
+*                      kontrollsumman avsljar ndringen.
+*
+*                   Kompilering, frn katalogen med kllfilerna (samtliga
+*                   kllfiler utom main.c lnkas, med seriell konsol):
+*
+*                   gcc -O2 -DHOST_BUILD -DSERIAL_CONSOLE_ENABLED=1 -I .
+*                       -o telemetry_test ../../tools/telemetry_test.c
+*                       $(ls [a-z]*.c | grep -v main.c)
+*
+*                   Anvndning:
+*
+*                   ./telemetry_test telemetry_decode
+*
+*                   - telemetry_decode: Skvg till den kompilerade
+*                                       avkodaren.
+*
+*                   Resultatet skrivs ut per kontroll, fljt av en
+*                   sammanfattning i JSON-format. Om ngon kontroll
+*                   misslyckas returneras 1.
+********************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "header.h"
+
+/********************************************************************************
+* Makrodefinitioner:
+********************************************************************************/
+#define BAUD_RATE      9600              /* verfringshastighet. */
+#define LOOP_CYCLES    (F_CPU / 10000UL) /* Klockcykler per varv i huvudloopen (0.1 ms). */
+#define PACKETS        3                 /* Antal paket som spelas in. */
+#define SETTLE_MS      100               /* Krtid efter sista paketet mtt i ms. */
+#define NUMBER         0xAB              /* Tal som visas p displayerna. */
+#define RADIX          16                /* Talbas fr displayerna. */
+#define RECORDING_SIZE 1024              /* Strsta storlek p inspelningen mtt i byte. */
+#define LINE_SIZE      1024              /* Strsta lngd p en rad frn avkodaren. */
+#define TIME_TOLERANCE 0.01              /* Tillten avvikelse i tidpunkt mtt i s. */
+#define NUMBER_OFFSET  9                 /* Talets frsta byte i ramen (nolla, COBS-byte, offset 7). */
+
+/* Globala variabler som refereras av avbrottsrutinerna: */
+struct button button1;
+struct button button2;
+struct button button3;
+struct soft_timer debounce_timer;
+
+/********************************************************************************
+* Statiska variabler:
+*
+*   - failed: Antal misslyckade kontroller.
+*   - checks: Antal genomfrda kontroller.
+********************************************************************************/
+static uint32_t failed = 0;
+static uint32_t checks = 0;
+
+/********************************************************************************
+* check: Registrerar resultatet av en kontroll och skriver ut det.
+*
+*        - ok  : Indikerar ifall kontrollen lyckades.
+*        - name: Kontrollens namn.
+********************************************************************************/
+static void check(const bool ok,
+                  const char* name)
+{
+   checks++;
+   if (!ok) failed++;
+   printf("%s %s\n", ok ? "PASS" : "FAIL", name);
+   return;
+}
+
+/********************************************************************************
+* field: Returnerar vrdet fr angiven nyckel i en rad i JSON-format frn
+*        avkodaren, eller -1 ifall nyckeln saknas.
+*
+*        - line: Raden som ska skas igenom.
+*        - key : Nyckeln inklusive citattecken, exempelvis "\"seq\"".
+********************************************************************************/
+static double field(const char* line,
+                    const char* key)
+{
+   const char* s = strstr(line, key);
+   if (!s) return -1;
+   s += strlen(key);
+   while (*s == ':' || *s == ' ') s++;
+   return strtod(s, 0);
+}
+
+/********************************************************************************
+* record: Kr systemet ssom i main.c med aktiverad telemetri tills PACKETS
+*         paket har skickats och spelar in utskriften till angiven buffert.
+*         Returnerar antalet inspelade byte.
+*
+*         - recording: Bufferten som inspelningen lagras i.
+********************************************************************************/
+static size_t record(uint8_t* recording)
+{
+   FILE* capture = tmpfile();
+   const int console = dup(STDOUT_FILENO);
+   const uint32_t loops = (PACKETS * TELEMETRY_PERIOD_MS + SETTLE_MS) * 10UL;
+
+   if (!capture || console < 0) return 0;
+   fflush(stdout);
+   dup2(fileno(capture), STDOUT_FILENO);
+
+   eeprom_init();
+   asm("SEI");
+   display_init();
+   display_set_radix(RADIX);
+   display_set_number(NUMBER);
+   display_enable_output();
+   serial_init(BAUD_RATE);
+   telemetry_init();
+
+   for (uint32_t i = 0; i < loops; ++i)
+   {
+      host_run_cycles(LOOP_CYCLES);
+      telemetry_run();
+   }
+
+   telemetry_disable();
+   host_run_cycles(F_CPU / 1000UL);
+   fflush(stdout);
+   dup2(console, STDOUT_FILENO);
+   close(console);
+
+   rewind(capture);
+   const size_t size = fread(recording, 1, RECORDING_SIZE, capture);
+   fclose(capture);
+   return size;
+}
+
+/********************************************************************************
+* decode: Avkodar angiven inspelning med avkodaren och lagrar varje avkodat
+*         paket som en rad, samt sammanfattningen. Returnerar antalet
+*         avkodade paket, eller -1 ifall avkodaren inte kunde kras.
+*
+*         - decoder  : Skvg till avkodaren.
+*         - recording: Inspelningen som ska avkodas.
+*         - size     : Inspelningens storlek mtt i byte.
+*         - packets  : Array som raderna fr paketen lagras i (PACKETS rader).
+*         - summary  : Array som sammanfattningen lagras i.
+********************************************************************************/
+static int decode(const char* decoder,
+                  const uint8_t* recording,
+                  const size_t size,
+                  char packets[PACKETS][LINE_SIZE],
+                  char* summary)
+{
+   char path[] = "/tmp/telemetry_test_XXXXXX";
+   char command[LINE_SIZE];
+   char line[LINE_SIZE];
+   int count = 0;
+
+   const int fd = mkstemp(path);
+   if (fd < 0) return -1;
+
+   if (write(fd, recording, size) != (ssize_t)size)
+   {
+      close(fd);
+      unlink(path);
+      return -1;
+   }
+
+   close(fd);
+   snprintf(command, sizeof(command), "\"%s\" \"%s\" 2>&1", decoder, path);
+   FILE* output = popen(command, "r");
+   summary[0] = '\0';
+
+   while (output && fgets(line, sizeof(line), output))
+   {
+      if (strstr(line, "\"packets\"")) strcpy(summary, line);
+      else if (strstr(line, "\"seq\"") && count < PACKETS) strcpy(packets[count++], line);
+   }
+
+   if (output) pclose(output);
+   unlink(path);
+   return output ? count : -1;
+}
+
+/********************************************************************************
+* check_packets: Kontrollerar flten i angivna avkodade paket.
+*
+*                - packets: Raderna fr de avkodade paketen.
+*                - count  : Antal avkodade paket.
+********************************************************************************/
+static void check_packets(char packets[PACKETS][LINE_SIZE],
+                          const int count)
+{
+   bool sequence_ok = true;
+   bool state_ok = true;
+   bool time_ok = true;
+   bool isr_ok = true;
+   double timer1_before = 0;
+
+   for (int i = 0; i < count; ++i)
+   {
+      const char* line = packets[i];
+      const double timer1 = field(line, "\"timer1_compa\"");
+
+      if (field(line, "\"seq\"") != i) sequence_ok = false;
+      if (field(line, "\"number\"") != NUMBER || field(line, "\"radix\"") != RADIX ||
+          field(line, "\"output\"") != 1 || field(line, "\"count\"") != 0 ||
+          !strstr(line, "\"direction\": \"up\"")) state_ok = false;
+
+      const double expected_time = (i + 1) * TELEMETRY_PERIOD_MS / 1000.0;
+      const double time = field(line, "\"time_s\"");
+      if (time < expected_time - TIME_TOLERANCE || time > expected_time + TIME_TOLERANCE) time_ok = false;
+
+      if (timer1 <= timer1_before) isr_ok = false;
+      timer1_before = timer1;
+   }
+
+   check(sequence_ok, "sequence");
+   check(state_ok, "state");
+   check(time_ok, "time");
+   check(isr_ok, "timer1_counter");
+   return;
+}
+
+/********************************************************************************
+* main: Spelar in telemetristrmmen, avkodar den med angiven avkodare, frst
+*       ofrndrad och drefter med en ndrad bit i sista paketet, och
+*       skriver ut resultatet.
+********************************************************************************/
+int main(const int argc,
+         const char** argv)
+{
+   static uint8_t recording[RECORDING_SIZE];
+   static char packets[PACKETS][LINE_SIZE];
+   char summary[LINE_SIZE];
+
+   if (argc < 2)
+   {
+      fprintf(stderr, "Anvndning: %s telemetry_decode\n", argv[0]);
+      return 1;
+   }
+
+   const size_t size = record(recording);
+   const int count = decode(argv[1], recording, size, packets, summary);
+
+   check(count == PACKETS, "decoded");
+   check(field(summary, "\"invalid\"") == 0 && field(summary, "\"lost\"") == 0, "no_invalid");
+   check_packets(packets, count);
+
+   const size_t number_index = size - TELEMETRY_FRAME_SIZE + NUMBER_OFFSET;
+   const bool found = size >= TELEMETRY_FRAME_SIZE && recording[number_index] == NUMBER;
+   if (found) recording[number_index] ^= 0x01;
+   const int corrupted = decode(argv[1], recording, size, packets, summary);
+
+   check(found && corrupted == PACKETS - 1 && field(summary, "\"invalid\"") == 1, "crc_rejects_corruption");
+
+   printf("{\"checks\": %lu, \"failed\": %lu, \"recorded_bytes\": %lu, \"frame_size\": %u}\n",
+          (unsigned long)checks, (unsigned long)failed, (unsigned long)size,
+          (unsigned)TELEMETRY_FRAME_SIZE);
+   return failed ? 1 : 0;
+}